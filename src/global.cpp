@@ -21,7 +21,7 @@ std::string get_current_directory() {
     return dir;
 }
 
-void change_directory(std::string &dir) {
+void change_directory(std::string const &dir) {
     if (chdir(dir.c_str())) {
         std::ostringstream oss;
         oss << "ERROR: Failed to change path to " << dir;
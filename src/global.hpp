@@ -33,7 +33,7 @@ namespace tapir {
 /** A function to return the current working directory. */
 std::string get_current_directory();
 /** A function to change the current working directory. */
-void change_directory(std::string &dir);
+void change_directory(std::string const &dir);
 
 
 /** Returns the time (in ms) since the program started running. */
@@ -281,5 +281,24 @@ std::unique_ptr<solver::Serializer> ContTagModel::createSerializer(solver::Solve
 	return std::make_unique<ContTagTextSerializer>(solver);
 }
 
+std::size_t ContTagModel::getParticleBin(solver::State const &baseState) {
+	const State& state = static_cast<const State&>(baseState);
+	double binSize = options->particleBinSize;
+	std::size_t bin = 0;
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getRobotPosition().x / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getRobotPosition().y / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getHumanPosition().x / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getHumanPosition().y / binSize)));
+
+	// The heading accumulates over the moves, so it has to be wrapped first.
+	double angle = std::fmod(state.getRobotAngle(), 2 * M_PI);
+	if (angle < 0) {
+		angle += 2 * M_PI;
+	}
+	tapir::hash_combine(bin, static_cast<long>(angle / (M_PI / 4)));
+	tapir::hash_combine(bin, state.isTagged());
+	return bin;
+}
+
 
 } // namespace contnav {
@@ -380,7 +380,6 @@ public:
 			assert(false); //we should never reach this point.
 		}
 
-		// return getNeighbourHeuristicValue(entry, baseState, data);
 		return getUpperBoundHeuristicValue(state);
 	}
 
@@ -402,95 +401,6 @@ public:
 	}
 
 
-//	virtual double getNeighbourHeuristicValue(solver::HistoryEntry const * entry, solver::State const *baseState, solver::HistoricalData const * /*data*/) {
-//
-//		const State* state = static_cast<const State*>(baseState);
-//
-//		// std::cout << "Estimating qValue for " << state << " " << *state << std::endl;
-//
-//		solver::BeliefNode* beliefNode = entry->getAssociatedBeliefNode();
-//
-//		if (beliefNode == nullptr) {
-//			std::cout << "[heuristic fail] ";
-//			return getUpperBoundHeuristicValue(*state);
-//		}
-//
-//		return getUpperBoundHeuristicValue(*state);
-//
-//		solver::Solver* solver = beliefNode->getSolver();
-//		assert(solver != nullptr);
-//
-//		solver::StatePool* pool = solver->getStatePool();
-//		assert(pool != nullptr);
-//
-//		solver::RTree* tree = static_cast<solver::RTree *>(pool->getStateIndex());
-//		assert(tree != nullptr);
-//
-//		const bool useRealNearestNeighbourSearch = true;
-//		std::vector<solver::StateInfo*> neighbours;
-//
-//		if (useRealNearestNeighbourSearch) {
-//			neighbours = tree->nearestNeighborQuery(pool, state, 2);
-//		} else {
-//			auto vectorCoordinates = state->asVector();
-//			auto lowCorner = vectorCoordinates;
-//			for (double& i : lowCorner) { i--; }
-//			auto highCorner = vectorCoordinates;
-//			for (double& i : highCorner) { i++; }
-//			neighbours = tree->boxQuery(pool, lowCorner, highCorner);
-//		}
-//
-//		// We want to sort the neighbours so closest ones are considered first.
-//		std::sort(neighbours.begin(), neighbours.end(),
-//				[state](const solver::StateInfo* first, const solver::StateInfo* second){return state->distanceTo(*first->getState()) < state->distanceTo(*second->getState()); });
-//
-//
-//		double rewardSum = 0;
-//		size_t rewardCount = 0;
-//
-//		for (auto stateInfo : neighbours) {
-//			for (solver::HistoryEntry* entryToConsider : stateInfo->usedInHistoryEntries()) {
-//
-//				// skip if we came across the state we're trying to estimate right now.
-//				if (entryToConsider->getState() == state) continue;
-//
-//				// std::cout << "=";
-//
-//				auto startId = entryToConsider->getId();
-//				solver::HistorySequence* sequence = entryToConsider->getOwningSequence();
-//				auto sequenceLength = sequence->getLength();
-//				double discount = 1;
-//				double historySum = 0;
-//				bool useThisSequence  =true;
-//				for (auto i = startId; i < sequenceLength; i++) {
-//					solver::HistoryEntry* currentEntry = sequence->getEntry(i);
-//					if (currentEntry->getState() == state) {
-//						// std::cout << "skipping..." << std::endl;
-//						useThisSequence = false;
-//						break;
-//					}
-//					historySum += discount * sequence->getEntry(i)->getImmediateReward();
-//
-//					// std::cout << "Considering " << sequence->getEntry(i)->getState() << " " << *sequence->getEntry(i)->getState() << ": " << discount << " * " << sequence->getEntry(i)->getImmediateReward() << std::endl;
-//
-//					discount *= options->discountFactor;
-//
-//				}
-//
-//				if (useThisSequence) {
-//					rewardSum += historySum;
-//					rewardCount++;
-//				}
-//			}
-//		}
-//
-//		if (rewardCount == 0) {
-//			return getUpperBoundHeuristicValue(*state);
-//		} else {
-//			return rewardSum / rewardCount;
-//		}
-//
-//	}
 
 
 	/* ------- Customization of more complex solver functionality  --------- */
@@ -504,6 +414,12 @@ public:
 
 	virtual std::unique_ptr<solver::Serializer> createSerializer(solver::Solver *solver) override;
 
+	/** Bins states for KLD-sampling by the grid cells (see ContTagOptions::particleBinSize) of the
+	 * robot and the human, the robot's heading to within 45 degrees, and whether the human has
+	 * been tagged.
+	 */
+	virtual std::size_t getParticleBin(solver::State const &baseState) override;
+
 	Position getStartPosition() const { return startPosition; };
 	void setStartPosition(const Position& position) { startPosition=position; };
 
@@ -44,6 +44,9 @@ struct ContTagOptions : public shared::SharedOptions {
 
     int fixedActionResolution=0;
 
+    /** The side length of the square cells that positions are grouped into for KLD-sampling. */
+    double particleBinSize = 1;
+
 
     /** Constructs an OptionParser instance that will parse configuration settings for the Tag
      * problem into an instance of TagOptions.
@@ -81,6 +84,7 @@ struct ContTagOptions : public shared::SharedOptions {
         parser->addOptionWithDefault<double>("problem", "humanAngleUncertainty", &ContTagOptions::humanAngleUncertainty, 0);
 
         parser->addOptionWithDefault<int>("problem", "fixedActionResolution", &ContTagOptions::fixedActionResolution, 0);
+        parser->addOptionWithDefault<double>("problem", "particleBinSize", &ContTagOptions::particleBinSize, 1);
     }
 };
 } /* namespace tag */
@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <fstream>                      // for ifstream, basic_istream, basic_istream<>::__istream_type
+#include <functional>                   // for function
 #include <iomanip>                      // for operator<<, setw
 #include <iostream>                     // for cout
 #include <random>                       // for uniform_int_distribution, bernoulli_distribution
@@ -27,7 +28,7 @@
 
 #include "solver/changes/ChangeFlags.hpp"        // for ChangeFlags
 
-#include "solver/indexing/FlaggingVisitor.hpp"
+#include "solver/indexing/RegionFlagger.hpp"
 #include "solver/indexing/RTree.hpp"
 #include "solver/indexing/SpatialIndexVisitor.hpp"             // for State, operator<<, operator==
 
@@ -510,32 +511,24 @@ std::unique_ptr<solver::Observation> HomecareModel::makeObservation(
         robotPos, targetPos, targetRegion, nextState.getCall());
 }
 
-int HomecareModel::sampleObservationRegion(HomecareState const &state) {
-    GridPosition tPos = state.getTargetPos();
-    int currentRegion;
-    int a = std::uniform_int_distribution<int>(0, 2)(*getRandomGenerator());
-    int other;
-    if (tPos.i <= nRows_ / 2) {
-        if (tPos.j <= nCols_ / 2) {
-            currentRegion = 0;
-            int otherRegions[] = {1, 2, 3};
-            other = otherRegions[a];
-        } else {
-            currentRegion = 1;
-            int otherRegions[] = {0, 2, 3};
-            other = otherRegions[a];
-        }
-    } else {
-        if (tPos.j <= nCols_ / 2) {
-            currentRegion = 2;
-            int otherRegions[] = {0, 1, 3};
-            other = otherRegions[a];
-        } else {
-            currentRegion = 3;
-            int otherRegions[] = {0, 1, 2};
-            other = otherRegions[a];
+int HomecareModel::getRegion(GridPosition const &position) {
+    if (position.i <= nRows_ / 2) {
+        if (position.j <= nCols_ / 2) {
+            return 0;
         }
+        return 1;
+    }
+    if (position.j <= nCols_ / 2) {
+        return 2;
     }
+    return 3;
+}
+
+int HomecareModel::sampleObservationRegion(HomecareState const &state) {
+    int currentRegion = getRegion(state.getTargetPos());
+    int a = std::uniform_int_distribution<int>(0, 2)(*getRandomGenerator());
+    // Pick one of the three other regions.
+    int other = a < currentRegion ? a : a + 1;
     if (std::bernoulli_distribution(regionSensorAccuracy_)(
             *getRandomGenerator())) {
         return currentRegion;
@@ -612,6 +605,18 @@ void HomecareModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange
         }
     }
 
+    // The affected regions for all of the changes are flagged together at the end.
+    std::unique_ptr<solver::RegionFlagger> flagger = nullptr;
+    solver::RTree *tree = nullptr;
+    if (pool != nullptr) {
+        tree = static_cast<solver::RTree *>(pool->getStateIndex());
+        if (tree == nullptr) {
+            debug::show_message("ERROR: state index must be enabled to handle changes in Homecare!");
+            std::exit(4);
+        }
+        flagger = std::make_unique<solver::RegionFlagger>(pool, 1.0);
+    }
+
     for (auto const &change : changes) {
         HomecareChange const &homecareChange = static_cast<HomecareChange const &>(*change);
         if (options_->hasVerboseOutput) {
@@ -639,12 +644,6 @@ void HomecareModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange
             continue;
         }
 
-        solver::RTree *tree = static_cast<solver::RTree *>(pool->getStateIndex());
-        if (tree == nullptr) {
-            debug::show_message("ERROR: state index must be enabled to handle changes in Homecare!");
-            std::exit(4);
-        }
-
         double iLo = homecareChange.i0;
         double iHi = homecareChange.i1;
         double iMx = nRows_ - 1.0;
@@ -654,10 +653,12 @@ void HomecareModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange
         double jMx = nCols_ - 1.0;
 
         // Revise state transitions
-        solver::FlaggingVisitor visitor(pool, solver::ChangeFlags::TRANSITION);
-        tree->boxQuery(visitor,
-                {0.0, 0.0, iLo - 1, jLo - 1, 0.0},
-                {iMx, jMx, iHi + 1, jHi + 1, 0.0});
+        flagger->addRegion({0.0, 0.0, iLo - 1, jLo - 1, 0.0},
+                {iMx, jMx, iHi + 1, jHi + 1, 0.0}, solver::ChangeFlags::TRANSITION);
+    }
+
+    if (flagger != nullptr) {
+        flagger->flagStates(tree);
     }
 
     // Check for heuristic changes.
@@ -677,11 +678,21 @@ void HomecareModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange
 
 /* ------------ Methods for handling particle depletion -------------- */
 std::vector<std::unique_ptr<solver::State>> HomecareModel::generateParticles(
-        solver::BeliefNode */*previousBelief*/, solver::Action const &action,
+        solver::BeliefNode *previousBelief, solver::Action const &action,
         solver::Observation const &obs,
         long nParticles,
         std::vector<solver::State const *> const &previousParticles) {
-    std::vector<std::unique_ptr<solver::State>> newParticles;
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts = (
+            getExpectedParticleCounts(previousBelief, action, obs, nParticles,
+                    previousParticles));
+    return drawParticles(expectedCounts, 0, expectedCounts.size());
+}
+
+std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+HomecareModel::getExpectedParticleCounts(solver::BeliefNode */*previousBelief*/,
+        solver::Action const &action, solver::Observation const &obs, long nParticles,
+        std::vector<solver::State const *> const &previousParticles) {
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts;
     HomecareObservation const &observation =
             (static_cast<HomecareObservation const &>(obs));
     ActionType actionType =
@@ -732,18 +743,10 @@ std::vector<std::unique_ptr<solver::State>> HomecareModel::generateParticles(
     double scale = nParticles / weightTotal;
     for (WeightMap::iterator it = weights.begin(); it != weights.end();
             it++) {
-        double proportion = it->second * scale;
-        long numToAdd = static_cast<long>(proportion);
-        if (std::bernoulli_distribution(proportion - numToAdd)(
-                *getRandomGenerator())) {
-            numToAdd += 1;
-        }
-        for (int i = 0; i < numToAdd; i++) {
-            newParticles.push_back(std::make_unique<HomecareState>(it->first));
-        }
+        expectedCounts.emplace_back(std::make_unique<HomecareState>(it->first),
+                it->second * scale);
     }
-
-    return newParticles;
+    return expectedCounts;
 }
 
 std::vector<std::unique_ptr<solver::State>> HomecareModel::generateParticles(
@@ -764,6 +767,110 @@ std::vector<std::unique_ptr<solver::State>> HomecareModel::generateParticles(
     return newParticles;
 }
 
+std::unique_ptr<solver::State> HomecareModel::generateRejuvenationProposal(
+        solver::State const &state) {
+    HomecareState const &homecareState = static_cast<HomecareState const &>(state);
+    // A move into a wall proposes the same state, which keeps the proposal symmetric.
+    ActionType direction = static_cast<ActionType>(std::uniform_int_distribution<long>(
+            static_cast<long>(ActionType::NORTH), static_cast<long>(ActionType::NORTH_WEST))(
+                    *getRandomGenerator()));
+    GridPosition targetPos = getMovedPos(homecareState.getTargetPos(), direction).first;
+    return std::make_unique<HomecareState>(homecareState.getRobotPos(), targetPos,
+            homecareState.getCall());
+}
+
+std::function<double(solver::State const &)> HomecareModel::createHistoryLikelihood(
+        solver::BeliefNode const *belief) {
+    std::unordered_map<HomecareState, double> probabilities = calculateBelief(belief);
+    if (probabilities.empty()) {
+        return nullptr;
+    }
+    return [probabilities](solver::State const &state) {
+        auto it = probabilities.find(static_cast<HomecareState const &>(state));
+        if (it == probabilities.end()) {
+            return 0.0;
+        }
+        return it->second;
+    };
+}
+
+std::unordered_map<HomecareState, double> HomecareModel::calculateBelief(
+        solver::BeliefNode const *belief) {
+    // Collect the path back up to the root.
+    std::vector<solver::BeliefNode const *> path;
+    for (solver::BeliefNode const *node = belief; node->getParentBelief() != nullptr;
+            node = node->getParentBelief()) {
+        path.push_back(node);
+    }
+
+    // The initial belief is as for sampleAnInitState().
+    std::unordered_map<HomecareState, double> probabilities;
+    for (GridPosition const &robotPos : sCells_) {
+        for (GridPosition const &targetPos : tCells_) {
+            HomecareState state(robotPos, targetPos, false);
+            probabilities[state] += 1.0 / (sCells_.size() * tCells_.size());
+        }
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); it++) {
+        std::unique_ptr<solver::Action> action = (*it)->getLastAction();
+        ActionType actionType = static_cast<HomecareAction const &>(*action).getActionType();
+        std::unique_ptr<solver::Observation> observation = (*it)->getLastObservation();
+        HomecareObservation const &homecareObservation = (
+                static_cast<HomecareObservation const &>(*observation));
+
+        // The transition is as for makeNextState(), and is then weighted by the probability of
+        // the observation.
+        std::unordered_map<HomecareState, double> nextProbabilities;
+        double totalProbability = 0;
+        for (auto const &entry : probabilities) {
+            HomecareState const &state = entry.first;
+            std::unordered_map<GridPosition, double> robotPosDistribution = (
+                    getNextRobotPositionDistribution(state.getRobotPos(), actionType));
+            std::unordered_map<GridPosition, double> targetPosDistribution = (
+                    getNextTargetPositionDistribution(state.getTargetPos(), state.getCall()));
+            for (auto const &robotEntry : robotPosDistribution) {
+                if (robotEntry.first != homecareObservation.getRobotPos()) {
+                    continue;
+                }
+                for (auto const &targetEntry : targetPosDistribution) {
+                    GridPosition observedTargetPos(-1, -1);
+                    if (targetEntry.first.euclideanDistanceTo(robotEntry.first) < 1.5) {
+                        observedTargetPos = targetEntry.first;
+                    }
+                    if (observedTargetPos != homecareObservation.getTargetPos()) {
+                        continue;
+                    }
+                    double regionProbability = (1 - regionSensorAccuracy_) / 3;
+                    if (getRegion(targetEntry.first) == homecareObservation.getTargetRegion()) {
+                        regionProbability = regionSensorAccuracy_;
+                    }
+                    std::unordered_map<bool, double> callDistribution = (
+                            getNextCallDistribution(robotEntry.first, targetEntry.first,
+                                    state.getCall()));
+                    bool call = homecareObservation.getCall();
+                    if (callDistribution.count(call) == 0) {
+                        continue;
+                    }
+                    HomecareState nextState(robotEntry.first, targetEntry.first, call);
+                    double probability = (entry.second * robotEntry.second * targetEntry.second
+                            * callDistribution[call] * regionProbability);
+                    nextProbabilities[nextState] += probability;
+                    totalProbability += probability;
+                }
+            }
+        }
+        if (totalProbability <= 0) {
+            return std::unordered_map<HomecareState, double>();
+        }
+        for (auto &entry : nextProbabilities) {
+            entry.second /= totalProbability;
+        }
+        probabilities = std::move(nextProbabilities);
+    }
+    return probabilities;
+}
+
 
 /* --------------- Pretty printing methods ----------------- */
 
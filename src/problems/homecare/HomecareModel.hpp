@@ -5,9 +5,11 @@
 #ifndef HOMECAREMODEL_HPP_
 #define HOMECAREMODEL_HPP_
 
+#include <functional>                   // for function
 #include <memory>                       // for unique_ptr
 #include <ostream>                      // for ostream
 #include <string>                       // for string
+#include <unordered_map>                // for unordered_map
 #include <utility>                      // for pair
 #include <vector>                       // for vector
 
@@ -155,6 +157,13 @@ class HomecareModel: public shared::ModelWithProgramOptions {
             solver::Observation const &obs,
             long nParticles,
             std::vector<solver::State const *> const &previousParticles) override;
+    /** Returns the possible next states used by the first version of generateParticles(), with
+     * the expected number of copies of each.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+    getExpectedParticleCounts(solver::BeliefNode *previousBelief,
+            solver::Action const &action, solver::Observation const &obs, long nParticles,
+            std::vector<solver::State const *> const &previousParticles) override;
 
     /** Generates particles for Homecare according to an uninformed prior.
      *
@@ -167,6 +176,18 @@ class HomecareModel: public shared::ModelWithProgramOptions {
             solver::Observation const &obs,
             long nParticles) override;
 
+    /** Proposes a move to the same state, but with the target moved in a random direction. */
+    virtual std::unique_ptr<solver::State> generateRejuvenationProposal(
+            solver::State const &state) override;
+    /** Returns the exact probability of each state given the history leading to the given
+     * belief (see calculateBelief()).
+     *
+     * This already includes the prior, so the ratio between any two states is the same as for
+     * the prior times the likelihood of the observations.
+     */
+    virtual std::function<double(solver::State const &)> createHistoryLikelihood(
+            solver::BeliefNode const *belief) override;
+
 
     /* --------------- Pretty printing methods ----------------- */
     /** Displays a single cell of the map. */
@@ -214,6 +235,8 @@ class HomecareModel: public shared::ModelWithProgramOptions {
      */
     std::unique_ptr<solver::Observation> makeObservation(HomecareState const &nextState);
 
+    /** Returns the region (i.e. the quadrant of the map) that the given position is in. */
+    int getRegion(GridPosition const &position);
     /** Samples a reading from region sensors */
     int sampleObservationRegion(HomecareState const &state);
 
@@ -249,6 +272,13 @@ class HomecareModel: public shared::ModelWithProgramOptions {
 
     bool updateCall(GridPosition robotPos, GridPosition targetPos, bool call);
 
+    /** Calculates the exact belief for the given belief node, by filtering forward from the
+     * initial belief along the actions and observations that lead to it.
+     *
+     * Returns an empty map if that history is impossible under the current map.
+     */
+    std::unordered_map<HomecareState, double> calculateBelief(solver::BeliefNode const *belief);
+
     HomecareOptions *options_;
 
     /** The penalty for each movement. */
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>                    // for min
 #include <cstddef>                      // for size_t
+#include <cstdlib>                      // for abs
 
 #include <ostream>                      // for ostream
 #include <vector>                       // for vector
@@ -29,9 +31,13 @@ class BearingObservationDiscrete: public solver::Point {
     	return std::make_unique<This>(bearing, buckets, pushed);
     }
 
+    /** Returns the angle between the two bearings, in degrees; observations that differ in
+     * whether the box was pushed are a further 360 degrees apart.
+     */
     double distanceTo(solver::Observation const &otherObs) const override {
     	This const &other =  static_cast<This const &>(otherObs);
-    	return ((bearing-other.bearing) % buckets) + ( pushed == other.pushed ? 0 : buckets);
+    	int difference = std::abs(bearing - other.bearing) % 360;
+    	return std::min(difference, 360 - difference) + (pushed == other.pushed ? 0 : 360);
     }
 
     bool equals(solver::Observation const &otherObs) const override {
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <fstream>
 
+#include "solver/mappings/observations/approximate_observations.hpp"
+
 #include "PushBoxTextSerializer.hpp"
 
 
@@ -209,6 +211,12 @@ std::unique_ptr<solver::ActionPool> PushBoxModel::createActionPool(solver::Solve
 	return std::make_unique<PushBoxActionPool>(*this);
 }
 
+std::unique_ptr<solver::ObservationPool> PushBoxModel::createObservationPool(solver::Solver *solver) {
+	return std::make_unique<solver::ApproximateObservationPool>(solver,
+			options->maxObservationDistance, options->observationWideningCoefficient,
+			options->observationWideningExponent);
+}
+
 
 
 std::unique_ptr<solver::State> PushBoxModel::sampleAnInitState() {
@@ -460,7 +468,6 @@ double PushBoxModel::getDefaultHeuristicValue(solver::HistoryEntry const * entry
 		debug::show_message("Error: We should never reach this point. There seems to be an unknown terminal state.");
 	}
 
-	//return getNeighbourHeuristicValue(entry, baseState, data);
 	return getUpperBoundHeuristicValue(entry, baseState, data);
 }
 
@@ -488,100 +495,6 @@ double PushBoxModel::getUpperBoundHeuristicValue(solver::HistoryEntry const * /*
 	return result;
 }
 
-/*
-double PushBoxModel::getNeighbourHeuristicValue(solver::HistoryEntry const * entry, solver::State const *baseState, solver::HistoricalData const * data) {
-
-	const State* state = static_cast<const State*>(baseState);
-
-	// std::cout << "Estimating qValue for " << state << " " << *state << std::endl;
-
-	solver::BeliefNode* beliefNode = entry->getAssociatedBeliefNode();
-
-	if (beliefNode == nullptr) {
-		std::cout << "[heuristic fail] ";
-		return getUpperBoundHeuristicValue(entry, baseState, data);
-	}
-
-	return getUpperBoundHeuristicValue(entry, baseState, data);
-
-	solver::Solver* solver = beliefNode->getSolver();
-	assert(solver != nullptr);
-
-	solver::StatePool* pool = solver->getStatePool();
-	assert(pool != nullptr);
-
-	solver::RTree* tree = static_cast<solver::RTree *>(pool->getStateIndex());
-	assert(tree != nullptr);
-
-	const bool useRealNearestNeighbourSearch = true;
-	std::vector<solver::StateInfo*> neighbours;
-
-	if (useRealNearestNeighbourSearch) {
-		neighbours = tree->nearestNeighborQuery(pool, state, 2);
-	} else {
-		auto vectorCoordinates = state->asVector();
-		auto lowCorner = vectorCoordinates;
-		for (double& i : lowCorner) { i--; }
-		auto highCorner = vectorCoordinates;
-		for (double& i : highCorner) { i++; }
-		neighbours = tree->boxQuery(pool, lowCorner, highCorner);
-	}
-
-	// We want to sort the neighbours so closest ones are considered first.
-	std::sort(neighbours.begin(), neighbours.end(),
-			[state](const solver::StateInfo* first, const solver::StateInfo* second){return state->distanceTo(*first->getState()) < state->distanceTo(*second->getState()); });
-
-
-	double rewardSum = 0;
-	size_t rewardCount = 0;
-
-	for (auto stateInfo : neighbours) {
-		for (solver::HistoryEntry* entryToConsider : stateInfo->usedInHistoryEntries()) {
-
-			// skip if we came across the state we're trying to estimate right now.
-			if (entryToConsider->getState() == state) continue;
-
-			// std::cout << "=";
-
-			auto startId = entryToConsider->getId();
-			solver::HistorySequence* sequence = entryToConsider->getOwningSequence();
-			auto sequenceLength = sequence->getLength();
-			double discount = 1;
-			double historySum = 0;
-			bool useThisSequence  =true;
-			for (auto i = startId; i < sequenceLength; i++) {
-				solver::HistoryEntry* currentEntry = sequence->getEntry(i);
-				if (currentEntry->getState() == state) {
-					// std::cout << "skipping..." << std::endl;
-					useThisSequence = false;
-					break;
-				}
-				historySum += discount * sequence->getEntry(i)->getImmediateReward();
-
-				// std::cout << "Considering " << sequence->getEntry(i)->getState() << " " << *sequence->getEntry(i)->getState() << ": " << discount << " * " << sequence->getEntry(i)->getImmediateReward() << std::endl;
-
-				discount *= options->discountFactor;
-
-			}
-
-			if (useThisSequence) {
-				rewardSum += historySum;
-				rewardCount++;
-			}
-		}
-	}
-
-	if (rewardCount == 0) {
-		return getUpperBoundHeuristicValue(entry, baseState, data);
-	} else {
-		return rewardSum / rewardCount;
-	}
-
-} //*/
-
-
-
-
 
 //ContNavUBParser::ContNavUBParser(ContNavModel *model) :
 //	        						model_(model) {
@@ -600,5 +513,16 @@ std::unique_ptr<solver::Serializer> PushBoxModel::createSerializer(solver::Solve
 	return std::make_unique<PushBoxTextSerializer>(solver);
 }
 
+std::size_t PushBoxModel::getParticleBin(solver::State const &baseState) {
+	const State& state = static_cast<const State&>(baseState);
+	double binSize = options->particleBinSize;
+	std::size_t bin = 0;
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getRobotPosition().x / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getRobotPosition().y / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getOpponentPosition().x / binSize)));
+	tapir::hash_combine(bin, static_cast<long>(std::floor(state.getOpponentPosition().y / binSize)));
+	return bin;
+}
+
 
 } // namespace contnav {
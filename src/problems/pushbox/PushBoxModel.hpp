@@ -148,8 +148,18 @@ public:
 
 	virtual std::unique_ptr<solver::ActionPool> createActionPool(solver::Solver* solver) override;
 
+	/** Creates an approximate observation pool, so that maxObservationDistance and observation
+	 * progressive widening can be used to limit the number of observation children.
+	 */
+	virtual std::unique_ptr<solver::ObservationPool> createObservationPool(solver::Solver *solver) override;
+
 	virtual std::unique_ptr<solver::Serializer> createSerializer(solver::Solver *solver) override;
 
+	/** Bins states for KLD-sampling by the grid cells of the robot and the box (see
+	 * PushBoxOptions::particleBinSize).
+	 */
+	virtual std::size_t getParticleBin(solver::State const &baseState) override;
+
 
 	/* ---------------------- Basic customizations  ---------------------- */
 	virtual double getDefaultHeuristicValue(solver::HistoryEntry const * entry, solver::State const *baseState, solver::HistoricalData const * data) override;
@@ -195,9 +205,6 @@ private:
 	/** Returns an upper bound heuristic value for the given state.	 */
 	double getUpperBoundHeuristicValue(solver::HistoryEntry const * /*entry*/, solver::State const *baseState, solver::HistoricalData const * /*data*/);
 
-	/** creates a heuristic value based on neighbouring states */
-	double getNeighbourHeuristicValue(solver::HistoryEntry const * entry, solver::State const *baseState, solver::HistoricalData const * data);
-
 
 	/* -------------------- Black box dynamics ---------------------- */
 
@@ -45,6 +45,9 @@ public:
 
     size_t fixedActionResolution = 0;
 
+    /** The side length of the square cells that positions are grouped into for KLD-sampling. */
+    double particleBinSize = 1;
+
 
     /** Constructs an OptionParser instance that will parse configuration settings for the Tag
      * problem into an instance of TagOptions.
@@ -80,6 +83,7 @@ public:
 
         parser->addOptionWithDefault<size_t>("problem", "observationBuckets", &This::observationBuckets, 12);
         parser->addOptionWithDefault<size_t>("problem", "fixedActionResolution", &This::fixedActionResolution, 0);
+        parser->addOptionWithDefault<double>("problem", "particleBinSize", &This::particleBinSize, 1);
 
     }
 };
@@ -18,7 +18,7 @@ PushBoxTextSerializer::PushBoxTextSerializer(solver::Solver *solver):
 		solver::Serializer(solver),
 		solver::TextSerializer(),
 		solver::ContinuousActionTextSerializer(),
-		solver::DiscreteObservationTextSerializer() {}
+		solver::ApproximateObservationTextSerializer() {}
 
 
 
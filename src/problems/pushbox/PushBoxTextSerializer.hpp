@@ -12,7 +12,7 @@
 #include "solver/abstract-problem/State.hpp"
 
 #include "solver/mappings/actions/continuous_actions.hpp"
-#include "solver/mappings/observations/discrete_observations.hpp"
+#include "solver/mappings/observations/approximate_observations.hpp"
 
 #include "solver/serialization/TextSerializer.hpp"    // for TextSerializer
 
@@ -33,10 +33,10 @@ std::vector<long> loadVector(std::istream &is);
  *
  * This contains serialization methods for TagChange, TagState, TagAction, and TagObservation;
  * this class also inherits from solver::EnumeratedActionTextSerializer in order to serialize
- * the action mappings, and from solver::DiscreteObservationTextSerializer in order to serialize
+ * the action mappings, and from solver::ApproximateObservationTextSerializer in order to serialize
  * the observation mappings.
  */
-class PushBoxTextSerializer: virtual public solver::Serializer, virtual public solver::TextSerializer, virtual solver::ContinuousActionTextSerializer, virtual solver::DiscreteObservationTextSerializer {
+class PushBoxTextSerializer: virtual public solver::Serializer, virtual public solver::TextSerializer, virtual solver::ContinuousActionTextSerializer, virtual solver::ApproximateObservationTextSerializer {
 	typedef PushBoxModel Model;
 	typedef Model::State State;
 	typedef Model::Observation Observation;
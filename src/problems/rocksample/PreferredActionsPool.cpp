@@ -40,7 +40,8 @@ std::unique_ptr<solver::ActionMapping> PreferredActionsPool::createActionMapping
             static_cast<PositionAndRockData const &>(*node->getHistoricalData());
 
     if (model_->usingPreferredInit()) {
-        for (RockSampleAction const &action : data.generatePreferredActions()) {
+        for (long code : data.generatePreferredActions()) {
+            RockSampleAction action(code, model_->getNumberOfRocks());
             long visitCount = model_->getPreferredVisitCount();
             discMap->getEntry(action)->update(visitCount, visitCount * model_->getPreferredQValue());
         }
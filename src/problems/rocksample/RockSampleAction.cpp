@@ -17,18 +17,21 @@
 #include "solver/abstract-problem/State.hpp"             // for State
 
 namespace rocksample {
-RockSampleAction::RockSampleAction(ActionType actionType, uint8_t rockNo) :
+RockSampleAction::RockSampleAction(ActionType actionType, uint8_t rockNo, uint8_t nRocks) :
         actionType_(actionType),
-        rockNo_(rockNo) {
+        rockNo_(rockNo),
+        nRocks_(nRocks) {
 }
 
-RockSampleAction::RockSampleAction(long code) :
-        actionType_(code <= 5 ? static_cast<ActionType>(code) : ActionType::CHECK),
-        rockNo_(actionType_ == ActionType::CHECK ? code-5 : 0) {
+RockSampleAction::RockSampleAction(long code, long nRocks) :
+        actionType_(code < 5 ? static_cast<ActionType>(code) :
+                (code < 5 + nRocks ? ActionType::CHECK : ActionType::MOVE_TO)),
+        rockNo_(code < 5 ? 0 : (code < 5 + nRocks ? code - 5 : code - 5 - nRocks)),
+        nRocks_(nRocks) {
 }
 
 std::unique_ptr<solver::Action> RockSampleAction::copy() const {
-    return std::make_unique<RockSampleAction>(actionType_,rockNo_);
+    return std::make_unique<RockSampleAction>(actionType_, rockNo_, nRocks_);
 }
 
 double RockSampleAction::distanceTo(solver::Action const &/*otherAction*/) const {
@@ -37,7 +40,7 @@ double RockSampleAction::distanceTo(solver::Action const &/*otherAction*/) const
 
 void RockSampleAction::print(std::ostream &os) const {
     os << actionType_;
-    if (actionType_ == ActionType::CHECK) {
+    if (actionType_ == ActionType::CHECK || actionType_ == ActionType::MOVE_TO) {
         os << static_cast<long>(rockNo_);
     }
 }
@@ -46,6 +49,8 @@ long RockSampleAction::getBinNumber() const {
     long code = static_cast<long>(actionType_);
     if (actionType_ == ActionType::CHECK) {
         code += rockNo_;
+    } else if (actionType_ == ActionType::MOVE_TO) {
+        code = static_cast<long>(ActionType::CHECK) + nRocks_ + rockNo_;
     }
     return code;
 }
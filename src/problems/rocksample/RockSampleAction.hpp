@@ -30,7 +30,11 @@ enum class ActionType : uint8_t {
     /** Sample a rock. */
     SAMPLE = 4,
     /** Check one of the rocks on the map using the sensor. */
-    CHECK = 5
+    CHECK = 5,
+    /** A macro-action that moves toward one of the rocks on the map (see
+     * RockSampleOptions::macroActionLength).
+     */
+    MOVE_TO = 6
 };
 
 /** An insertion operator, for human-readable printing of action types. */
@@ -54,6 +58,9 @@ inline std::ostream &operator<<(std::ostream &os, ActionType const actionType) {
     case ActionType::SAMPLE:
         os << "SAMPLE";
         break;
+    case ActionType::MOVE_TO:
+        os << "GOTO-";
+        break;
     default:
         os << "ERROR-" << static_cast<long>(actionType);
         break;
@@ -70,10 +77,16 @@ inline std::ostream &operator<<(std::ostream &os, ActionType const actionType) {
 class RockSampleAction : public solver::DiscretizedPoint {
     friend class RockSampleTextSerializer;
   public:
-    /** Constructs a new action from the given ActionType. */
-    RockSampleAction(ActionType actionType, uint8_t rockNo = 0);
-    /** Constructs a new action from the given integer code. */
-    RockSampleAction(long code);
+    /** Constructs a new action from the given ActionType.
+     *
+     * The number of rocks is only needed for MOVE_TO actions, whose codes follow those of all of
+     * the CHECK actions.
+     */
+    RockSampleAction(ActionType actionType, uint8_t rockNo = 0, uint8_t nRocks = 0);
+    /** Constructs a new action from the given integer code, for a map with the given number of
+     * rocks.
+     */
+    RockSampleAction(long code, long nRocks);
     virtual ~RockSampleAction() = default;
 
     std::unique_ptr<solver::Action> copy() const override;
@@ -84,16 +97,20 @@ class RockSampleAction : public solver::DiscretizedPoint {
 
     /** Returns the ActionType of this action. */
     ActionType getActionType() const;
-    /** If the ActionType is CHECK, this returns the rock number being checked; otherwise this
-     * return value is arbitrary.
+    /** If the ActionType is CHECK or MOVE_TO, this returns the rock number being checked or moved
+     * toward; otherwise this return value is arbitrary.
      */
     long getRockNo() const;
 
   private:
     /** The type of action this is. */
     ActionType actionType_;
-    /** If the action type is CHECK, this will be the rock number of the rock to be checked. */
+    /** If the action type is CHECK or MOVE_TO, this will be the rock number of the rock to be
+     * checked or moved toward.
+     */
     uint8_t rockNo_;
+    /** If the action type is MOVE_TO, this will be the number of rocks on the map. */
+    uint8_t nRocks_;
 };
 } /* namespace rocksample */
 
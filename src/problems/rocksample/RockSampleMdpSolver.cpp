@@ -5,18 +5,23 @@
 #include "RockSampleMdpSolver.hpp"
 
 #include <iostream>
+#include <memory>
+#include <tuple>
+#include <vector>
 
 #include "problems/shared/GridPosition.hpp"
 
 #include "solver/HistoryEntry.hpp"
 
+#include "RockSampleAction.hpp"
 #include "RockSampleModel.hpp"
 #include "RockSampleState.hpp"
 
 namespace rocksample {
 RockSampleMdpSolver::RockSampleMdpSolver(RockSampleModel *model) :
             model_(model),
-            valueMap_() {
+            valueMap_(),
+            solvedDistances_() {
 }
 
 void RockSampleMdpSolver::solve() {
@@ -26,6 +31,7 @@ void RockSampleMdpSolver::solve() {
     }
 
     valueMap_.clear();
+    solvedDistances_ = getRockDistances();
 
     // States are represented as pairs of integers.
     // The first number encodes the states of the rocks.
@@ -77,6 +83,14 @@ void RockSampleMdpSolver::solve() {
     }
 }
 
+void RockSampleMdpSolver::update() {
+    if (valueMap_.empty() || getRockDistances() != solvedDistances_) {
+        solve();
+    } else if (model_->options_->hasVerboseOutput) {
+        std::cout << "MDP unchanged." << std::endl << std::endl;
+    }
+}
+
 double RockSampleMdpSolver::getQValue(RockSampleState const &state) const {
     GridPosition pos = state.getPosition();
     long rockStateCode = model_->encodeRocks(state.getRockStates());
@@ -96,6 +110,29 @@ double RockSampleMdpSolver::getQValue(RockSampleState const &state) const {
     return value;
 }
 
+double RockSampleMdpSolver::getQValue(RockSampleState const &state,
+        RockSampleAction const &action) const {
+    // The transitions are deterministic, so there is only one next state to consider.
+    std::unique_ptr<RockSampleState> nextState;
+    bool isLegal;
+    std::tie(nextState, isLegal) = model_->makeNextState(state, action);
+    double reward = model_->makeReward(state, action, *nextState, isLegal);
+    if (model_->isTerminal(*nextState)) {
+        return reward;
+    }
+    return reward + model_->getDiscountFactor(action) * getQValue(*nextState);
+}
+
+std::vector<long> RockSampleMdpSolver::getRockDistances() const {
+    std::vector<long> distances;
+    for (int i = 0; i < model_->nRocks_; i++) {
+        for (long action = -1; action < model_->nRocks_; action++) {
+            distances.push_back(model_->getDistance(model_->rockPositions_[i], action));
+        }
+    }
+    return distances;
+}
+
 double RockSampleMdpSolver::calculateQValue(GridPosition pos, long rockStateCode,
         long action) const {
     long actionsUntilReward = model_->getDistance(pos, action);
@@ -144,4 +181,27 @@ solver::HeuristicFunction RockSampleMdpParser::parse(solver::Solver */*solver*/,
         return solver->getQValue(static_cast<RockSampleState const &>(*state));
     };
 }
+
+RockSampleQmdpParser::RockSampleQmdpParser(RockSampleModel *model) :
+        model_(model) {
+}
+
+std::vector<std::unique_ptr<solver::Action>> RockSampleQmdpParser::getAllActions() {
+    std::vector<std::unique_ptr<solver::Action>> actions;
+    for (std::unique_ptr<solver::DiscretizedPoint> &action : model_->getAllActionsInOrder()) {
+        actions.push_back(std::move(action));
+    }
+    return actions;
+}
+
+solver::MdpQValueFunction RockSampleQmdpParser::getQValueFunction() {
+    if (model_->getMdpSolver() == nullptr) {
+        model_->makeMdpSolver();
+    }
+    return [this] (solver::State const &state, solver::Action const &action) {
+        RockSampleMdpSolver *solver = model_->getMdpSolver();
+        return solver->getQValue(static_cast<RockSampleState const &>(state),
+                static_cast<RockSampleAction const &>(action));
+    };
+}
 } /* namespace rocksample */
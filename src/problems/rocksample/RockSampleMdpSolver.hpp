@@ -11,8 +11,10 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "global.hpp"
 
@@ -22,6 +24,7 @@
 #include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
 
 namespace rocksample {
+class RockSampleAction;
 class RockSampleModel;
 class RockSampleState;
 
@@ -38,9 +41,17 @@ public:
     /** Solves the MDP again from scratch, using the current state of the model. */
     void solve();
 
+    /** Solves the MDP again after changes to the model's map, but only if any of the distances
+     * between rocks, or from a rock to the goal, have changed - the MDP depends on nothing else.
+     */
+    void update();
+
     /** Calculates the exact value for the given state in the MDP. */
     double getQValue(RockSampleState const &state) const;
 
+    /** Calculates the exact Q-value for taking the given action from the given state in the MDP. */
+    double getQValue(RockSampleState const &state, RockSampleAction const &action) const;
+
 private:
     /** Calculates the q-value for the given action, from the current position
      * with the given rock state code (encoded into a number).
@@ -52,8 +63,15 @@ private:
     double calculateQValue(GridPosition pos,
             long rockStateCode, long action) const;
 
+    /** Returns the distance from each rock to each other rock and to the goal, in the order used
+     * by RockSampleModel::getDistance().
+     */
+    std::vector<long> getRockDistances() const;
+
     RockSampleModel *model_;
     std::map<std::pair<int, int>, double> valueMap_;
+    /** The rock distances the MDP was last solved with. */
+    std::vector<long> solvedDistances_;
 };
 
 /** A class to parse the command-line heuristic setting for the case "exactMdp()". */
@@ -74,6 +92,24 @@ private:
     /** The RockSampleModel instance this heuristic parser is associated with. */
     RockSampleModel *model_;
 };
+
+/** A class to parse the recommendation strategy setting for the case "qmdp(...)", which uses the
+ * MDP Q-values as a fallback when the search has too few histories.
+ */
+class RockSampleQmdpParser : public shared::QmdpRecommendedActionStrategyParser {
+public:
+    /** Creates a new QMDP parser associated with the given RockSampleModel instance. */
+    RockSampleQmdpParser(RockSampleModel *model);
+    virtual ~RockSampleQmdpParser() = default;
+    _NO_COPY_OR_MOVE(RockSampleQmdpParser);
+
+    virtual std::vector<std::unique_ptr<solver::Action>> getAllActions() override;
+    virtual solver::MdpQValueFunction getQValueFunction() override;
+
+private:
+    /** The RockSampleModel instance this parser is associated with. */
+    RockSampleModel *model_;
+};
 } /* namespace rocksample */
 
 #endif /* ROCKSAMPLE_MDPSOLVER_HPP_ */
@@ -9,6 +9,7 @@
 #include <cstdlib>                      // for exit
 
 #include <fstream>                      // for operator<<, basic_ostream, endl, basic_ostream<>::__ostream_type, ifstream, basic_ostream::operator<<, basic_istream, basic_istream<>::__istream_type
+#include <functional>                   // for function
 #include <initializer_list>
 #include <iostream>                     // for cout
 #include <queue>
@@ -71,8 +72,13 @@ RockSampleModel::RockSampleModel(RandomGenerator *randGen, std::unique_ptr<RockS
             nRows_(0), // update
             nCols_(0), // update
             nRocks_(0), // update
+            nActions_(0), // update
             startPos_(), // update
             rockPositions_(), // push rocks
+            rocksNorthOfRow_(), // calculate masks
+            rocksSouthOfRow_(), // calculate masks
+            rocksEastOfColumn_(), // calculate masks
+            rocksWestOfColumn_(), // calculate masks
             goalPositions_(), // push goals
             mapText_(), // push rows
             envMap_(), // push rows
@@ -84,7 +90,9 @@ RockSampleModel::RockSampleModel(RandomGenerator *randGen, std::unique_ptr<RockS
             usingPreferredInit_(options_->usePreferredInit),
             preferredQValue_(options_->preferredQValue),
             preferredVisitCount_(options_->preferredVisitCount),
-            mdpSolver_(nullptr) {
+            mdpSolver_(nullptr),
+            rootPosition_(),
+            rootGoodProbabilities_() {
 
     if (searchCategory_ > heuristicType_) {
         searchCategory_ = heuristicType_;
@@ -94,6 +102,7 @@ RockSampleModel::RockSampleModel(RandomGenerator *randGen, std::unique_ptr<RockS
     }
 
     registerHeuristicParser("exactMdp", std::make_unique<RockSampleMdpParser>(this));
+    registerSelectRecommendedActionParser("qmdp", std::make_unique<RockSampleQmdpParser>(this));
 
     // Read the map from the file.
     std::ifstream inFile;
@@ -153,6 +162,42 @@ void RockSampleModel::initialize() {
         }
     }
 
+    if (nRocks_ > 64) {
+        debug::show_message("ERROR: RockSample supports at most 64 rocks.");
+        std::exit(11);
+    }
+    // The moves, SAMPLE and a CHECK for each rock, then a MOVE_TO for each rock if enabled.
+    nActions_ = 5 + nRocks_;
+    if (options_->macroActionLength > 0) {
+        nActions_ += nRocks_;
+        options_->hasMacroActions = true;
+    }
+    // Initially the robot is at the start position, and each rock is equally likely to be good.
+    rootPosition_ = startPos_;
+    rootGoodProbabilities_.assign(nRocks_, 0.5);
+    rocksNorthOfRow_.assign(nRows_, 0);
+    rocksSouthOfRow_.assign(nRows_, 0);
+    rocksEastOfColumn_.assign(nCols_, 0);
+    rocksWestOfColumn_.assign(nCols_, 0);
+    for (long rockNo = 0; rockNo < nRocks_; rockNo++) {
+        GridPosition rockPos = rockPositions_[rockNo];
+        uint64_t rockBit = uint64_t(1) << rockNo;
+        for (long i = 0; i < nRows_; i++) {
+            if (rockPos.i < i) {
+                rocksNorthOfRow_[i] |= rockBit;
+            } else if (rockPos.i > i) {
+                rocksSouthOfRow_[i] |= rockBit;
+            }
+        }
+        for (long j = 0; j < nCols_; j++) {
+            if (rockPos.j > j) {
+                rocksEastOfColumn_[j] |= rockBit;
+            } else if (rockPos.j < j) {
+                rocksWestOfColumn_[j] |= rockBit;
+            }
+        }
+    }
+
     options_->numberOfStateVariables = 2 + nRocks_;
     options_->minVal = -illegalMovePenalty_ / (1 - options_->discountFactor);
     options_->minVal = goodRockReward_ * nRocks_ + exitReward_;
@@ -258,6 +303,14 @@ std::vector<bool> RockSampleModel::sampleRocks() {
             std::uniform_int_distribution<long>(0, (1 << nRocks_) - 1)(*getRandomGenerator()));
 }
 
+std::vector<bool> RockSampleModel::sampleRocks(std::vector<double> const &goodProbabilities) {
+    std::vector<bool> rockStates;
+    for (double probability : goodProbabilities) {
+        rockStates.push_back(std::bernoulli_distribution(probability)(*getRandomGenerator()));
+    }
+    return rockStates;
+}
+
 std::vector<bool> RockSampleModel::decodeRocks(long val) {
     std::vector<bool> rockStates;
     for (int j = 0; j < nRocks_; j++) {
@@ -311,7 +364,7 @@ std::pair<GridPosition, bool> RockSampleModel::makeNextPosition(GridPosition pos
     GridPosition oldPosition = position;
 
     bool isLegal = true;
-    if (actionType == ActionType::CHECK) {
+    if (actionType == ActionType::CHECK || actionType == ActionType::MOVE_TO) {
         // Do nothing - the state remains the same.
     } else if (actionType == ActionType::SAMPLE) {
         int rockNo = getCellType(position) - ROCK;
@@ -328,13 +381,42 @@ std::pair<GridPosition, bool> RockSampleModel::makeNextPosition(GridPosition pos
     return std::make_pair(position, isLegal);
 }
 
+std::pair<GridPosition, bool> RockSampleModel::makeNextPosition(GridPosition position,
+        RockSampleAction const &action) {
+    if (action.getActionType() == ActionType::MOVE_TO) {
+        return std::make_pair(makeMacroPosition(position, action.getRockNo()), true);
+    }
+    return makeNextPosition(position, action.getActionType());
+}
+
+GridPosition RockSampleModel::makeMacroPosition(GridPosition position, long rockNo) {
+    for (long step = 0; step < options_->macroActionLength; step++) {
+        int distance = getDistance(position, rockNo);
+        if (distance <= 0) {
+            break;
+        }
+        // The distances exclude the goal squares, so this never leaves the map.
+        for (ActionType direction : {ActionType::NORTH, ActionType::EAST, ActionType::SOUTH,
+            ActionType::WEST}) {
+            GridPosition nextPos;
+            bool isLegal;
+            std::tie(nextPos, isLegal) = makeNextPosition(position, direction);
+            if (isLegal && getDistance(nextPos, rockNo) == distance - 1) {
+                position = nextPos;
+                break;
+            }
+        }
+    }
+    return position;
+}
+
 /* -------------------- Black box dynamics ---------------------- */
 std::pair<std::unique_ptr<RockSampleState>, bool> RockSampleModel::makeNextState(
         RockSampleState const &state, RockSampleAction const &action) {
 
     GridPosition nextPos;
     bool isLegal;
-    std::tie(nextPos, isLegal) = makeNextPosition(state.getPosition(), action.getActionType());
+    std::tie(nextPos, isLegal) = makeNextPosition(state.getPosition(), action);
     if (!isLegal) {
         return std::make_pair(std::make_unique<RockSampleState>(state), false);
     }
@@ -352,7 +434,8 @@ std::pair<std::unique_ptr<RockSampleState>, bool> RockSampleModel::makeNextState
 std::unique_ptr<RockSampleObservation> RockSampleModel::makeObservation(
         RockSampleAction const &action, RockSampleState const &nextState) {
     ActionType actionType = action.getActionType();
-    if (actionType < ActionType::CHECK) {
+    if (actionType != ActionType::CHECK) {
+        // Only the sensor gives any information, so a MOVE_TO observes nothing along the way.
         return std::make_unique<RockSampleObservation>();
     }
     long rockNo = action.getRockNo();
@@ -387,6 +470,10 @@ double RockSampleModel::makeReward(RockSampleState const &state, RockSampleActio
     return 0;
 }
 
+bool RockSampleModel::hasDeterministicTransitions() {
+    return true;
+}
+
 std::unique_ptr<solver::State> RockSampleModel::generateNextState(solver::State const &state,
         solver::Action const &action, solver::TransitionParameters const */*tp*/) {
     return makeNextState(static_cast<RockSampleState const &>(state),
@@ -401,13 +488,19 @@ std::unique_ptr<solver::Observation> RockSampleModel::generateObservation(
 }
 
 double RockSampleModel::generateReward(solver::State const &state, solver::Action const &action,
-        solver::TransitionParameters const */*tp*/, solver::State const */*nextState*/) {
+        solver::TransitionParameters const */*tp*/, solver::State const *nextState) {
     RockSampleState const &rockSampleState = (static_cast<RockSampleState const &>(state));
     RockSampleAction const &rockSampleAction = (static_cast<RockSampleAction const &>(action));
-    std::unique_ptr<RockSampleState> nextState;
-    bool isLegal;
-    std::tie(nextState, isLegal) = makeNextState(rockSampleState, rockSampleAction);
-    return makeReward(rockSampleState, rockSampleAction, *nextState, isLegal);
+    if (nextState == nullptr) {
+        std::unique_ptr<RockSampleState> newState;
+        bool isLegal;
+        std::tie(newState, isLegal) = makeNextState(rockSampleState, rockSampleAction);
+        return makeReward(rockSampleState, rockSampleAction, *newState, isLegal);
+    }
+    // If we already have the next state, we only need to check whether the move was legal.
+    bool isLegal = makeNextPosition(rockSampleState.getPosition(), rockSampleAction).second;
+    return makeReward(rockSampleState, rockSampleAction,
+            static_cast<RockSampleState const &>(*nextState), isLegal);
 }
 
 solver::Model::StepResult RockSampleModel::generateStep(solver::State const &state,
@@ -427,6 +520,13 @@ solver::Model::StepResult RockSampleModel::generateStep(solver::State const &sta
     return result;
 }
 
+long RockSampleModel::getActionDuration(solver::Action const &action) {
+    if (static_cast<RockSampleAction const &>(action).getActionType() == ActionType::MOVE_TO) {
+        return options_->macroActionLength;
+    }
+    return 1;
+}
+
 /* -------------- Methods for handling model changes ---------------- */
 void RockSampleModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
             solver::Solver *solver) {
@@ -554,7 +654,7 @@ void RockSampleModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChan
     recalculateAllDistances();
 
     if (mdpSolver_ != nullptr) {
-        mdpSolver_->solve();
+        mdpSolver_->update();
     }
 
     // Check for heuristic changes.
@@ -575,75 +675,163 @@ void RockSampleModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChan
     }
 }
 
+void RockSampleModel::resetRoot(solver::BeliefNode const *newRoot) {
+    // The replay for the new root still has the old tree's path to work from.
+    GridPosition position;
+    std::vector<double> goodProbabilities = calculateRockBelief(newRoot, position);
+    rootPosition_ = position;
+    rootGoodProbabilities_ = goodProbabilities;
+}
+
 
 /* ------------ Methods for handling particle depletion -------------- */
 std::vector<std::unique_ptr<solver::State>> RockSampleModel::generateParticles(
-        solver::BeliefNode */*previousBelief*/, solver::Action const &action,
+        solver::BeliefNode *previousBelief, solver::Action const &action,
         solver::Observation const &obs, long nParticles,
         std::vector<solver::State const *> const &previousParticles) {
-    std::vector<std::unique_ptr<solver::State>> newParticles;
-
-    RockSampleAction const &a = static_cast<RockSampleAction const &>(action);
-    if (a.getActionType() == ActionType::CHECK) {
-        long rockNo = a.getRockNo();
-        typedef std::unordered_map<RockSampleState, double> WeightMap;
-        WeightMap weights;
-        double weightTotal = 0;
-        for (solver::State const *state : previousParticles) {
-            RockSampleState const *rockSampleState = static_cast<RockSampleState const *>(state);
-            GridPosition pos(rockSampleState->getPosition());
-            double dist = pos.euclideanDistanceTo(rockPositions_[rockNo]);
-            bool rockIsGood = rockSampleState->getRockStates()[rockNo];
-
-            double probability = getSensorCorrectnessProbability(dist);
-            RockSampleObservation const &observation =
-                    (static_cast<RockSampleObservation const &>(obs));
-            if (rockIsGood != observation.isGood()) {
-                probability = 1 - probability;
-            }
-            weights[*rockSampleState] += probability;
-            weightTotal += probability;
-        }
-        double scale = nParticles / weightTotal;
-        for (WeightMap::value_type &it : weights) {
-            double proportion = it.second * scale;
-            long numToAdd = static_cast<long>(proportion);
-            if (std::bernoulli_distribution(proportion - numToAdd)(*getRandomGenerator())) {
-                numToAdd += 1;
-            }
-            for (int i = 0; i < numToAdd; i++) {
-                newParticles.push_back(std::make_unique<RockSampleState>(it.first));
-            }
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts = (
+            getExpectedParticleCounts(previousBelief, action, obs, nParticles,
+                    previousParticles));
+    return drawParticles(expectedCounts, 0, expectedCounts.size());
+}
+
+std::vector<std::unique_ptr<solver::State>> RockSampleModel::generateParticles(
+        solver::BeliefNode *previousBelief, solver::Action const &action,
+        solver::Observation const &obs, long nParticles) {
+    return generateParticles(previousBelief, action, obs, nParticles,
+            std::vector<solver::State const *>());
+}
+
+std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+RockSampleModel::getExpectedParticleCounts(solver::BeliefNode *previousBelief,
+        solver::Action const &action, solver::Observation const &obs, long nParticles,
+        std::vector<solver::State const *> const &/*previousParticles*/) {
+    GridPosition position;
+    std::vector<double> goodProbabilities = calculateRockBelief(previousBelief, position);
+    updateRockBelief(position, goodProbabilities, static_cast<RockSampleAction const &>(action),
+            static_cast<RockSampleObservation const &>(obs));
+
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts;
+    std::vector<long> uncertainRocks;
+    std::vector<bool> rockStates(nRocks_);
+    for (long rockNo = 0; rockNo < nRocks_; rockNo++) {
+        if (goodProbabilities[rockNo] > 0 && goodProbabilities[rockNo] < 1) {
+            uncertainRocks.push_back(rockNo);
         }
+        rockStates[rockNo] = goodProbabilities[rockNo] >= 1;
+    }
+    long numberOfCombinations = nParticles + 1;
+    if (uncertainRocks.size() < 8 * sizeof(long) - 1) {
+        numberOfCombinations = 1L << uncertainRocks.size();
+    }
+    if (numberOfCombinations > nParticles) {
+        // Too many combinations to list, so the particles are sampled directly.
+        for (long i = 0; i < nParticles; i++) {
+            expectedCounts.emplace_back(std::make_unique<RockSampleState>(position,
+                    sampleRocks(goodProbabilities)), 1.0);
+        }
+        return expectedCounts;
+    }
 
-    } else {
-        // It's not a CHECK action, so we just add each resultant state.
-        for (solver::State const *state : previousParticles) {
-            RockSampleState const *rockSampleState = (static_cast<RockSampleState const *>(state));
-            RockSampleAction const &rockSampleAction =
-                    (static_cast<RockSampleAction const &>(action));
-            newParticles.push_back(makeNextState(*rockSampleState, rockSampleAction).first);
+    for (long code = 0; code < numberOfCombinations; code++) {
+        double probability = 1.0;
+        for (std::size_t i = 0; i < uncertainRocks.size(); i++) {
+            long rockNo = uncertainRocks[i];
+            rockStates[rockNo] = (code >> i) & 1;
+            probability *= rockStates[rockNo] ? goodProbabilities[rockNo] :
+                    1 - goodProbabilities[rockNo];
         }
+        expectedCounts.emplace_back(std::make_unique<RockSampleState>(position, rockStates),
+                probability * nParticles);
     }
-    return newParticles;
+    return expectedCounts;
 }
 
-std::vector<std::unique_ptr<solver::State>> RockSampleModel::generateParticles(
-        solver::BeliefNode *previousBelief, solver::Action const &action,
-        solver::Observation const &obs, long nParticles) {
-    // Retrieve the fully observed part of the state.
-    GridPosition oldPosition = static_cast<RockSampleState const &>(
-            *previousBelief->getStates()[0]).getPosition();
+std::unique_ptr<solver::State> RockSampleModel::generateRejuvenationProposal(
+        solver::State const &state) {
+    RockSampleState const &rockSampleState = static_cast<RockSampleState const &>(state);
+    std::vector<bool> rockStates(rockSampleState.getRockStates());
+    long rockNo = std::uniform_int_distribution<long>(0, nRocks_ - 1)(*getRandomGenerator());
+    rockStates[rockNo] = !rockStates[rockNo];
+    return std::make_unique<RockSampleState>(rockSampleState.getPosition(), rockStates);
+}
+
+std::function<double(solver::State const &)> RockSampleModel::createHistoryLikelihood(
+        solver::BeliefNode const *belief) {
+    GridPosition position;
+    std::vector<double> goodProbabilities = calculateRockBelief(belief, position);
+    return [goodProbabilities](solver::State const &state) {
+        std::vector<bool> rockStates(static_cast<RockSampleState const &>(state).getRockStates());
+        double likelihood = 1.0;
+        for (std::size_t i = 0; i < rockStates.size(); i++) {
+            likelihood *= rockStates[i] ? goodProbabilities[i] : 1 - goodProbabilities[i];
+        }
+        return likelihood;
+    };
+}
+
+std::vector<double> RockSampleModel::calculateRockBelief(solver::BeliefNode const *belief,
+        GridPosition &position) {
+    // Collect the path back up to the root.
+    std::vector<solver::BeliefNode const *> path;
+    solver::BeliefNode const *root = belief;
+    for (; root->getParentBelief() != nullptr; root = root->getParentBelief()) {
+        path.push_back(root);
+    }
 
-    std::vector<std::unique_ptr<solver::State>> particles;
-    while ((long) particles.size() < nParticles) {
-        RockSampleState oldState(oldPosition, sampleRocks());
-        solver::Model::StepResult result = generateStep(oldState, action);
-        if (obs == *result.observation) {
-            particles.push_back(std::move(result.nextState));
+    position = rootPosition_;
+    std::vector<double> goodProbabilities(rootGoodProbabilities_);
+    for (auto it = path.rbegin(); it != path.rend(); it++) {
+        readPosition((*it)->getParentBelief(), position);
+        std::unique_ptr<solver::Action> action = (*it)->getLastAction();
+        std::unique_ptr<solver::Observation> observation = (*it)->getLastObservation();
+        updateRockBelief(position, goodProbabilities,
+                static_cast<RockSampleAction const &>(*action),
+                static_cast<RockSampleObservation const &>(*observation));
+    }
+    readPosition(belief, position);
+    return goodProbabilities;
+}
+
+void RockSampleModel::readPosition(solver::BeliefNode const *belief, GridPosition &position) {
+    std::vector<solver::State const *> states = belief->getStates();
+    if (!states.empty()) {
+        position = static_cast<RockSampleState const &>(*states[0]).getPosition();
+    }
+}
+
+void RockSampleModel::updateRockBelief(GridPosition &position,
+        std::vector<double> &goodProbabilities, RockSampleAction const &action,
+        RockSampleObservation const &observation) {
+    GridPosition nextPosition;
+    bool isLegal;
+    std::tie(nextPosition, isLegal) = makeNextPosition(position, action);
+    if (!isLegal) {
+        return;
+    }
+
+    if (action.getActionType() == ActionType::SAMPLE) {
+        // Any rock is bad after it has been sampled.
+        goodProbabilities[getCellType(position) - ROCK] = 0.0;
+    } else if (action.getActionType() == ActionType::CHECK) {
+        long rockNo = action.getRockNo();
+        double probabilityCorrect = getSensorCorrectnessProbability(
+                position.euclideanDistanceTo(rockPositions_[rockNo]));
+        double likelihoodGood = goodProbabilities[rockNo];
+        double likelihoodBad = 1 - goodProbabilities[rockNo];
+        if (observation.isGood()) {
+            likelihoodGood *= probabilityCorrect;
+            likelihoodBad *= 1 - probabilityCorrect;
+        } else {
+            likelihoodGood *= 1 - probabilityCorrect;
+            likelihoodBad *= probabilityCorrect;
+        }
+        // An impossible observation leaves the belief unchanged.
+        if (likelihoodGood + likelihoodBad > 0) {
+            goodProbabilities[rockNo] = likelihoodGood / (likelihoodGood + likelihoodBad);
         }
     }
-    return particles;
+    position = nextPosition;
 }
 
 /* ------------------- Pretty printing methods --------------------- */
@@ -694,20 +882,9 @@ void RockSampleModel::drawDistances(std::vector<std::vector<int>> &grid, std::os
 void RockSampleModel::drawSimulationState(solver::BeliefNode const *belief,
         solver::State const &state, std::ostream &os) {
     RockSampleState const &rockSampleState = static_cast<RockSampleState const &>(state);
-    std::vector<solver::State const *> particles = belief->getStates();
     GridPosition pos(rockSampleState.getPosition());
-    std::vector<double> goodProportions(nRocks_);
-    for (solver::State const *particle : particles) {
-        RockSampleState const &rss = static_cast<RockSampleState const &>(*particle);
-        for (long i = 0; i < nRocks_; i++) {
-            if (rss.getRockStates()[i]) {
-                goodProportions[i] += 1;
-            }
-        }
-    }
-    for (long i = 0; i < nRocks_; i++) {
-        goodProportions[i] /= particles.size();
-    }
+    GridPosition beliefPosition;
+    std::vector<double> goodProportions = calculateRockBelief(belief, beliefPosition);
 
     std::vector<int> colors { 196, 161, 126, 91, 56, 21, 26, 31, 36, 41, 46 };
     if (options_->hasColorOutput) {
@@ -786,8 +963,8 @@ double RockSampleModel::getDefaultHeuristicValue(solver::HistoryEntry const */*e
 }
 
 std::unique_ptr<RockSampleAction> RockSampleModel::getRandomAction() {
-    long binNumber = std::uniform_int_distribution<int>(0, 4 + nRocks_)(*getRandomGenerator());
-    return std::make_unique<RockSampleAction>(binNumber);
+    long binNumber = std::uniform_int_distribution<int>(0, nActions_ - 1)(*getRandomGenerator());
+    return std::make_unique<RockSampleAction>(binNumber, nRocks_);
 }
 std::unique_ptr<RockSampleAction> RockSampleModel::getRandomAction(std::vector<long> binNumbers) {
     if (binNumbers.empty()) {
@@ -795,7 +972,7 @@ std::unique_ptr<RockSampleAction> RockSampleModel::getRandomAction(std::vector<l
     }
     long index = std::uniform_int_distribution<int>(0, binNumbers.size() - 1)(
             *getRandomGenerator());
-    return std::make_unique<RockSampleAction>(binNumbers[index]);
+    return std::make_unique<RockSampleAction>(binNumbers[index], nRocks_);
 }
 
 std::unique_ptr<solver::Action> RockSampleModel::getRolloutAction(
@@ -817,11 +994,22 @@ std::unique_ptr<solver::Action> RockSampleModel::getRolloutAction(
     return nullptr;
 }
 
+std::vector<std::pair<std::unique_ptr<solver::Observation>, std::unique_ptr<solver::Action>>>
+RockSampleModel::getFallbackActions() {
+    std::vector<std::pair<std::unique_ptr<solver::Observation>, std::unique_ptr<solver::Action>>>
+        fallbackActions;
+    for (long code = 0; code < 3; code++) {
+        fallbackActions.emplace_back(std::make_unique<RockSampleObservation>(code),
+                std::make_unique<RockSampleAction>(ActionType::EAST));
+    }
+    return fallbackActions;
+}
+
 /* ------- Customization of more complex solver functionality  --------- */
 std::vector<std::unique_ptr<solver::DiscretizedPoint>> RockSampleModel::getAllActionsInOrder() {
     std::vector<std::unique_ptr<solver::DiscretizedPoint>> allActions;
-    for (long code = 0; code < 5 + nRocks_; code++) {
-        allActions.push_back(std::make_unique<RockSampleAction>(code));
+    for (long code = 0; code < nActions_; code++) {
+        allActions.push_back(std::make_unique<RockSampleAction>(code, nRocks_));
     }
     return std::move(allActions);
 }
@@ -5,6 +5,8 @@
 #ifndef ROCKSAMPLE_MODEL_HPP_
 #define ROCKSAMPLE_MODEL_HPP_
 
+#include <cstdint>                      // for uint64_t
+#include <functional>                   // for function
 #include <ios>                          // for ostream
 #include <memory>                       // for unique_ptr
 #include <string>                       // for string
@@ -119,6 +121,14 @@ friend class RockSampleMdpSolver;
     long getNumberOfRocks() {
         return nRocks_;
     }
+    /** Returns the number of action codes, including the macro-actions if they are enabled. */
+    long getNumberOfActions() {
+        return nActions_;
+    }
+    /** Returns true iff the MOVE_TO macro-actions are enabled. */
+    bool hasMacroActions() {
+        return options_->macroActionLength > 0;
+    }
     /** Returns the category of actions to cover in searches. */
     RSActionCategory getSearchActionCategory() {
         return searchCategory_;
@@ -175,6 +185,23 @@ friend class RockSampleMdpSolver;
     GridPosition getRockPosition(int rockNo) {
         return rockPositions_[rockNo];
     }
+    /** Returns a bitmask of the rocks that lie strictly in the given direction from the given
+     * position, e.g. for NORTH, all the rocks in the rows above it.
+     */
+    uint64_t getRocksInDirection(GridPosition p, ActionType direction) {
+        switch (direction) {
+        case ActionType::NORTH:
+            return rocksNorthOfRow_[p.i];
+        case ActionType::EAST:
+            return rocksEastOfColumn_[p.j];
+        case ActionType::SOUTH:
+            return rocksSouthOfRow_[p.i];
+        case ActionType::WEST:
+            return rocksWestOfColumn_[p.j];
+        default:
+            return 0;
+        }
+    }
     /** Calculates the probability that the sensor will be accurate, at the
      * given distance. */
     double getSensorCorrectnessProbability(double distance) {
@@ -191,6 +218,8 @@ friend class RockSampleMdpSolver;
 
 
     /* -------------------- Black box dynamics ---------------------- */
+    /** Moving and sampling are deterministic; only the check observations are stochastic. */
+    virtual bool hasDeterministicTransitions() override;
     virtual std::unique_ptr<solver::State> generateNextState(
             solver::State const &state,
             solver::Action const &action,
@@ -204,43 +233,65 @@ friend class RockSampleMdpSolver;
             solver::State const &state,
             solver::Action const &action,
             solver::TransitionParameters const */*tp*/,
-            solver::State const */*nextState*/) override;
+            solver::State const *nextState) override;
     virtual Model::StepResult generateStep(solver::State const &state,
             solver::Action const &action) override;
+    /** Returns RockSampleOptions::macroActionLength for MOVE_TO actions, and 1 for any other
+     * action.
+     */
+    virtual long getActionDuration(solver::Action const &action) override;
 
 
     /* -------------- Methods for handling model changes ---------------- */
     virtual void applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
                  solver::Solver *solver) override;
+    /** Records the exact belief of the new root (see calculateRockBelief()). */
+    virtual void resetRoot(solver::BeliefNode const *newRoot) override;
 
 
     /* ------------ Methods for handling particle depletion -------------- */
-    /** Generates particles for RockSample using a particle filter from the previous belief.
-      *
-      * For each previous particle, possible next states are calculated based on consistency with
-      * the given action and observation. These next states are then added to the output vector
-      * in accordance with their probability of having been generated.
-      */
+    /** Generates particles for RockSample from the exact belief after the given action and
+     * observation, by drawing them from getExpectedParticleCounts().
+     */
     virtual std::vector<std::unique_ptr<solver::State>> generateParticles(
             solver::BeliefNode *previousBelief,
             solver::Action const &action, solver::Observation const &obs,
             long nParticles,
             std::vector<solver::State const *> const &previousParticles) override;
-
-    /** Generates particles for RockSample according to an uninformed prior.
-     *
-     * This method uses the fully observed part of the state, and samples the previous rock
-     * states uniformly at random. For each sample, a single step is generated with the action,
-     * and only states consistent with the observation are kept.
+    /** Returns the expected number of copies of each next state, from the exact belief after the
+     * given action and observation.
      *
-     * NOTE: If this method gets called, things are going badly wrong :(
+     * Since the robot position is fully observed and the rocks are independent, the belief is
+     * exactly a product of independent per-rock probabilities of goodness; these are calculated
+     * by calculateRockBelief(). If there are at most nParticles combinations of the uncertain
+     * rocks, each combination is listed with its expected count; otherwise nParticles states are
+     * sampled here, in O(rocks) time each, with one copy each. The previous particles are not
+     * needed.
      */
+    virtual std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+    getExpectedParticleCounts(solver::BeliefNode *previousBelief,
+            solver::Action const &action, solver::Observation const &obs, long nParticles,
+            std::vector<solver::State const *> const &previousParticles) override;
+
+    /** Generates particles for RockSample from the exact belief; this is the same as the above. */
     virtual std::vector<std::unique_ptr<solver::State>> generateParticles(
             solver::BeliefNode *previousBelief,
             solver::Action const &action,
             solver::Observation const &obs,
             long nParticles) override;
 
+    /** Proposes a move to the same state, but with the goodness of one random rock flipped. */
+    virtual std::unique_ptr<solver::State> generateRejuvenationProposal(
+            solver::State const &state) override;
+    /** Returns the likelihood of the history as the product, over all rocks, of the exact
+     * probability of that rock being as it is in the given state.
+     *
+     * Since the prior is uniform over rock states, this is proportional to the likelihood of the
+     * observations; it is zero for any state in which a rock that has been sampled is good.
+     */
+    virtual std::function<double(solver::State const &)> createHistoryLikelihood(
+            solver::BeliefNode const *belief) override;
+
 
     /* ------------------- Pretty printing methods --------------------- */
     /** Displays an individual cell of the map. */
@@ -260,6 +311,11 @@ friend class RockSampleMdpSolver;
     virtual std::unique_ptr<solver::Action> getRolloutAction(solver::HistoryEntry const *entry,
             solver::State const *state, solver::HistoricalData const *data) override;
 
+    /** Returns EAST for every observation: the observations don't give the robot's position, so
+     * the only fallback that can't get stuck is to head straight for the exit.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<solver::Observation>,
+            std::unique_ptr<solver::Action>>> getFallbackActions() override;
 
     /* ------- Customization of more complex solver functionality  --------- */
     /** Returns all of the available actions in the RockSample POMDP, in enumerated order. */
@@ -280,8 +336,19 @@ friend class RockSampleMdpSolver;
 
     /** Generates an adjacent position without doing bounds checks or legality checks. */
     GridPosition makeAdjacentPosition(GridPosition position, ActionType actionType);
-    /** Generates the next position for the given position and action. */
+    /** Generates the next position for the given position and action type; a MOVE_TO action
+     * only moves via the overload below, which knows its rock.
+     */
     std::pair<GridPosition, bool> makeNextPosition(GridPosition pos, ActionType actionType);
+    /** Generates the next position for the given position and action, including MOVE_TO. */
+    std::pair<GridPosition, bool> makeNextPosition(GridPosition pos,
+            RockSampleAction const &action);
+    /** Returns the position after the moves of a MOVE_TO macro-action for the given rock.
+     *
+     * Each move follows a shortest path to the rock; once the robot is on the rock (or if it
+     * cannot be reached) it stays where it is for the rest of the moves.
+     */
+    GridPosition makeMacroPosition(GridPosition position, long rockNo);
     /**
      * Generates a next state for the given state and action;
      * returns true if the action was legal, and false if it was illegal.
@@ -301,6 +368,26 @@ friend class RockSampleMdpSolver;
             RockSampleState const &nextState,
             bool isLegal);
 
+    /** Calculates the exact belief for the given belief node, by replaying the action-observation
+     * history from the root of the tree.
+     *
+     * The replay starts from the root's belief, which is initially the start position with every
+     * rock good with probability 0.5. When Solver::resetTree() replaces the root, resetRoot()
+     * replays the old tree's path to the new root and stores the result, so the belief stays
+     * exact after a reset. Since the map can change, the position is also re-read from the
+     * particles of each belief along the way, rather than only replaying the moves against the
+     * current map.
+     *
+     * Returns the probability that each rock is good, and sets the given position to the robot's
+     * position in that belief.
+     */
+    std::vector<double> calculateRockBelief(solver::BeliefNode const *belief,
+            GridPosition &position);
+    /** Sets the given position to the robot's position in the given belief, which is the same for
+     * all of its particles; if the belief has no particles the position is left unchanged.
+     */
+    void readPosition(solver::BeliefNode const *belief, GridPosition &position);
+
   private:
     /**
      * Finds and counts the rocks on the map, and initializes the required
@@ -327,6 +414,13 @@ friend class RockSampleMdpSolver;
     GridPosition samplePosition();
     /** Generates the state of the rocks uniformly at random. */
     std::vector<bool> sampleRocks();
+    /** Generates the state of the rocks with the given probabilities of each rock being good. */
+    std::vector<bool> sampleRocks(std::vector<double> const &goodProbabilities);
+    /** Updates the robot position and the probabilities of each rock being good for the given
+     * action and observation.
+     */
+    void updateRockBelief(GridPosition &position, std::vector<double> &goodProbabilities,
+            RockSampleAction const &action, RockSampleObservation const &observation);
     /** Decodes rocks from an integer. */
     std::vector<bool> decodeRocks(long val);
     /** Encodes rocks to an integer. */
@@ -352,10 +446,20 @@ friend class RockSampleMdpSolver;
     long nCols_;
     /** The number of rocks on the map. */
     long nRocks_;
+    /** The number of action codes (see RockSampleAction). */
+    long nActions_;
     /** The starting position. */
     GridPosition startPos_;
     /** The coordinates of the rocks. */
     std::vector<GridPosition> rockPositions_;
+    /** For each row, a bitmask of the rocks in the rows above it. */
+    std::vector<uint64_t> rocksNorthOfRow_;
+    /** For each row, a bitmask of the rocks in the rows below it. */
+    std::vector<uint64_t> rocksSouthOfRow_;
+    /** For each column, a bitmask of the rocks in the columns to its right. */
+    std::vector<uint64_t> rocksEastOfColumn_;
+    /** For each column, a bitmask of the rocks in the columns to its left. */
+    std::vector<uint64_t> rocksWestOfColumn_;
     /** The coordinates of the goal squares. */
     std::vector<GridPosition> goalPositions_;
 
@@ -386,6 +490,11 @@ friend class RockSampleMdpSolver;
 
     /** Solver for the MDP version of the problem. */
     std::unique_ptr<RockSampleMdpSolver> mdpSolver_;
+
+    /** The robot's position in the belief at the root of the solver's tree. */
+    GridPosition rootPosition_;
+    /** The probability of each rock being good in the belief at the root of the solver's tree. */
+    std::vector<double> rootGoodProbabilities_;
 };
 } /* namespace rocksample */
 
@@ -29,6 +29,10 @@ struct RockSampleOptions : public shared::SharedOptions {
     double illegalMovePenalty = 0.0;
     /** half-efficiency distance. */
     double halfEfficiencyDistance = 0.0;
+    /** The number of moves made by each of the macro-actions, which move along a shortest path
+     * to one of the rocks and then wait there; 0 => no macro-actions.
+     */
+    long macroActionLength = 0;
 
 
     /* -------- Settings for RockSample-specific heuristics -------- */
@@ -67,6 +71,8 @@ struct RockSampleOptions : public shared::SharedOptions {
         parser->addOption<double>("problem", "exitReward", &RockSampleOptions::exitReward);
         parser->addOption<double>("problem", "illegalMovePenalty", &RockSampleOptions::illegalMovePenalty);
         parser->addOption<double>("problem", "halfEfficiencyDistance", &RockSampleOptions::halfEfficiencyDistance);
+        parser->addOptionWithDefault<long>("problem", "macroActionLength",
+                &RockSampleOptions::macroActionLength, 0);
     }
 
     /** Adds configuration options specific to the management of history-based data, e.g. the
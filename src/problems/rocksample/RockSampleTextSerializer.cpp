@@ -166,6 +166,9 @@ void RockSampleTextSerializer::saveAction(solver::Action const *action, std::ost
     if (code == ActionType::CHECK) {
         os << "CHECK-" << a.getRockNo();
         return;
+    } else if (code == ActionType::MOVE_TO) {
+        os << "GOTO-" << a.getRockNo();
+        return;
     }
     switch (code) {
     case ActionType::NORTH:
@@ -211,6 +214,14 @@ std::unique_ptr<solver::Action> RockSampleTextSerializer::loadAction(std::istrea
         long rockNo;
         sstr >> rockNo;
         return std::make_unique<RockSampleAction>(ActionType::CHECK, rockNo);
+    } else if (text.find("GOTO") != std::string::npos) {
+        std::string tmpStr;
+        std::istringstream sstr(text);
+        std::getline(sstr, tmpStr, '-');
+        long rockNo;
+        sstr >> rockNo;
+        long nRocks = static_cast<RockSampleModel *>(getModel())->getNumberOfRocks();
+        return std::make_unique<RockSampleAction>(ActionType::MOVE_TO, rockNo, nRocks);
     } else {
         std::string tmpStr;
         std::istringstream sstr(text);
@@ -34,7 +34,7 @@ std::unique_ptr<solver::HistoricalData> PositionData::createChild(
 
     bool isLegal;
     GridPosition nextPosition;
-    std::tie(nextPosition, isLegal) = model_->makeNextPosition(position_, rsAction.getActionType());
+    std::tie(nextPosition, isLegal) = model_->makeNextPosition(position_, rsAction);
     if (!isLegal) {
         debug::show_message("ERROR: An illegal action was taken!?");
     }
@@ -48,8 +48,7 @@ std::vector<long> PositionData::generateLegalActions() const {
                 static_cast<RockSampleAction const &>(*action);
         GridPosition nextPosition;
         bool isLegal;
-        std::tie(nextPosition, isLegal) = model_->makeNextPosition(position_,
-                rsAction.getActionType());
+        std::tie(nextPosition, isLegal) = model_->makeNextPosition(position_, rsAction);
         if (isLegal) {
             legalActions.push_back(rsAction.getBinNumber());
         }
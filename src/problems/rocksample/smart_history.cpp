@@ -4,6 +4,8 @@
  */
 #include "smart_history.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 
@@ -17,23 +19,76 @@
 #include "solver/abstract-problem/Action.hpp"
 
 namespace rocksample {
+/* ---------------------------- RockData --------------------------- */
+void RockData::setChanceGood(double probability) {
+    if (probability <= 0) {
+        chanceGood = 0;
+    } else if (probability >= 1) {
+        chanceGood = CERTAINLY_GOOD;
+    } else {
+        // Only exact 0s and 1s map to the endpoints.
+        long value = std::lround(probability * CERTAINLY_GOOD);
+        chanceGood = static_cast<uint16_t>(std::min<long>(std::max<long>(value, 1),
+                CERTAINLY_GOOD - 1));
+    }
+}
+
+void RockData::setCheckCount(long count) {
+    checkCount = static_cast<uint8_t>(std::min<long>(std::max<long>(count, 0),
+            std::numeric_limits<uint8_t>::max()));
+}
+
+void RockData::setGoodnessNumber(long number) {
+    goodnessNumber = static_cast<int8_t>(std::min<long>(
+            std::max<long>(number, std::numeric_limits<int8_t>::min()),
+            std::numeric_limits<int8_t>::max()));
+}
+
 /* ---------------------- PositionAndRockData --------------------- */
 PositionAndRockData::PositionAndRockData(RockSampleModel *model, GridPosition position) :
         model_(model),
         position_(position),
-        allRockData_(model_->getNumberOfRocks()) {
+        rockData_(),
+        rockDataOverflow_(),
+        worthwhileRocks_(0),
+        checkableRocks_(0) {
+    long nRocks = model_->getNumberOfRocks();
+    if (nRocks > MAX_INLINE_ROCKS) {
+        rockDataOverflow_.resize(nRocks);
+    }
+    for (long rockNo = 0; rockNo < nRocks; rockNo++) {
+        updateMasks(rockNo);
+    }
 }
 
 PositionAndRockData::PositionAndRockData(PositionAndRockData const &other) :
         model_(other.model_),
         position_(other.position_),
-        allRockData_(other.allRockData_) {
+        rockData_(other.rockData_),
+        rockDataOverflow_(other.rockDataOverflow_),
+        worthwhileRocks_(other.worthwhileRocks_),
+        checkableRocks_(other.checkableRocks_) {
 }
 
 std::unique_ptr<solver::HistoricalData> PositionAndRockData::copy() const {
     return std::make_unique<PositionAndRockData>(*this);
 }
 
+void PositionAndRockData::updateMasks(long rockNo) {
+    RockData const &rockData = getRockData(rockNo);
+    uint64_t rockBit = uint64_t(1) << rockNo;
+    if (rockData.isWorthwhile()) {
+        worthwhileRocks_ |= rockBit;
+    } else {
+        worthwhileRocks_ &= ~rockBit;
+    }
+    if (rockData.isCheckable()) {
+        checkableRocks_ |= rockBit;
+    } else {
+        checkableRocks_ &= ~rockBit;
+    }
+}
+
 std::unique_ptr<solver::HistoricalData> PositionAndRockData::createChild(
         solver::Action const &action, solver::Observation const &observation) const {
     RockSampleAction const &rsAction = static_cast<RockSampleAction const &>(action);
@@ -41,8 +96,7 @@ std::unique_ptr<solver::HistoricalData> PositionAndRockData::createChild(
     std::unique_ptr<PositionAndRockData> nextData = (std::make_unique<PositionAndRockData>(*this));
 
     bool isLegal;
-    std::tie(nextData->position_, isLegal) = model_->makeNextPosition(position_,
-            rsAction.getActionType());
+    std::tie(nextData->position_, isLegal) = model_->makeNextPosition(position_, rsAction);
     if (!isLegal) {
         debug::show_message("ERROR: An illegal action was taken!?");
         return std::move(nextData);
@@ -50,9 +104,11 @@ std::unique_ptr<solver::HistoricalData> PositionAndRockData::createChild(
 
     if (rsAction.getActionType() == ActionType::SAMPLE) {
         int rockNo = model_->getCellType(position_) - RockSampleModel::ROCK;
-        nextData->allRockData_[rockNo].chanceGood = 0.0;
-        nextData->allRockData_[rockNo].checkCount = 10;
-        nextData->allRockData_[rockNo].goodnessNumber = -10;
+        RockData &rockData = nextData->getRockData(rockNo);
+        rockData.setChanceGood(0.0);
+        rockData.setCheckCount(10);
+        rockData.setGoodnessNumber(-10);
+        nextData->updateMasks(rockNo);
     } else if (rsAction.getActionType() == ActionType::CHECK) {
         int rockNo = rsAction.getRockNo();
 
@@ -64,34 +120,43 @@ std::unique_ptr<solver::HistoricalData> PositionAndRockData::createChild(
         RockSampleObservation const &rsObs =
                 (static_cast<RockSampleObservation const &>(observation));
 
-        RockData &rockData = nextData->allRockData_[rockNo];
-        rockData.checkCount++;
-        double likelihoodGood = rockData.chanceGood;
-        double likelihoodBad = 1 - rockData.chanceGood;
+        RockData &rockData = nextData->getRockData(rockNo);
+        rockData.setCheckCount(rockData.checkCount + 1);
+        double likelihoodGood = rockData.getChanceGood();
+        double likelihoodBad = 1 - likelihoodGood;
         if (rsObs.isGood()) {
-            rockData.goodnessNumber++;
+            rockData.setGoodnessNumber(rockData.goodnessNumber + 1);
             likelihoodGood *= probabilityCorrect;
             likelihoodBad *= probabilityIncorrect;
         } else {
-            rockData.goodnessNumber--;
+            rockData.setGoodnessNumber(rockData.goodnessNumber - 1);
             likelihoodGood *= probabilityIncorrect;
             likelihoodBad *= probabilityCorrect;
         }
-        rockData.chanceGood = likelihoodGood / (likelihoodGood + likelihoodBad);
+        rockData.setChanceGood(likelihoodGood / (likelihoodGood + likelihoodBad));
+        nextData->updateMasks(rockNo);
     }
     return std::move(nextData);
 }
 
 std::vector<long> PositionAndRockData::generateLegalActions() const {
+    long nRocks = model_->getNumberOfRocks();
     std::vector<long> legalActions;
-    for (std::unique_ptr<solver::DiscretizedPoint> const &action : model_->getAllActionsInOrder()) {
-        RockSampleAction const &rsAction = static_cast<RockSampleAction const &>(*action);
-        GridPosition nextPosition;
-        bool isLegal;
-        std::tie(nextPosition, isLegal) = model_->makeNextPosition(position_,
-                rsAction.getActionType());
-        if (isLegal) {
-            legalActions.push_back(rsAction.getBinNumber());
+    legalActions.reserve(model_->getNumberOfActions());
+    // Moves and sampling, in the same order as the action codes.
+    for (long code = 0; code <= static_cast<long>(ActionType::SAMPLE); code++) {
+        if (model_->makeNextPosition(position_, static_cast<ActionType>(code)).second) {
+            legalActions.push_back(code);
+        }
+    }
+    // Checking is always legal.
+    for (long rockNo = 0; rockNo < nRocks; rockNo++) {
+        legalActions.push_back(static_cast<long>(ActionType::CHECK) + rockNo);
+    }
+    // So is moving toward a rock, which stops wherever the rock can no longer be approached.
+    if (model_->hasMacroActions()) {
+        for (long rockNo = 0; rockNo < nRocks; rockNo++) {
+            legalActions.push_back(static_cast<long>(ActionType::CHECK) + nRocks + rockNo);
         }
     }
     return legalActions;
@@ -107,63 +172,41 @@ std::vector<long> PositionAndRockData::generatePreferredActions() const {
     // If we are on top of a rock, and it has more +ve than -ve observations
     // then we will sample it.
     if (rockNo >= 0 && rockNo < nRocks) {
-        RockData const &rockData = allRockData_[rockNo];
-        if (rockData.chanceGood == 1.0 || rockData.goodnessNumber > 0) {
+        RockData const &rockData = getRockData(rockNo);
+        if (rockData.chanceGood == RockData::CERTAINLY_GOOD || rockData.goodnessNumber > 0) {
             preferredActions.push_back(static_cast<long>(ActionType::SAMPLE));
             return preferredActions;
         }
     }
 
-    bool worthwhileRockFound = false;
-    bool northWorthwhile = false;
-    bool southWorthwhile = false;
-    bool eastWorthwhile = false;
-    bool westWorthwhile = false;
-
-    // Check to see which rocks are worthwhile.
-    for (int i = 0; i < nRocks; i++) {
-        RockData const &rockData = allRockData_[i];
-        if (rockData.chanceGood != 0.0 && rockData.goodnessNumber >= 0) {
-            worthwhileRockFound = true;
-            GridPosition pos = model_->getRockPosition(i);
-            if (pos.i > position_.i) {
-                southWorthwhile = true;
-            } else if (pos.i < position_.i) {
-                northWorthwhile = true;
-            }
-
-            if (pos.j > position_.j) {
-                eastWorthwhile = true;
-            } else if (pos.j < position_.j) {
-                westWorthwhile = true;
-            }
-        }
-    }
     // If no rocks are worthwhile head east.
-    if (!worthwhileRockFound) {
+    if (worthwhileRocks_ == 0) {
         preferredActions.push_back(static_cast<long>(ActionType::EAST));
         return preferredActions;
     }
 
-    if (northWorthwhile) {
-        preferredActions.push_back(static_cast<long>(ActionType::NORTH));
-    }
-    if (southWorthwhile) {
-        preferredActions.push_back(static_cast<long>(ActionType::SOUTH));
-    }
-    if (eastWorthwhile) {
-        preferredActions.push_back(static_cast<long>(ActionType::EAST));
-    }
-    if (westWorthwhile) {
-        preferredActions.push_back(static_cast<long>(ActionType::WEST));
+    // Head in each direction that has a worthwhile rock in it.
+    for (ActionType direction : { ActionType::NORTH, ActionType::SOUTH, ActionType::EAST,
+            ActionType::WEST }) {
+        if ((worthwhileRocks_ & model_->getRocksInDirection(position_, direction)) != 0) {
+            preferredActions.push_back(static_cast<long>(direction));
+        }
     }
 
     // See which rocks we might want to check
-    for (int i = 0; i < nRocks; i++) {
-        RockData const &rockData = allRockData_[i];
-        if (rockData.chanceGood != 0.0 && rockData.chanceGood != 1.0
-                && std::abs(rockData.goodnessNumber) < 2) {
-            preferredActions.push_back(static_cast<long>(ActionType::CHECK) + i);
+    for (uint64_t rocks = checkableRocks_; rocks != 0; rocks &= rocks - 1) {
+        long checkedRockNo = __builtin_ctzll(rocks);
+        preferredActions.push_back(static_cast<long>(ActionType::CHECK) + checkedRockNo);
+    }
+
+    // Move toward each worthwhile rock, other than the one we're on.
+    if (model_->hasMacroActions()) {
+        for (uint64_t rocks = worthwhileRocks_; rocks != 0; rocks &= rocks - 1) {
+            long targetRockNo = __builtin_ctzll(rocks);
+            if (targetRockNo != rockNo) {
+                preferredActions.push_back(static_cast<long>(ActionType::CHECK) + nRocks
+                        + targetRockNo);
+            }
         }
     }
     return preferredActions;
@@ -172,8 +215,8 @@ std::vector<long> PositionAndRockData::generatePreferredActions() const {
 void PositionAndRockData::print(std::ostream &os) const {
     os << "Position: " << position_ << std::endl;
     os << "Chances of goodness: ";
-    for (RockData const &rockData : allRockData_) {
-        tapir::print_double(rockData.chanceGood, os, 6, 4);
+    for (long rockNo = 0; rockNo < model_->getNumberOfRocks(); rockNo++) {
+        tapir::print_double(getRockData(rockNo).getChanceGood(), os, 6, 4);
         os << " ";
     }
     os << std::endl;
@@ -186,11 +229,12 @@ void PositionAndRockDataTextSerializer::saveHistoricalData(solver::HistoricalDat
     os << "CUSTOM DATA:" << std::endl;
     PositionAndRockData const &prData = (static_cast<PositionAndRockData const &>(*data));
     os << "Position: " << prData.position_ << std::endl;
-    for (RockData const &rockData : prData.allRockData_) {
+    for (long rockNo = 0; rockNo < prData.model_->getNumberOfRocks(); rockNo++) {
+        RockData const &rockData = prData.getRockData(rockNo);
         os << "p = ";
-        tapir::print_double(rockData.chanceGood, os, 7, 5);
-        os << " from " << rockData.checkCount << " checks ( ";
-        os << std::showpos << rockData.goodnessNumber << std::noshowpos;
+        tapir::print_double(rockData.getChanceGood(), os, 7, 5);
+        os << " from " << static_cast<long>(rockData.checkCount) << " checks ( ";
+        os << std::showpos << static_cast<long>(rockData.goodnessNumber) << std::noshowpos;
         os << " )" << std::endl;
     }
     os << std::endl;
@@ -211,13 +255,21 @@ std::unique_ptr<solver::HistoricalData> PositionAndRockDataTextSerializer::loadH
     std::unique_ptr<PositionAndRockData> data = (std::make_unique<PositionAndRockData>(model,
             position));
 
-    for (RockData &rockData : data->allRockData_) {
+    for (long rockNo = 0; rockNo < model->getNumberOfRocks(); rockNo++) {
         std::getline(is, line);
         std::istringstream sstr(line);
 
-        sstr >> tmpStr >> tmpStr >> rockData.chanceGood;
-        sstr >> tmpStr >> rockData.checkCount >> tmpStr >> tmpStr;
-        sstr >> rockData.goodnessNumber;
+        double chanceGood;
+        long checkCount, goodnessNumber;
+        sstr >> tmpStr >> tmpStr >> chanceGood;
+        sstr >> tmpStr >> checkCount >> tmpStr >> tmpStr;
+        sstr >> goodnessNumber;
+
+        RockData &rockData = data->getRockData(rockNo);
+        rockData.setChanceGood(chanceGood);
+        rockData.setCheckCount(checkCount);
+        rockData.setGoodnessNumber(goodnessNumber);
+        data->updateMasks(rockNo);
     }
 
     std::getline(is, line); // Blank line
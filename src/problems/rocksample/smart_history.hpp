@@ -6,6 +6,11 @@
 #ifndef ROCKSAMPLE_SMART_HISTORY_HPP_
 #define ROCKSAMPLE_SMART_HISTORY_HPP_
 
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include "solver/abstract-problem/HistoricalData.hpp"
 
 #include "solver/serialization/TextSerializer.hpp"
@@ -16,17 +21,45 @@ namespace rocksample {
 class RockSampleAction;
 class RockSampleModel;
 
-/** Stores data about each rock.
+/** Stores data about each rock, packed into four bytes.
+ *
+ * The probability of goodness is quantized to 16 bits; the values 0 and 1 are represented
+ * exactly, since the preferred actions depend on them. Both counters saturate instead of
+ * overflowing.
  */
 struct RockData {
-    /** The number of times this rock has been checked. */
-    long checkCount = 0;
+    /** The quantized value that represents a probability of 1. */
+    static constexpr uint16_t CERTAINLY_GOOD = std::numeric_limits<uint16_t>::max();
+
+    /** Returns the calculated probability that this rock is good. */
+    double getChanceGood() const {
+        return static_cast<double>(chanceGood) / CERTAINLY_GOOD;
+    }
+    /** Sets the probability that this rock is good. */
+    void setChanceGood(double probability);
+    /** Sets the number of times this rock has been checked. */
+    void setCheckCount(long count);
+    /** Sets the "goodness number" for this rock. */
+    void setGoodnessNumber(long number);
+
+    /** Returns true iff this rock is still worth visiting. */
+    bool isWorthwhile() const {
+        return chanceGood != 0 && goodnessNumber >= 0;
+    }
+    /** Returns true iff checking this rock would still be informative. */
+    bool isCheckable() const {
+        return (chanceGood != 0 && chanceGood != CERTAINLY_GOOD
+                && goodnessNumber > -2 && goodnessNumber < 2);
+    }
+
+    /** The quantized probability that this rock is good. */
+    uint16_t chanceGood = (CERTAINLY_GOOD + 1) / 2;
     /** The "goodness number"; +1 for each good observation of this rock, and -1 for each bad
      * observation of this rock.
      */
-    long goodnessNumber = 0;
-    /** The calculated probability that this rock is good. */
-    double chanceGood = 0.5;
+    int8_t goodnessNumber = 0;
+    /** The number of times this rock has been checked. */
+    uint8_t checkCount = 0;
 };
 
 /** A class to store the robot position associated with a given belief node, as well as
@@ -67,12 +100,32 @@ public:
     void print(std::ostream &os) const override;
 
 private:
+    /** The number of rocks whose data is stored inline within the instance itself. */
+    static constexpr long MAX_INLINE_ROCKS = 16;
+
+    /** Returns the data for the given rock. */
+    RockData &getRockData(long rockNo) {
+        return rockDataOverflow_.empty() ? rockData_[rockNo] : rockDataOverflow_[rockNo];
+    }
+    /** Returns the data for the given rock. */
+    RockData const &getRockData(long rockNo) const {
+        return rockDataOverflow_.empty() ? rockData_[rockNo] : rockDataOverflow_[rockNo];
+    }
+    /** Updates the worthwhile and checkable bitmasks for the given rock. */
+    void updateMasks(long rockNo);
+
     /** The associated model instance. */
     RockSampleModel *model_;
     /** The grid position. */
     GridPosition position_;
-    /** The data for each rock, in order of rock number. */
-    std::vector<RockData> allRockData_;
+    /** The data for each rock, in order of rock number, if there are few enough rocks. */
+    std::array<RockData, MAX_INLINE_ROCKS> rockData_;
+    /** The data for each rock, if there are too many to store them inline. */
+    std::vector<RockData> rockDataOverflow_;
+    /** A bitmask of the rocks that are still worth visiting. */
+    uint64_t worthwhileRocks_;
+    /** A bitmask of the rocks that are still worth checking. */
+    uint64_t checkableRocks_;
 };
 
 /** An implementation of the serialization methods for the
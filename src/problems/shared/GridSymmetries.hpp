@@ -0,0 +1,153 @@
+/** @file GridSymmetries.hpp
+ *
+ * Defines the GridSymmetries class, which finds the rotations and reflections that map a 2-D grid
+ * map onto itself, so that values which only depend on positions within that map can be
+ * calculated once for each set of symmetric positions.
+ */
+#ifndef GRIDSYMMETRIES_HPP_
+#define GRIDSYMMETRIES_HPP_
+
+#include <vector>
+
+#include "global.hpp"
+
+#include "GridPosition.hpp"
+
+/** The rotations and reflections of a rectangular grid map that leave the map unchanged.
+ *
+ * Each symmetry is one of the eight symmetries of a square: the identity, the reflections in the
+ * two axes and the two diagonals, and the rotations by 90, 180 and 270 degrees. The diagonal
+ * reflections and the quarter turns are only considered for square maps, and a symmetry is only
+ * kept if it maps every cell onto a cell of the same type (as compared by ==). The identity is
+ * always symmetry #0.
+ *
+ * If a model's dynamics treat all four directions alike, any two states that are related by one
+ * of these symmetries have the same value, and so tables of such values only need an entry for
+ * one canonical state out of each set of symmetric states.
+ */
+class GridSymmetries {
+public:
+    /** Creates an instance that only contains the identity. */
+    GridSymmetries() :
+            nRows_(0),
+            nCols_(0),
+            symmetries_( { 0 }) {
+    }
+
+    /** Finds the symmetries of the given map, which is indexed as [i][j]. */
+    template<typename CellType>
+    GridSymmetries(std::vector<std::vector<CellType>> const &map) :
+            nRows_(map.size()),
+            nCols_(map.empty() ? 0 : map[0].size()),
+            symmetries_( { 0 }) {
+        long nSymmetries = (nRows_ == nCols_ ? 8 : 4);
+        for (int symmetry = 1; symmetry < nSymmetries; symmetry++) {
+            bool isSymmetric = true;
+            for (long i = 0; isSymmetric && i < nRows_; i++) {
+                for (long j = 0; j < nCols_; j++) {
+                    GridPosition image = apply(symmetry, GridPosition(i, j));
+                    if (!(map[image.i][image.j] == map[i][j])) {
+                        isSymmetric = false;
+                        break;
+                    }
+                }
+            }
+            if (isSymmetric) {
+                symmetries_.push_back(symmetry);
+            }
+        }
+    }
+
+    /** Returns the number of symmetries of the map, including the identity. */
+    long getNumberOfSymmetries() const {
+        return symmetries_.size();
+    }
+
+    /** Returns the image of the given position under the symmetry with the given index. */
+    GridPosition transform(long index, GridPosition const &position) const {
+        return apply(symmetries_[index], position);
+    }
+
+    /** Returns the index of the symmetry that maps the given positions onto their canonical
+     * images - the ones that come first in lexicographic order.
+     *
+     * Positions that are related by a symmetry therefore have the same canonical images.
+     */
+    long getCanonicalIndex(std::vector<GridPosition> const &positions) const {
+        long bestIndex = 0;
+        for (long index = 1; index < getNumberOfSymmetries(); index++) {
+            for (GridPosition const &position : positions) {
+                GridPosition image = transform(index, position);
+                GridPosition bestImage = transform(bestIndex, position);
+                if (image.i != bestImage.i) {
+                    if (image.i < bestImage.i) {
+                        bestIndex = index;
+                    }
+                    break;
+                }
+                if (image.j != bestImage.j) {
+                    if (image.j < bestImage.j) {
+                        bestIndex = index;
+                    }
+                    break;
+                }
+            }
+        }
+        return bestIndex;
+    }
+
+    /** Returns true iff the given positions are already their own canonical images. */
+    bool isCanonical(std::vector<GridPosition> const &positions) const {
+        long index = getCanonicalIndex(positions);
+        for (GridPosition const &position : positions) {
+            if (transform(index, position) != position) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Returns true iff the other instance is for a map of the same size, with the same
+     * symmetries.
+     */
+    bool operator==(GridSymmetries const &other) const {
+        return (nRows_ == other.nRows_ && nCols_ == other.nCols_
+                && symmetries_ == other.symmetries_);
+    }
+
+private:
+    /** Applies the symmetry with the given number (0-7) to the given position. */
+    GridPosition apply(int symmetry, GridPosition const &position) const {
+        long i = position.i;
+        long j = position.j;
+        long lastRow = nRows_ - 1;
+        long lastCol = nCols_ - 1;
+        switch (symmetry) {
+        case 1: // Reflection in the vertical axis.
+            return GridPosition(i, lastCol - j);
+        case 2: // Reflection in the horizontal axis.
+            return GridPosition(lastRow - i, j);
+        case 3: // Rotation by 180 degrees.
+            return GridPosition(lastRow - i, lastCol - j);
+        case 4: // Reflection in the main diagonal.
+            return GridPosition(j, i);
+        case 5: // Rotation by 90 degrees clockwise.
+            return GridPosition(j, lastRow - i);
+        case 6: // Rotation by 90 degrees anticlockwise.
+            return GridPosition(lastCol - j, i);
+        case 7: // Reflection in the other diagonal.
+            return GridPosition(lastCol - j, lastRow - i);
+        default: // The identity.
+            return position;
+        }
+    }
+
+    /** The number of rows in the map. */
+    long nRows_;
+    /** The number of columns in the map. */
+    long nCols_;
+    /** The numbers of the symmetries of the map; see apply(). */
+    std::vector<int> symmetries_;
+};
+
+#endif /* GRIDSYMMETRIES_HPP_ */
@@ -46,6 +46,8 @@ public:
         selectRecommendedActionParsers_(),
         estimationParsers_() {
         registerGeneratorParser("ucb", std::make_unique<UcbParser>());
+        registerGeneratorParser("ucbTuned", std::make_unique<UcbTunedParser>());
+        registerGeneratorParser("ucbv", std::make_unique<UcbVParser>());
         registerGeneratorParser("gps", std::make_unique<GpsParser>());
         registerGeneratorParser("rollout", std::make_unique<DefaultRolloutParser>());
         registerGeneratorParser("nn", std::make_unique<NnRolloutParser>());
@@ -53,10 +55,16 @@ public:
 
         registerHeuristicParser("default", std::make_unique<DefaultHeuristicParser>(this));
         registerHeuristicParser("zero", std::make_unique<ZeroHeuristicParser>());
+        registerHeuristicParser("neighbour",
+                std::make_unique<NeighbourHeuristicParser>(&heuristicParsers_));
+        registerHeuristicParser("rollout",
+                std::make_unique<RolloutHeuristicParser>(&heuristicParsers_));
 
         searchParsers_.setDefaultParser(std::make_unique<BasicSearchParser>(
                 &generatorParsers_, &heuristicParsers_, options_->searchHeuristic));
         registerSearchParser("exp3", std::make_unique<Exp3Parser>(&searchParsers_));
+        registerSearchParser("tune", std::make_unique<TuneParser>(&heuristicParsers_,
+                options_->searchHeuristic));
 
         registerEstimationParser("mean", std::make_unique<AverageEstimateParser>());
         registerEstimationParser("max", std::make_unique<MaxEstimateParser>());
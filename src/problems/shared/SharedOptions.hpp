@@ -28,6 +28,10 @@ struct SharedOptions: public solver::Options {
     std::string configPath = "";
     /** The path to the policy file. */
     std::string policyPath = "";
+    /** The path to write a decision table to after solving; empty => no decision table. */
+    std::string decisionTablePath = "";
+    /** The maximum depth of the decision table. */
+    long decisionTableDepth = 0;
     /** The seed value to use for the RNG. */
     unsigned long seed = 0;
     /** A custom state to load for RNG. */
@@ -65,6 +69,12 @@ struct SharedOptions: public solver::Options {
     /** The maximum distance between observations to group together; only applicable if
      * approximate observations are in use. */
     double maxObservationDistance = 0.0;
+    /** The coefficient k for observation progressive widening, which limits each action node to
+     * k * N^alpha observation children; only applicable if approximate observations are in use.
+     * (0 => no widening) */
+    double observationWideningCoefficient = 0.0;
+    /** The exponent alpha for observation progressive widening. */
+    double observationWideningExponent = 0.5;
 
     /** Makes a parser which can parse options from config files, or from the command line,
      * into a SharedOptions instance.
@@ -99,6 +109,16 @@ struct SharedOptions: public solver::Options {
         parser->addValueArg("", "policy", &SharedOptions::policyPath, "", "policy",
                 "policy file path (output)", "path");
 
+        parser->addOptionWithDefault<std::string>("", "decisionTable",
+                &SharedOptions::decisionTablePath, "");
+        parser->addValueArg("", "decisionTable", &SharedOptions::decisionTablePath, "",
+                "decision-table", "decision table file path (output); empty => none", "path");
+
+        parser->addOptionWithDefault<long>("", "decisionTableDepth",
+                &SharedOptions::decisionTableDepth, 10);
+        parser->addValueArg("", "decisionTableDepth", &SharedOptions::decisionTableDepth, "",
+                "decision-table-depth", "maximum depth of the decision table", "int");
+
         parser->addOptionWithDefault<unsigned long>("", "seed", &SharedOptions::seed, 0);
         parser->addValueArg("", "seed", &SharedOptions::seed, "s", "seed",
                 "RNG seed; 0=>current time", "ulong");
@@ -141,6 +161,18 @@ struct SharedOptions: public solver::Options {
             parser->addOption<bool>("ABT", "pruneEveryStep", &Options::pruneEveryStep);
             parser->addOption<bool>("ABT", "resetOnChanges", &Options::resetOnChanges);
         }
+        parser->addOptionWithDefault<bool>("ABT", "useKldSampling", &Options::useKldSampling,
+                false);
+        parser->addOptionWithDefault<double>("ABT", "kldError", &Options::kldError, 0.05);
+        parser->addOptionWithDefault<double>("ABT", "kldQuantile", &Options::kldQuantile, 2.326);
+        parser->addOptionWithDefault<unsigned long>("ABT", "kldMinParticleCount",
+                &Options::kldMinParticleCount, 100);
+        parser->addOptionWithDefault<unsigned long>("ABT", "kldMaxParticleCount",
+                &Options::kldMaxParticleCount, 10000);
+        parser->addOptionWithDefault<unsigned long>("ABT", "rejuvenationSteps",
+                &Options::rejuvenationSteps, 0);
+        parser->addOptionWithDefault<unsigned long>("ABT", "replenishingThreads",
+                &Options::replenishingThreads, 1);
 
         parser->addOptionWithDefault<long>("simulation", "nRuns", &SharedOptions::nRuns, 1);
         parser->addOptionWithDefault<bool>("simulation", "loadInitialPolicy", &SharedOptions::loadInitialPolicy, false);
@@ -167,6 +199,16 @@ struct SharedOptions: public solver::Options {
                     &Options::minParticleCount, "", "min-particles", "Minimum allowable particles"
                             " per belief during simulation - if the count drops below this value,"
                             " extra particles will be resampled via a particle filter.", "int");
+            parser->addSwitchArg("ABT", "useKldSampling", &Options::useKldSampling, "", "kld",
+                    "choose the number of particles for each belief via KLD-sampling, instead of"
+                            " always using the minimum particle count.", true);
+            parser->addValueArg<unsigned long>("ABT", "rejuvenationSteps",
+                    &Options::rejuvenationSteps, "", "rejuvenate", "Number of Metropolis-Hastings"
+                            " moves to make for each replenished particle (if the model supports"
+                            " them).", "int");
+            parser->addValueArg<unsigned long>("ABT", "replenishingThreads",
+                    &Options::replenishingThreads, "", "replenish-threads", "Number of threads"
+                            " to generate replacement particles with.", "int");
             parser->addSwitchArg("ABT", "pruneEveryStep",
                     &Options::pruneEveryStep, "", "prune", "Prune after every step"
                             " of the simulation.", true);
@@ -198,6 +240,8 @@ struct SharedOptions: public solver::Options {
                 "keep track of states in an index data structure (usually a spatial index)", true);
         parser->addSwitchArg("ABT", "useStateIndex", &Options::useStateIndex, "", "no-index",
                         "don't keep track of states in an index data structure", false);
+        parser->addOptionWithDefault<bool>("ABT", "deduplicateStates",
+                &Options::deduplicateStates, true);
 
 
         parser->addOption<unsigned long>("ABT", "historiesPerStep", &Options::historiesPerStep);
@@ -210,14 +254,44 @@ struct SharedOptions: public solver::Options {
                 "t", "timeout", "step timeout in milliseconds; 0=>no timeout", "real");
 
         parser->addOption<long>("ABT", "maximumDepth", &Options::maximumDepth);
+        parser->addOptionWithDefault<long>("ABT", "openLoopDepth", &Options::openLoopDepth, 0);
+        parser->addValueArg<long>("ABT", "openLoopDepth", &Options::openLoopDepth,
+                "", "open-loop-depth", "depth (relative to the current belief) beyond which"
+                        " observations are ignored while searching; 0=>closed-loop search", "int");
         parser->addOption<bool>("ABT", "isAbsoluteHorizon", &Options::isAbsoluteHorizon);
+        parser->addOptionWithDefault<bool>("ABT", "useSequentialHalving",
+                &Options::useSequentialHalving, false);
+        parser->addSwitchArg("ABT", "useSequentialHalving", &Options::useSequentialHalving, "",
+                "halving", "choose the action to take via sequential halving instead of UCB",
+                true);
+        parser->addOptionWithDefault<long>("ABT", "rolloutExpansionSteps",
+                &Options::rolloutExpansionSteps, 0);
+        parser->addValueArg<long>("ABT", "rolloutExpansionSteps", &Options::rolloutExpansionSteps,
+                "", "expand", "maximum # of rollout steps past each new leaf to keep in the tree",
+                "int");
+        parser->addOptionWithDefault<long>("ABT", "rolloutExpansionVisitThreshold",
+                &Options::rolloutExpansionVisitThreshold, 100);
+        parser->addOptionWithDefault<long>("ABT", "rolloutExpansionNodeLimit",
+                &Options::rolloutExpansionNodeLimit, 0);
 
         parser->addOption<std::string>("ABT", "searchHeuristic", &SharedOptions::searchHeuristic);
         parser->addOption<std::string>("ABT", "searchStrategy", &SharedOptions::searchStrategy);
         parser->addOptionWithDefault<std::string>("ABT", "recommendationStrategy", &SharedOptions::recommendationStrategy, "max");
         parser->addOption<std::string>("ABT", "estimator", &SharedOptions::estimator);
+        parser->addOptionWithDefault<long>("ABT", "backupSteps", &Options::backupSteps, 1);
+        parser->addValueArg<long>("ABT", "backupSteps", &Options::backupSteps, "",
+                "backup-steps", "number of steps of rewards in each Q-value before it"
+                        " bootstraps from the estimated value of a belief", "int");
+        parser->addOptionWithDefault<double>("ABT", "backupLambda", &Options::backupLambda, 0.0);
+        parser->addValueArg<double>("ABT", "backupLambda", &Options::backupLambda, "",
+                "lambda", "weight of the sampled returns relative to the estimated value of"
+                        " each belief in its backups; 0=>estimate only, 1=>Monte Carlo", "real");
         parser->addOptionWithDefault<double>("ABT", "maxObservationDistance",
                 &SharedOptions::maxObservationDistance, 0.0);
+        parser->addOptionWithDefault<double>("ABT", "observationWideningCoefficient",
+                &SharedOptions::observationWideningCoefficient, 0.0);
+        parser->addOptionWithDefault<double>("ABT", "observationWideningExponent",
+                &SharedOptions::observationWideningExponent, 0.5);
     }
 
     /** Adds the discountFactor option to the given parser. */
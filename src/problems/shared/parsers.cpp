@@ -5,6 +5,7 @@
  */
 #include "parsers.hpp"
 
+#include <cmath>
 #include <iostream>
 
 #include "global.hpp"
@@ -13,11 +14,15 @@
 #include "solver/Solver.hpp"
 
 #include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
+#include "solver/abstract-problem/heuristics/NeighbourHeuristic.hpp"
+#include "solver/abstract-problem/heuristics/RolloutHeuristic.hpp"
 
 #include "solver/belief-estimators/estimators.hpp"
 
 #include "solver/search/search_interface.hpp"
 #include "solver/search/MultipleStrategiesExp3.hpp"
+#include "solver/search/ParameterTuningExp3.hpp"
+#include "solver/search/action-choosers/choosers.hpp"
 #include "solver/search/steppers/ucb_search.hpp"
 #include "solver/search/steppers/gps_search.hpp"
 #include "solver/search/steppers/default_rollout.hpp"
@@ -75,6 +80,30 @@ std::unique_ptr<solver::StepGeneratorFactory> UcbParser::parse(solver::Solver *s
     return std::make_unique<solver::UcbStepGeneratorFactory>(solver, explorationCoefficient);
 }
 
+std::unique_ptr<solver::StepGeneratorFactory> UcbTunedParser::parse(solver::Solver *solver,
+        std::vector<std::string> args) {
+    double valueRange;
+    std::istringstream(args[1]) >> valueRange;
+    return std::make_unique<solver::UcbStepGeneratorFactory>(solver,
+            [valueRange](solver::BeliefNode const *node) {
+        return solver::choosers::ucb_tuned_action(node, valueRange);
+    });
+}
+
+std::unique_ptr<solver::StepGeneratorFactory> UcbVParser::parse(solver::Solver *solver,
+        std::vector<std::string> args) {
+    double valueRange;
+    std::istringstream(args[1]) >> valueRange;
+    double zeta = 1.2;
+    if (args.size() > 2) {
+        std::istringstream(args[2]) >> zeta;
+    }
+    return std::make_unique<solver::UcbStepGeneratorFactory>(solver,
+            [valueRange, zeta](solver::BeliefNode const *node) {
+        return solver::choosers::ucbv_action(node, valueRange, zeta);
+    });
+}
+
 std::unique_ptr<solver::StepGeneratorFactory> GpsParser::parse(solver::Solver *solver, std::vector<std::string> args) {
 
 	using solver::choosers::GpsChooserOptions;
@@ -153,6 +182,56 @@ solver::HeuristicFunction ZeroHeuristicParser::parse(
     };
 }
 
+NeighbourHeuristicParser::NeighbourHeuristicParser(
+        ParserSet<solver::HeuristicFunction> *allParsers) :
+        allParsers_(allParsers) {
+}
+solver::HeuristicFunction NeighbourHeuristicParser::parse(solver::Solver *solver,
+        std::vector<std::string> args) {
+    unsigned long numberOfNeighbours = 10;
+    fillOption(args, "neighbours", numberOfNeighbours);
+    std::string fallbackString = "default()";
+    fillOption(args, "fallback", fallbackString);
+
+    solver::HeuristicFunction fallback = allParsers_->parse(solver, fallbackString);
+    if (solver == nullptr) {
+        // Without a solver there are no histories to look at.
+        return fallback;
+    }
+    std::shared_ptr<solver::NeighbourHeuristic> heuristic = (
+            std::make_shared<solver::NeighbourHeuristic>(solver, numberOfNeighbours, fallback));
+    return [heuristic] (solver::HistoryEntry const *entry,
+            solver::State const *state, solver::HistoricalData const *data) {
+        return heuristic->getHeuristicValue(entry, state, data);
+    };
+}
+
+RolloutHeuristicParser::RolloutHeuristicParser(
+        ParserSet<solver::HeuristicFunction> *allParsers) :
+        allParsers_(allParsers) {
+}
+solver::HeuristicFunction RolloutHeuristicParser::parse(solver::Solver *solver,
+        std::vector<std::string> args) {
+    long maxNSteps = 20;
+    fillOption(args, "steps", maxNSteps);
+    std::string fallbackString = "default()";
+    fillOption(args, "fallback", fallbackString);
+
+    solver::HeuristicFunction fallback = allParsers_->parse(solver, fallbackString);
+    if (solver == nullptr) {
+        // Without a solver there is no way to generate the rollout steps.
+        return fallback;
+    }
+    std::shared_ptr<solver::RolloutHeuristic> heuristic = (
+            std::make_shared<solver::RolloutHeuristic>(solver->getModel(),
+                    std::make_unique<solver::DefaultRolloutFactory>(solver, maxNSteps),
+                    fallback));
+    return [heuristic] (solver::HistoryEntry const *entry,
+            solver::State const *state, solver::HistoricalData const *data) {
+        return heuristic->getHeuristicValue(entry, state, data);
+    };
+}
+
 BasicSearchParser::BasicSearchParser(
         ParserSet<std::unique_ptr<solver::StepGeneratorFactory>> *generatorParsers,
         ParserSet<solver::HeuristicFunction> *heuristicParsers, std::string heuristicString) :
@@ -195,6 +274,85 @@ std::unique_ptr<solver::SearchStrategy> Exp3Parser::parse(solver::Solver *solver
             std::move(strategies));
 }
 
+TuneParser::TuneParser(ParserSet<solver::HeuristicFunction> *heuristicParsers,
+        std::string heuristicString) :
+            heuristicParsers_(heuristicParsers),
+            heuristicString_(heuristicString) {
+}
+std::unique_ptr<solver::SearchStrategy> TuneParser::parse(solver::Solver *solver,
+        std::vector<std::string> args) {
+    double explorationCoefficient = 0.1;
+    fillOption(args, "exploration", explorationCoefficient);
+    double stepRatio = 2.0;
+    fillOption(args, "ratio", stepRatio);
+    double ucbCoefficient = 1.0;
+    fillOption(args, "ucb", ucbCoefficient);
+    long rolloutSteps = 0;
+    fillOption(args, "rollout", rolloutSteps);
+    long maxRolloutSteps = 100;
+    fillOption(args, "maxRollout", maxRolloutSteps);
+
+    // fillOption() only finds the first value, but there can be several heuristics.
+    std::vector<std::string> heuristicStrings;
+    for (auto it = args.begin() + 1; it != args.end(); it++) {
+        std::size_t equalPos = it->find('=');
+        if (equalPos == std::string::npos) {
+            continue;
+        }
+        std::string name = it->substr(0, equalPos);
+        std::string value = it->substr(equalPos + 1);
+        tapir::trim(name);
+        tapir::trim(value);
+        if (name == "heuristic") {
+            heuristicStrings.push_back(value);
+        }
+    }
+    if (heuristicStrings.empty()) {
+        heuristicStrings.push_back(heuristicString_);
+    }
+
+    std::vector<solver::HeuristicFunction> heuristics;
+    for (std::string const &heuristicString : heuristicStrings) {
+        heuristics.push_back(heuristicParsers_->parse(solver, heuristicString));
+    }
+
+    using Parameter = solver::ParameterTuningExp3::Parameter;
+    using ParameterType = solver::ParameterTuningExp3::ParameterType;
+    std::vector<Parameter> parameters(3);
+    parameters[0].name = "ucb";
+    parameters[0].value = ucbCoefficient;
+    parameters[0].minValue = ucbCoefficient / 1000;
+    parameters[0].maxValue = ucbCoefficient * 1000;
+    parameters[1].name = "rollout";
+    parameters[1].type = ParameterType::INTEGER;
+    parameters[1].value = rolloutSteps;
+    parameters[1].maxValue = maxRolloutSteps;
+    parameters[2].name = "heuristic";
+    parameters[2].type = ParameterType::CATEGORICAL;
+    parameters[2].maxValue = heuristics.size() - 1;
+    parameters[2].labels = heuristicStrings;
+
+    solver::ParameterTuningExp3::StrategyMaker makeStrategy = [solver, heuristics] (
+            std::vector<double> const &values) {
+        std::unique_ptr<solver::StepGeneratorFactory> factory = (
+                std::make_unique<solver::UcbStepGeneratorFactory>(solver, values[0]));
+        long rolloutLength = std::lround(values[1]);
+        if (rolloutLength > 0) {
+            std::vector<std::unique_ptr<solver::StepGeneratorFactory>> factories;
+            factories.push_back(std::move(factory));
+            factories.push_back(std::make_unique<solver::DefaultRolloutFactory>(solver,
+                    rolloutLength));
+            factory = std::make_unique<solver::StagedStepGeneratorFactory>(std::move(factories));
+        }
+        std::unique_ptr<solver::SearchStrategy> strategy = (
+                std::make_unique<solver::BasicSearchStrategy>(solver, std::move(factory),
+                        heuristics[std::lround(values[2])]));
+        return strategy;
+    };
+    return std::make_unique<solver::ParameterTuningExp3>(solver, explorationCoefficient,
+            stepRatio, std::move(parameters), makeStrategy);
+}
+
 std::unique_ptr<solver::EstimationStrategy> AverageEstimateParser::parse(solver::Solver */*solver*/,
         std::vector<std::string> /*args*/) {
     return std::make_unique<solver::EstimationFunction>(
@@ -247,5 +405,18 @@ std::unique_ptr<solver::SelectRecommendedActionStrategy> GpsMaxRecommendedAction
     return std::make_unique<solver::GpsMaxRecommendedActionStrategy>(options);
 }
 
+std::unique_ptr<solver::SelectRecommendedActionStrategy> QmdpRecommendedActionStrategyParser::parse(
+        solver::Solver * /*solver*/, std::vector<std::string> args) {
+    long visitThreshold = 100;
+    double priorWeight = 10;
+    long maxParticles = 100;
+    fillOption(args, "visitThreshold", visitThreshold);
+    fillOption(args, "priorWeight", priorWeight);
+    fillOption(args, "maxParticles", maxParticles);
+
+    return std::make_unique<solver::QmdpRecommendedActionStrategy>(getAllActions(),
+            getQValueFunction(), visitThreshold, priorWeight, maxParticles);
+}
+
 
 } /* namespace shared */
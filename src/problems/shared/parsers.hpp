@@ -157,6 +157,28 @@ public:
             std::vector<std::string> args) override;
 };
 
+/** A parser for UcbStepGeneratorFactory instances that use UCB1-Tuned; the argument is the
+ * range of the Q-values.
+ */
+class UcbTunedParser: public Parser<std::unique_ptr<solver::StepGeneratorFactory>> {
+public:
+    UcbTunedParser() = default;
+    virtual ~UcbTunedParser() = default;
+    virtual std::unique_ptr<solver::StepGeneratorFactory> parse(solver::Solver *solver,
+            std::vector<std::string> args) override;
+};
+
+/** A parser for UcbStepGeneratorFactory instances that use UCB-V; the arguments are the range of
+ * the Q-values, and (optionally) the exploration rate zeta, which defaults to 1.2.
+ */
+class UcbVParser: public Parser<std::unique_ptr<solver::StepGeneratorFactory>> {
+public:
+    UcbVParser() = default;
+    virtual ~UcbVParser() = default;
+    virtual std::unique_ptr<solver::StepGeneratorFactory> parse(solver::Solver *solver,
+            std::vector<std::string> args) override;
+};
+
 /** A parser for UcbStepGeneratorFactory instances. */
 class GpsParser: public Parser<std::unique_ptr<solver::StepGeneratorFactory>> {
 public:
@@ -233,6 +255,49 @@ public:
             override;
 };
 
+/** A parser for NeighbourHeuristic instances, which estimate values from the cumulative rewards
+ * of the history entries at the nearest states, e.g. "neighbour(neighbours=10, fallback=default())"
+ *
+ * The fallback heuristic is parsed using the given set of heuristic parsers.
+ */
+class NeighbourHeuristicParser: public Parser<solver::HeuristicFunction> {
+public:
+    /** Creates a new NeighbourHeuristicParser that will use the given set of parsers to parse
+     * the fallback heuristic.
+     */
+    NeighbourHeuristicParser(ParserSet<solver::HeuristicFunction> *allParsers);
+    virtual ~NeighbourHeuristicParser() = default;
+    _NO_COPY_OR_MOVE(NeighbourHeuristicParser);
+    virtual solver::HeuristicFunction parse(solver::Solver *solver, std::vector<std::string> args)
+            override;
+
+private:
+    /** The set of parsers for parsing the fallback heuristic. */
+    ParserSet<solver::HeuristicFunction> *allParsers_;
+};
+
+/** A parser for RolloutHeuristic instances, which estimate values by following the model's
+ * rollout policy for a number of steps, e.g. "rollout(steps=20, fallback=default())"
+ *
+ * The fallback heuristic is applied at the end of the rollout, and is parsed using the given set
+ * of heuristic parsers.
+ */
+class RolloutHeuristicParser: public Parser<solver::HeuristicFunction> {
+public:
+    /** Creates a new RolloutHeuristicParser that will use the given set of parsers to parse
+     * the fallback heuristic.
+     */
+    RolloutHeuristicParser(ParserSet<solver::HeuristicFunction> *allParsers);
+    virtual ~RolloutHeuristicParser() = default;
+    _NO_COPY_OR_MOVE(RolloutHeuristicParser);
+    virtual solver::HeuristicFunction parse(solver::Solver *solver, std::vector<std::string> args)
+            override;
+
+private:
+    /** The set of parsers for parsing the fallback heuristic. */
+    ParserSet<solver::HeuristicFunction> *allParsers_;
+};
+
 /** The default parser for search strategies.
  *
  * The strategy can be expressed as "stepper", in which case the standard heuristic function will
@@ -279,6 +344,34 @@ private:
     ParserSet<std::unique_ptr<solver::SearchStrategy>> *allParsers_;
 };
 
+/** A parser for ParameterTuningExp3 meta-strategies, which tune a UCB search with a rollout
+ * phase online, e.g. "tune(exploration=0.1, ucb=10, rollout=5, heuristic=default(),
+ * heuristic=zero())".
+ *
+ * The UCB exploration coefficient starts at "ucb" and the rollout depth (0 => no rollouts) at
+ * "rollout", which can go up to "maxRollout"; each step moves them by at most a factor of
+ * "ratio". If "heuristic" is given more than once, the heuristic is chosen among those given;
+ * otherwise the standard heuristic is used.
+ */
+class TuneParser: public Parser<std::unique_ptr<solver::SearchStrategy>> {
+public:
+    /** Creates a new parser for tuned strategies, which will use the given set of heuristic
+     * parsers, and heuristicString as the default heuristic.
+     */
+    TuneParser(ParserSet<solver::HeuristicFunction> *heuristicParsers,
+            std::string heuristicString);
+    virtual ~TuneParser() = default;
+    _NO_COPY_OR_MOVE(TuneParser);
+    virtual std::unique_ptr<solver::SearchStrategy> parse(solver::Solver *solver,
+            std::vector<std::string> args) override;
+
+private:
+    /** The set of parsers for parsing HeuristicFunctions. */
+    ParserSet<solver::HeuristicFunction> *heuristicParsers_;
+    /** The default heuristic, as a string. */
+    std::string heuristicString_;
+};
+
 /** A parser for the default estimation method, using the average. */
 class AverageEstimateParser: public Parser<std::unique_ptr<solver::EstimationStrategy>> {
 public:
@@ -328,7 +421,25 @@ public:
             std::vector<std::string> args) override;
 };
 
+/** A base parser for QMDP fallback recommendation instances, e.g.
+ * "qmdp(visitThreshold=100, priorWeight=10, maxParticles=100)".
+ *
+ * Problems that can solve their fully observable MDP can subclass this in order to make the
+ * strategy available; see solver::QmdpRecommendedActionStrategy for the meaning of the settings.
+ */
+class QmdpRecommendedActionStrategyParser: public Parser<std::unique_ptr<solver::SelectRecommendedActionStrategy>> {
+public:
+	QmdpRecommendedActionStrategyParser() = default;
+    virtual ~QmdpRecommendedActionStrategyParser() = default;
+    _NO_COPY_OR_MOVE(QmdpRecommendedActionStrategyParser);
+    virtual std::unique_ptr<solver::SelectRecommendedActionStrategy> parse(solver::Solver *solver,
+            std::vector<std::string> args) override;
 
+    /** Returns all of the actions in the problem. */
+    virtual std::vector<std::unique_ptr<solver::Action>> getAllActions() = 0;
+    /** Returns a function giving the MDP Q-values, solving the MDP first if necessary. */
+    virtual solver::MdpQValueFunction getQValueFunction() = 0;
+};
 
 } /* namespace shared */
 
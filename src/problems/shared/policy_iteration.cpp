@@ -6,7 +6,12 @@
 
 #include "policy_iteration.hpp"
 
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
 
 namespace mdp {
 PolicyIterator::PolicyIterator(Policy initialPolicy, double discountFactor, int numStates,
@@ -105,6 +110,86 @@ long PolicyIterator::solve() {
     return numIterations;
 }
 
+void PolicyIterator::setValues(std::vector<double> values) {
+    values_ = std::move(values);
+    for (auto const &entry : fixedValues_) {
+        values_[entry.first] = entry.second;
+    }
+}
+
+long PolicyIterator::sweep(std::vector<State> const &changedStates, double tolerance) {
+    // Each state is backed up many times, so the transitions are looked up once in advance,
+    // along with the predecessors of each state - those whose backups depend on its value.
+    TransitionTable transitions(numStates_);
+    std::vector<std::vector<State>> predecessors(numStates_);
+    for (State state = 0; state < numStates_; state++) {
+        if (fixedValues_.count(state) > 0) {
+            continue;
+        }
+        transitions[state].resize(numActions_);
+        for (Action action = 0; action < numActions_; action++) {
+            for (State nextState : possibleNextStates_(state, action)) {
+                transitions[state][action].push_back(Transition { nextState,
+                        transitionProbability_(state, action, nextState),
+                        reward_(state, action, nextState) });
+                std::vector<State> &statePredecessors = predecessors[nextState];
+                if (statePredecessors.empty() || statePredecessors.back() != state) {
+                    statePredecessors.push_back(state);
+                }
+            }
+        }
+    }
+
+    // Queue entries may be stale; the residual is calculated again when they are taken out.
+    std::priority_queue<std::pair<double, State>> queue;
+    for (State state : changedStates) {
+        if (fixedValues_.count(state) == 0) {
+            queue.emplace(std::abs(getBestAction(state, transitions).second - values_[state]),
+                    state);
+        }
+    }
+
+    long numBackups = 0;
+    while (!queue.empty()) {
+        State state = queue.top().second;
+        queue.pop();
+        std::pair<Action, double> best = getBestAction(state, transitions);
+        if (std::abs(best.second - values_[state]) <= tolerance) {
+            continue;
+        }
+        policy_[state] = best.first;
+        values_[state] = best.second;
+        numBackups++;
+
+        for (State previousState : predecessors[state]) {
+            double residual = std::abs(getBestAction(previousState, transitions).second
+                    - values_[previousState]);
+            if (residual > tolerance) {
+                queue.emplace(residual, previousState);
+            }
+        }
+    }
+    return numBackups;
+}
+
+std::pair<Action, double> PolicyIterator::getBestAction(State state,
+        TransitionTable const &transitions) const {
+    Action bestAction = policy_[state];
+    double bestQ = -std::numeric_limits<double>::infinity();
+    for (Action action = 0; action < numActions_; action++) {
+        double actionQ = 0;
+        for (Transition const &transition : transitions[state][action]) {
+            actionQ += transition.probability * (transition.reward
+                    + discountFactor_ * values_[transition.nextState]);
+        }
+        if (actionQ > bestQ) {
+            bestAction = action;
+            bestQ = actionQ;
+        }
+    }
+    return std::make_pair(bestAction, bestQ);
+}
+
 Policy PolicyIterator::getBestPolicy() {
     return policy_;
 }
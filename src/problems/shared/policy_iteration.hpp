@@ -12,6 +12,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <eigen3/Eigen/Sparse>
@@ -60,6 +61,21 @@ public:
      */
     long solve();
 
+    /** Sets the current value function, e.g. to the solution of an earlier version of this MDP,
+     * so that it can then be improved by sweep().
+     */
+    void setValues(std::vector<double> values);
+
+    /** Improves the current values and policy via prioritized sweeping; this is much faster than
+     * solve() when the current values are already close to the solution, e.g. if only a few
+     * states' transitions have changed since the values were calculated.
+     *
+     * The given states are backed up first, and then any states whose Bellman residual exceeds
+     * the given tolerance as a result are backed up in turn, the largest residual first, until
+     * none are left. Returns the number of backups made.
+     */
+    long sweep(std::vector<State> const &changedStates, double tolerance);
+
     /** Returns the best policy calculated so far. */
     Policy getBestPolicy();
 
@@ -70,6 +86,23 @@ private:
     /** Updates the calculated value function for the current policy. */
     void updateValues();
 
+    /** A possible outcome of taking an action from a state. */
+    struct Transition {
+        /** The next state. */
+        State nextState;
+        /** The probability of reaching that state. */
+        double probability;
+        /** The reward for the transition. */
+        double reward;
+    };
+    /** A table of the possible transitions for each state and action, as [state][action]. */
+    typedef std::vector<std::vector<std::vector<Transition>>> TransitionTable;
+
+    /** Returns the action with the highest Q-value from the given state under the current
+     * value function, along with that Q-value.
+     */
+    std::pair<Action, double> getBestAction(State state, TransitionTable const &transitions) const;
+
     /** The best policy calculated so far. */
     Policy policy_;
     /** The current calculated value function. */
@@ -6,10 +6,17 @@
 #ifndef SIMULATE_HPP_
 #define SIMULATE_HPP_
 
+#include <signal.h>                     // for sigaction, SIGINT
+#include <sys/wait.h>                   // for waitpid
+#include <unistd.h>                     // for fork, pipe, read, write, close, _exit
+
 #include <fstream>                      // for operator<<, basic_ostream, basic_ostream<>::__ostream_type, ofstream, endl, ostream, ifstream
+#include <iomanip>                      // for setprecision
 #include <iostream>                     // for cout
+#include <limits>                       // for numeric_limits
 #include <map>
 #include <memory>                       // for unique_ptr
+#include <sstream>                      // for ostringstream, istringstream
 #include <string>                       // for string, char_traits, operator<<
 #include <utility>                      // for move                // IWYU pragma: keep
 #include <vector>                       // for vector, vector<>::iterator
@@ -23,6 +30,7 @@
 
 #include "solver/serialization/Serializer.hpp"        // for Serializer
 
+#include "solver/CancellationToken.hpp"
 #include "solver/HistoryEntry.hpp"
 #include "solver/HistorySequence.hpp"
 #include "solver/Simulator.hpp"            // for Simulator
@@ -35,6 +43,201 @@
 using std::cout;
 using std::endl;
 
+/** The summary statistics for a single simulation run. */
+struct SimulationRunStats {
+    /** The total discounted reward. */
+    double reward = 0;
+    /** The number of steps that were simulated. */
+    long nSteps = 0;
+    /** The time taken by the run, in milliseconds. */
+    double time = 0;
+};
+
+/** Cancelled by the first SIGINT (Ctrl-C) during a simulation. This interrupts the search in
+ * progress; the run then stops after its current step, and no further runs are started.
+ */
+static solver::CancellationToken interruptToken;
+
+/** Handles SIGINT by cancelling the interrupt token. */
+inline void handleInterrupt(int /*signalNumber*/) {
+    interruptToken.cancel();
+}
+
+/** Runs a single simulation using the given solver, with the given PRNG driving the simulator;
+ * the run is logged to the given stream.
+ */
+template<typename ModelType, typename OptionsType>
+SimulationRunStats runSimulation(solver::Solver &solver, RandomGenerator &randGen,
+        OptionsType const &options, std::string const &workingDir, long runNumber,
+        std::ostream &os) {
+    if (!options.baseConfigPath.empty()) {
+        tapir::change_directory(options.baseConfigPath);
+    }
+    std::unique_ptr<ModelType> simulatorModel = std::make_unique<ModelType>(&randGen,
+            std::make_unique<OptionsType>(options));
+    solver::Simulator simulator(std::move(simulatorModel), &solver, options.areDynamic);
+    if (options.hasChanges) {
+        simulator.loadChangeSequence(options.changesPath);
+    }
+    if (!options.baseConfigPath.empty()) {
+        tapir::change_directory(workingDir);
+    }
+
+    simulator.setMaxStepCount(options.nSimulationSteps);
+    simulator.setCancellationToken(&interruptToken);
+    cout << "Running..." << endl;
+
+    double tStart = tapir::clock_ms();
+    double reward = simulator.runSimulation();
+    double totT = tapir::clock_ms() - tStart;
+    long actualNSteps = simulator.getStepCount();
+
+    os << "Run #" << runNumber+1 << endl;
+    os << "Reward: " << reward << endl;
+
+    solver::HistorySequence *sequence = simulator.getHistory();
+
+    for (solver::HistoryEntry::IdType entryNo = 0;
+            entryNo < sequence->getLength() - 1; entryNo++) {
+        solver::HistoryEntry *entry = sequence->getEntry(entryNo);
+        os << "t = " << entryNo << endl;
+        os << "S: " << *entry->getState() << endl;
+        os << "A: " << *entry->getAction() << endl;
+        os << "O: " << *entry->getObservation() << endl;
+        os << "R: " << entry->getImmediateReward() << endl;
+        if (!simulator.getSearchParameters()[entryNo].empty()) {
+            os << "P: " << simulator.getSearchParameters()[entryNo] << endl;
+        }
+    }
+    os << "Final State: " << *sequence->getLastEntry()->getState();
+    os << endl;
+
+    if (simulator.isCancelled()) {
+        cout << "Interrupted after " << actualNSteps << " steps." << endl;
+    }
+    cout << "Total discounted reward: " << reward << endl;
+    cout << "# of steps: " << actualNSteps << endl;
+    cout << "Time spent on changes: ";
+    cout << simulator.getTotalChangingTime() << "ms" << endl;
+    cout << "Time spent preparing for changes: ";
+    cout << simulator.getTotalPreparingTime() << "ms" << endl;
+    cout << "Time spent on policy updates: ";
+    cout << simulator.getTotalImprovementTime() << "ms" << endl;
+    cout << "Time spent replenishing particles: ";
+    cout << simulator.getTotalReplenishingTime() << "ms" << endl;
+    cout << "Particle deprivations: " << simulator.getNumberOfDeprivations() << endl;
+    cout << "Time spent pruning: ";
+    cout << simulator.getTotalPruningTime() << "ms" << endl;
+    cout << "Total time taken: " << totT << "ms" << endl;
+    if (options.savePolicy) {
+        // Write the final policy to a file.
+        cout << "Saving final policy..." << endl;
+        std::ofstream outFile;
+        std::ostringstream sstr;
+        sstr << "final-" << runNumber << ".pol";
+        outFile.open(sstr.str());
+        solver.getSerializer()->save(outFile);
+        outFile.close();
+        cout << "Finished saving." << endl;
+    }
+    cout << "Run complete!" << endl << endl;
+
+    SimulationRunStats stats;
+    stats.reward = reward;
+    stats.nSteps = actualNSteps;
+    stats.time = totT;
+    return stats;
+}
+
+/** Runs a single simulation in a forked child process, using the given solver, which should
+ * already have its policy loaded.
+ *
+ * The child works on a copy-on-write view of the parent's memory, so the loaded tree, state pool
+ * and histories are shared between runs, and only the pages a run actually modifies are copied.
+ * Once the run is done the child sends its statistics and the final state of the simulator's
+ * PRNG back through a pipe, so the parent can carry on exactly as if the run had been done
+ * in-process.
+ *
+ * Returns false if the run could not be completed.
+ */
+template<typename ModelType, typename OptionsType>
+bool runForkedSimulation(solver::Solver &solver, RandomGenerator &randGen,
+        OptionsType const &options, std::string const &workingDir, long runNumber,
+        std::ostream &os, SimulationRunStats &stats) {
+    // Anything still buffered would otherwise be written out by both processes.
+    cout.flush();
+    os.flush();
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        debug::show_message("ERROR: Failed to create a pipe for the simulation run.");
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        debug::show_message("ERROR: Failed to fork the simulation run.");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        SimulationRunStats childStats = runSimulation<ModelType, OptionsType>(solver, randGen,
+                options, workingDir, runNumber, os);
+        std::ostringstream sstr;
+        sstr << std::setprecision(std::numeric_limits<double>::max_digits10);
+        sstr << childStats.reward << " " << childStats.nSteps << " " << childStats.time << " ";
+        sstr << randGen;
+        std::string message = sstr.str();
+
+        int exitCode = 0;
+        char const *data = message.data();
+        std::size_t remaining = message.size();
+        while (remaining > 0) {
+            ssize_t written = write(fds[1], data, remaining);
+            if (written <= 0) {
+                exitCode = 1;
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+        close(fds[1]);
+        cout.flush();
+        os.flush();
+        // Exit straight away; tearing down the child's copy of the tree would only waste time.
+        _exit(exitCode);
+    }
+
+    close(fds[1]);
+    std::string message;
+    char buffer[256];
+    ssize_t numberRead;
+    while ((numberRead = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        message.append(buffer, numberRead);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        debug::show_message("ERROR: The forked simulation run failed.");
+        return false;
+    }
+    std::istringstream sstr(message);
+    std::string rngState;
+    sstr >> stats.reward >> stats.nSteps >> stats.time >> rngState;
+    // The PRNG state is read from its own stream, since reading an engine can fail partway
+    // through a stream.
+    std::istringstream rngStream(rngState);
+    rngStream >> randGen;
+    if (sstr.fail() || rngStream.fail()) {
+        debug::show_message("ERROR: Could not read the results of the forked simulation run.");
+        return false;
+    }
+    return true;
+}
+
 /** A template method to run a simulation for the given model and options classes. */
 template<typename ModelType, typename OptionsType>
 int simulate(int argc, char const *argv[]) {
@@ -70,6 +273,14 @@ int simulate(int argc, char const *argv[]) {
 
     std::ofstream os(options.logPath);
 
+    // The first Ctrl-C interrupts the simulation cleanly; the default action is then restored,
+    // so a second one still terminates the program. Forked runs inherit the handler.
+    struct sigaction interruptAction;
+    interruptAction.sa_handler = handleInterrupt;
+    sigemptyset(&interruptAction.sa_mask);
+    interruptAction.sa_flags = SA_RESETHAND | SA_RESTART;
+    sigaction(SIGINT, &interruptAction, nullptr);
+
     if (options.rngState > 0) {
         std::stringstream sstr;
         sstr << options.rngState;
@@ -77,6 +288,7 @@ int simulate(int argc, char const *argv[]) {
         cout << "Loaded PRNG state " << options.rngState << endl;
     }
 
+    long nRunsCompleted = 0;
     double totalReward = 0;
     double totalTime = 0;
     double totalNSteps = 0;
@@ -85,108 +297,76 @@ int simulate(int argc, char const *argv[]) {
     ProfilerStart("simulate.prof");
 #endif
 
-    for (long runNumber = 0; runNumber < options.nRuns; runNumber++) {
-        cout << "Run #" << runNumber+1 << endl;
-        cout << "PRNG engine state: " << randGen << endl;
-
-        // We want the simulated history to be independent of the solver's searching,
-        // so we create a different random generator here.
-        RandomGenerator solverGen(randGen);
-        // Advance it forward a long way to avoid correlation between the solver and simulator.
-        solverGen.discard(10000);
+    // We want the simulated history to be independent of the solver's searching,
+    // so the solver uses a different random generator, which is re-seeded for each run.
+    RandomGenerator solverGen;
 
+    // A policy is loaded only once; each run is then done in a forked process, which gets its
+    // own copy-on-write view of the loaded policy instead of having to parse it again.
+    std::unique_ptr<solver::Solver> loadedSolver = nullptr;
+    if (options.loadInitialPolicy) {
         if (!options.baseConfigPath.empty()) {
             tapir::change_directory(options.baseConfigPath);
         }
         std::unique_ptr<ModelType> solverModel = std::make_unique<ModelType>(&solverGen,
-                std::make_unique<OptionsType>(options));;
-        solver::Solver solver(std::move(solverModel));
-
-        if (!options.baseConfigPath.empty()) {
-            tapir::change_directory(workingDir);
-        }
-        if (options.loadInitialPolicy) {
-            cout << "Loading policy... " << endl;
-            std::ifstream inFile;
-            inFile.open(options.policyPath);
-            if (!inFile.is_open()) {
-                std::ostringstream message;
-                message << "Failed to open " << options.policyPath;
-                debug::show_message(message.str());
-                return 1;
-            }
-            solver.getSerializer()->load(inFile);
-            inFile.close();
-        } else {
-            cout << "Starting from empty policy. " << endl;
-            solver.initializeEmpty();
-        }
-        if (!options.baseConfigPath.empty()) {
-            tapir::change_directory(options.baseConfigPath);
-        }
-
-        std::unique_ptr<ModelType> simulatorModel = std::make_unique<ModelType>(&randGen,
                 std::make_unique<OptionsType>(options));
-        solver::Simulator simulator(std::move(simulatorModel), &solver, options.areDynamic);
-        if (options.hasChanges) {
-            simulator.loadChangeSequence(options.changesPath);
-        }
+        loadedSolver = std::make_unique<solver::Solver>(std::move(solverModel));
         if (!options.baseConfigPath.empty()) {
             tapir::change_directory(workingDir);
         }
 
-        simulator.setMaxStepCount(options.nSimulationSteps);
-        cout << "Running..." << endl;
-
-        double tStart = tapir::clock_ms();
-        double reward = simulator.runSimulation();
-        double totT = tapir::clock_ms() - tStart;
-        long actualNSteps = simulator.getStepCount();
+        cout << "Loading policy... " << endl;
+        std::ifstream inFile;
+        inFile.open(options.policyPath);
+        if (!inFile.is_open()) {
+            std::ostringstream message;
+            message << "Failed to open " << options.policyPath;
+            debug::show_message(message.str());
+            return 1;
+        }
+        loadedSolver->getSerializer()->load(inFile);
+        inFile.close();
+    }
 
-        totalReward += reward;
-        totalTime += totT;
-        totalNSteps += actualNSteps;
+    for (long runNumber = 0; runNumber < options.nRuns; runNumber++) {
+        cout << "Run #" << runNumber+1 << endl;
+        cout << "PRNG engine state: " << randGen << endl;
 
-        os << "Run #" << runNumber+1 << endl;
-        os << "Reward: " << reward << endl;
+        solverGen = randGen;
+        // Advance it forward a long way to avoid correlation between the solver and simulator.
+        solverGen.discard(10000);
 
-        solver::HistorySequence *sequence = simulator.getHistory();
+        SimulationRunStats stats;
+        if (loadedSolver != nullptr) {
+            if (!runForkedSimulation<ModelType, OptionsType>(*loadedSolver, randGen, options,
+                    workingDir, runNumber, os, stats)) {
+                return 1;
+            }
+        } else {
+            if (!options.baseConfigPath.empty()) {
+                tapir::change_directory(options.baseConfigPath);
+            }
+            std::unique_ptr<ModelType> solverModel = std::make_unique<ModelType>(&solverGen,
+                    std::make_unique<OptionsType>(options));
+            solver::Solver solver(std::move(solverModel));
+            if (!options.baseConfigPath.empty()) {
+                tapir::change_directory(workingDir);
+            }
 
-        for (solver::HistoryEntry::IdType entryNo = 0;
-                entryNo < sequence->getLength() - 1; entryNo++) {
-            solver::HistoryEntry *entry = sequence->getEntry(entryNo);
-            os << "t = " << entryNo << endl;
-            os << "S: " << *entry->getState() << endl;
-            os << "A: " << *entry->getAction() << endl;
-            os << "O: " << *entry->getObservation() << endl;
-            os << "R: " << entry->getImmediateReward() << endl;
+            cout << "Starting from empty policy. " << endl;
+            solver.initializeEmpty();
+            stats = runSimulation<ModelType, OptionsType>(solver, randGen, options, workingDir,
+                    runNumber, os);
         }
-        os << "Final State: " << *sequence->getLastEntry()->getState();
-        os << endl;
-
-        cout << "Total discounted reward: " << reward << endl;
-        cout << "# of steps: " << actualNSteps << endl;
-        cout << "Time spent on changes: ";
-        cout << simulator.getTotalChangingTime() << "ms" << endl;
-        cout << "Time spent on policy updates: ";
-        cout << simulator.getTotalImprovementTime() << "ms" << endl;
-        cout << "Time spent replenishing particles: ";
-        cout << simulator.getTotalReplenishingTime() << "ms" << endl;
-        cout << "Time spent pruning: ";
-        cout << simulator.getTotalPruningTime() << "ms" << endl;
-        cout << "Total time taken: " << totT << "ms" << endl;
-        if (options.savePolicy) {
-            // Write the final policy to a file.
-            cout << "Saving final policy..." << endl;
-            std::ofstream outFile;
-            std::ostringstream sstr;
-            sstr << "final-" << runNumber << ".pol";
-            outFile.open(sstr.str());
-            solver.getSerializer()->save(outFile);
-            outFile.close();
-            cout << "Finished saving." << endl;
+
+        nRunsCompleted++;
+        totalReward += stats.reward;
+        totalTime += stats.time;
+        totalNSteps += stats.nSteps;
+        if (interruptToken.isCancelled()) {
+            cout << "Interrupted; no further runs will be started." << endl;
+            break;
         }
-        cout << "Run complete!" << endl << endl;
     }
 
 #ifdef GOOGLE_PROFILER
@@ -195,10 +375,10 @@ int simulate(int argc, char const *argv[]) {
 
     os.close();
 
-    cout << options.nRuns << " runs completed." << endl;
-    cout << "Mean reward: " << totalReward / options.nRuns << endl;
-    cout << "Mean number of steps: " << totalNSteps / options.nRuns << endl;
-    cout << "Mean time taken: " << totalTime / options.nRuns << "ms" << endl;
+    cout << nRunsCompleted << " runs completed." << endl;
+    cout << "Mean reward: " << totalReward / nRunsCompleted << endl;
+    cout << "Mean number of steps: " << totalNSteps / nRunsCompleted << endl;
+    cout << "Mean time taken: " << totalTime / nRunsCompleted << "ms" << endl;
     cout << "Mean time per step: " << totalTime / totalNSteps << "ms" << endl;
     return 0;
 }
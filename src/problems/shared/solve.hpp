@@ -13,7 +13,9 @@
 #include <utility>                      // for move                // IWYU pragma: keep
 
 #include "global.hpp"                     // for RandomGenerator, make_unique
+#include "solver/serialization/DecisionTableExporter.hpp"
 #include "solver/serialization/Serializer.hpp"        // for Serializer
+#include "solver/BeliefTree.hpp"
 #include "solver/Solver.hpp"            // for Solver
 
 #include "options/option_parser.hpp"
@@ -65,6 +67,11 @@ int solve(int argc, char const *argv[]) {
 
     solver::Solver solver(std::move(newModel));
     solver.initializeEmpty();
+    if (!options.decisionTablePath.empty()
+            && !solver::DecisionTableExporter(&solver, options.decisionTableDepth).canExport()) {
+        std::cerr << "Decision tables are not supported for this problem." << std::endl;
+        return 2;
+    }
 
     double totT;
     double tStart;
@@ -90,6 +97,17 @@ int solve(int argc, char const *argv[]) {
     solver.getSerializer()->save(outFile);
     outFile.close();
     cout << "    Done." << endl;
+
+    if (!options.decisionTablePath.empty()) {
+        cout << "Saving decision table...";
+        cout.flush();
+        std::ofstream tableFile(options.decisionTablePath);
+        tableFile << std::setprecision(std::numeric_limits<double>::max_digits10);
+        solver::DecisionTableExporter exporter(&solver, options.decisionTableDepth);
+        long numberOfNodes = exporter.save(solver.getPolicy()->getRoot(), tableFile);
+        tableFile.close();
+        cout << "    Done; " << numberOfNodes << " nodes." << endl;
+    }
     return 0;
 }
 
@@ -50,6 +50,18 @@ void TagAction::print(std::ostream &os) const {
     case ActionType::TAG:
         os << "TAG";
         break;
+    case ActionType::MACRO_NORTH:
+        os << "NORTH*";
+        break;
+    case ActionType::MACRO_EAST:
+        os << "EAST*";
+        break;
+    case ActionType::MACRO_SOUTH:
+        os << "SOUTH*";
+        break;
+    case ActionType::MACRO_WEST:
+        os << "WEST*";
+        break;
     default:
         os << "ERROR-" << static_cast<long>(actionType_);
         break;
@@ -62,4 +74,16 @@ long TagAction::getBinNumber() const {
 ActionType TagAction::getActionType() const {
     return actionType_;
 }
+
+bool TagAction::isMacro() const {
+    return actionType_ >= ActionType::MACRO_NORTH;
+}
+
+ActionType TagAction::getPrimitiveType() const {
+    if (isMacro()) {
+        return static_cast<ActionType>(static_cast<long>(actionType_)
+                - static_cast<long>(ActionType::MACRO_NORTH));
+    }
+    return actionType_;
+}
 } /* namespace tag */
@@ -28,6 +28,14 @@ enum class ActionType : long {
     WEST = 3,
     /** The action to attempt to tag the opponent. */
     TAG = 4,
+    /** A macro-action that moves north several times (see TagOptions::macroActionLength). */
+    MACRO_NORTH = 5,
+    /** A macro-action that moves east several times. */
+    MACRO_EAST = 6,
+    /** A macro-action that moves south several times. */
+    MACRO_SOUTH = 7,
+    /** A macro-action that moves west several times. */
+    MACRO_WEST = 8,
 };
 
 /** A class representing an action in the Tag POMDP.
@@ -54,6 +62,12 @@ class TagAction : public solver::DiscretizedPoint {
     long getBinNumber() const override;
     /** Returns the ActionType of this action. */
     ActionType getActionType() const;
+    /** Returns true iff this action is a macro-action, i.e. a repeated move. */
+    bool isMacro() const;
+    /** Returns the type of the primitive action this action is made of; for primitive actions
+     * this is just the ActionType.
+     */
+    ActionType getPrimitiveType() const;
 
   private:
     /** The ActionType for this action in the Tag POMDP. */
@@ -0,0 +1,31 @@
+/** @file TagMacroTransition.cpp
+ *
+ * Contains the implementations for the methods of TagMacroTransition.
+ */
+#include "TagMacroTransition.hpp"
+
+#include <ostream>                      // for operator<<, ostream
+
+#include "TagState.hpp"
+
+namespace tag {
+TagMacroTransition::TagMacroTransition(TagState const &finalState, bool sawOpponent) :
+        finalState_(finalState),
+        sawOpponent_(sawOpponent) {
+}
+
+void TagMacroTransition::print(std::ostream &os) const {
+    os << "Ends at " << finalState_;
+    if (sawOpponent_) {
+        os << "; saw opponent";
+    }
+}
+
+TagState const &TagMacroTransition::getFinalState() const {
+    return finalState_;
+}
+
+bool TagMacroTransition::sawOpponent() const {
+    return sawOpponent_;
+}
+} /* namespace tag */
@@ -0,0 +1,50 @@
+/** @file TagMacroTransition.hpp
+ *
+ * Defines the TagMacroTransition class, which stores the outcome of a macro-action in the Tag
+ * POMDP as transition parameters.
+ */
+#ifndef TAG_MACROTRANSITION_HPP_
+#define TAG_MACROTRANSITION_HPP_
+
+#include <ostream>                      // for ostream
+
+#include "global.hpp"
+
+#include "solver/abstract-problem/TransitionParameters.hpp"
+
+#include "TagState.hpp"
+
+namespace tag {
+/** The transition parameters for a Tag macro-action.
+ *
+ * These record the state the macro-action finished in, and whether the robot saw the opponent
+ * after any of its moves; the observation for the macro-action depends on both, so they are
+ * kept together in order for the next state, reward and observation to agree.
+ */
+class TagMacroTransition : public solver::TransitionParameters {
+    friend class TagTextSerializer;
+  public:
+    /** Constructs a new TagMacroTransition that finishes in the given state; sawOpponent should
+     * be true iff the robot and the opponent were in the same square after any move.
+     */
+    TagMacroTransition(TagState const &finalState, bool sawOpponent);
+
+    virtual ~TagMacroTransition() = default;
+    _NO_COPY_OR_MOVE(TagMacroTransition);
+
+    void print(std::ostream &os) const override;
+
+    /** Returns the state after the final move of the macro-action. */
+    TagState const &getFinalState() const;
+    /** Returns true iff the robot saw the opponent after any of the moves. */
+    bool sawOpponent() const;
+
+  private:
+    /** The state after the final move. */
+    TagState finalState_;
+    /** True iff the robot saw the opponent after any of the moves. */
+    bool sawOpponent_;
+};
+} /* namespace tag */
+
+#endif /* TAG_MACROTRANSITION_HPP_ */
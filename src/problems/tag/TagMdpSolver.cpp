@@ -4,9 +4,11 @@
  */
 #include "TagMdpSolver.hpp"
 
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "global.hpp"
@@ -18,6 +20,7 @@
 #include "problems/shared/parsers.hpp"
 #include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
 
+#include "TagAction.hpp"
 #include "TagModel.hpp"
 #include "TagState.hpp"
 
@@ -25,32 +28,86 @@ namespace tag {
 /* ---------------------- TagMdpSolver --------------------- */
 TagMdpSolver::TagMdpSolver(TagModel *model) :
             model_(model),
+            symmetries_(),
+            solvedEmptyCells_(),
             valueMap_() {
 }
 
 void TagMdpSolver::solve() {
+    solveMdp(model_->getEmptyCells(model_->envMap_), nullptr);
+}
+
+void TagMdpSolver::update() {
+    update(model_->getEmptyCells(model_->envMap_));
+}
+
+std::unique_ptr<TagMdpSolver> TagMdpSolver::prepareUpdate(
+        std::vector<std::vector<bool>> const &emptyCells) const {
+    std::unique_ptr<TagMdpSolver> updatedSolver = std::make_unique<TagMdpSolver>(model_);
+    updatedSolver->symmetries_ = symmetries_;
+    updatedSolver->solvedEmptyCells_ = solvedEmptyCells_;
+    updatedSolver->valueMap_ = valueMap_;
+    updatedSolver->update(emptyCells);
+    return updatedSolver;
+}
+
+void TagMdpSolver::update(std::vector<std::vector<bool>> const &emptyCells) {
+    GridSymmetries symmetries;
+    if (model_->options_->useMapSymmetries) {
+        symmetries = GridSymmetries(emptyCells);
+    }
+    // The old values are stored by canonical state, so they need the same symmetries.
+    if (valueMap_.empty() || emptyCells.size() != solvedEmptyCells_.size()
+            || !(symmetries == symmetries_)) {
+        solveMdp(emptyCells, nullptr);
+        return;
+    }
+
+    std::vector<GridPosition> changedCells;
+    for (unsigned long row = 0; row < emptyCells.size(); row++) {
+        for (unsigned long col = 0; col < emptyCells[row].size(); col++) {
+            if (emptyCells[row][col] != solvedEmptyCells_[row][col]) {
+                changedCells.emplace_back(row, col);
+            }
+        }
+    }
+    if (changedCells.empty()) {
+        return;
+    }
+    solveMdp(emptyCells, &changedCells);
+}
+
+void TagMdpSolver::solveMdp(std::vector<std::vector<bool>> const &emptyCells,
+        std::vector<GridPosition> const *changedCells) {
 #ifndef HAS_EIGEN
+    // Only used for the Eigen-based solver.
+    static_cast<void>(emptyCells);
+    static_cast<void>(changedCells);
     debug::show_message("ERROR: Can't use MDP Policy Iteration without Eigen!");
     std::exit(15);
 #else
     if (model_->options_->hasVerboseOutput) {
-        std::cout << "Solving MDP...";
+        std::cout << (changedCells == nullptr ? "Solving MDP..." : "Updating MDP...");
         std::cout.flush();
     }
 
-    valueMap_.clear();
+    symmetries_ = GridSymmetries();
+    if (model_->options_->useMapSymmetries) {
+        symmetries_ = GridSymmetries(emptyCells);
+    }
+    solvedEmptyCells_ = emptyCells;
 
     // Enumerated vector of actions.
     std::vector<std::unique_ptr<solver::DiscretizedPoint>> allActions = (
-            model_->getAllActionsInOrder());
+            model_->getPrimitiveActionsInOrder());
 
     // Vector of valid grid positions.
-    std::vector<GridPosition> emptyCells;
+    std::vector<GridPosition> emptyPositions;
     for (long row = 0; row < model_->getNRows(); row++) {
         for (long col = 0; col < model_->getNCols(); col++) {
             // Ignore impossible states.
-            if (model_->envMap_[row][col] == TagModel::TagCellType::EMPTY) {
-                emptyCells.emplace_back(row, col);
+            if (emptyCells[row][col]) {
+                emptyPositions.emplace_back(row, col);
             }
         }
     }
@@ -63,8 +120,12 @@ void TagMdpSolver::solve() {
     std::unordered_map<TagState, int> stateIndex;
 
     int index = 0;
-    for (GridPosition const &robotPos : emptyCells) {
-        for (GridPosition const &opponentPos : emptyCells) {
+    for (GridPosition const &robotPos : emptyPositions) {
+        for (GridPosition const &opponentPos : emptyPositions) {
+            // Symmetric states have the same values, so only canonical states are needed.
+            if (!symmetries_.isCanonical( { robotPos, opponentPos })) {
+                continue;
+            }
             TagState state(robotPos, opponentPos, false);
 
             ActionType initialAction;
@@ -114,7 +175,7 @@ void TagMdpSolver::solve() {
 
         // Generate a distribution of possible opponent positions.
         std::unordered_map<GridPosition, double> nextOpponentPosDistribution = (
-                model_->getNextOpponentPositionDistribution(robotPos, opponentPos));;
+                getNextOpponentPositionDistribution(robotPos, opponentPos));
 
         transitions[stateNo].resize(allActions.size());
         for (unsigned int actionNo = 0; actionNo < allActions.size(); actionNo++) {
@@ -133,11 +194,15 @@ void TagMdpSolver::solve() {
                     reward = -10;
                 }
             }
-            GridPosition nextRobotPos = model_->getMovedPos(robotPos, actionType).first;
+            GridPosition nextRobotPos = getMovedPos(robotPos, actionType);
             for (auto &entry : nextOpponentPosDistribution) {
-                TagState nextState(nextRobotPos, entry.first, false);
+                std::pair<GridPosition, GridPosition> positions = getCanonicalPositions(
+                        TagState(nextRobotPos, entry.first, false));
+                TagState nextState(positions.first, positions.second, false);
                 int nextStateIndex = stateIndex[nextState];
-                nextStateTransitions[nextStateIndex] = std::make_pair(entry.second, reward);
+                // Different next states can have the same canonical state.
+                nextStateTransitions[nextStateIndex].first += entry.second;
+                nextStateTransitions[nextStateIndex].second = reward;
             }
         }
     }
@@ -165,27 +230,106 @@ void TagMdpSolver::solve() {
 
     iterator.fixValue(allStates.size(), 0.0);
 
-    long numSteps = iterator.solve();
+    long numSteps;
+    if (changedCells == nullptr) {
+        numSteps = iterator.solve();
+    } else {
+        // Only the transitions of states within one step of a changed cell can have changed.
+        std::vector<std::vector<bool>> isNearChange(model_->getNRows(),
+                std::vector<bool>(model_->getNCols(), false));
+        for (GridPosition const &cell : *changedCells) {
+            for (long row = cell.i - 1; row <= cell.i + 1; row++) {
+                for (long col = cell.j - 1; col <= cell.j + 1; col++) {
+                    if (std::abs(row - cell.i) + std::abs(col - cell.j) <= 1 && row >= 0
+                            && row < model_->getNRows() && col >= 0 && col < model_->getNCols()) {
+                        isNearChange[row][col] = true;
+                    }
+                }
+            }
+        }
+
+        std::vector<double> initialValues(allStates.size() + 1, 0.0);
+        std::vector<int> changedStates;
+        for (unsigned int stateNo = 0; stateNo < allStates.size(); stateNo++) {
+            TagState const &state = allStates[stateNo];
+            GridPosition robotPos = state.getRobotPosition();
+            GridPosition opponentPos = state.getOpponentPosition();
+            std::unordered_map<TagState, double>::iterator it = valueMap_.find(state);
+            if (it != valueMap_.end()) {
+                initialValues[stateNo] = it->second;
+            }
+            if (it == valueMap_.end() || isNearChange[robotPos.i][robotPos.j]
+                    || isNearChange[opponentPos.i][opponentPos.j]) {
+                changedStates.push_back(stateNo);
+            }
+        }
+        iterator.setValues(initialValues);
+        // The sweep stops when no residual exceeds this, so the values are within
+        // tolerance / (1 - discount) of the exact solution.
+        double tolerance = 1e-6;
+        numSteps = iterator.sweep(changedStates, tolerance);
+    }
     std::vector<double> stateValues = iterator.getCurrentValues();
 
     // Now put all of the state values into our map.
+    valueMap_.clear();
     for (unsigned int stateNo = 0; stateNo < allStates.size(); stateNo++) {
         valueMap_[allStates[stateNo]] = stateValues[stateNo];
     }
 
     if (model_->options_->hasVerboseOutput) {
-        std::cout << "        Done; took " << numSteps << " steps." << std::endl << std::endl;
+        std::cout << "        Done; took " << numSteps;
+        std::cout << (changedCells == nullptr ? " steps" : " backups");
+        std::cout << ", for " << allStates.size() << " states." << std::endl << std::endl;
     }
 #endif
 }
 
+GridPosition TagMdpSolver::getMovedPos(GridPosition const &position, ActionType action) const {
+    GridPosition movedPos = position;
+    switch (action) {
+    case ActionType::NORTH:
+        movedPos.i -= 1;
+        break;
+    case ActionType::EAST:
+        movedPos.j += 1;
+        break;
+    case ActionType::SOUTH:
+        movedPos.i += 1;
+        break;
+    case ActionType::WEST:
+        movedPos.j -= 1;
+        break;
+    default:
+        break;
+    }
+    if (movedPos.i < 0 || movedPos.i >= model_->getNRows() || movedPos.j < 0
+            || movedPos.j >= model_->getNCols() || !solvedEmptyCells_[movedPos.i][movedPos.j]) {
+        return position;
+    }
+    return movedPos;
+}
+
+std::unordered_map<GridPosition, double> TagMdpSolver::getNextOpponentPositionDistribution(
+        GridPosition const &robotPos, GridPosition const &opponentPos) const {
+    std::vector<ActionType> actions = model_->makeOpponentActions(robotPos, opponentPos);
+    std::unordered_map<GridPosition, double> distribution;
+    double actionProb = (1 - model_->opponentStayProbability_) / actions.size();
+    for (ActionType action : actions) {
+        distribution[getMovedPos(opponentPos, action)] += actionProb;
+    }
+    distribution[opponentPos] += model_->opponentStayProbability_;
+    return distribution;
+}
+
 double TagMdpSolver::getValue(TagState const &state) const {
     if (state.isTagged()) {
         return 0; // Terminal; the reward is applied on the previous timestep.
     }
 
     try {
-        return valueMap_.at(state);
+        std::pair<GridPosition, GridPosition> positions = getCanonicalPositions(state);
+        return valueMap_.at(TagState(positions.first, positions.second, false));
     } catch (std::out_of_range const &oor) {
         // INVALID STATE => return 0
 
@@ -194,6 +338,37 @@ double TagMdpSolver::getValue(TagState const &state) const {
     }
 }
 
+double TagMdpSolver::getQValue(TagState const &state, ActionType action) const {
+    if (state.isTagged()) {
+        return 0; // Terminal => no more rewards.
+    }
+
+    GridPosition robotPos = state.getRobotPosition();
+    GridPosition opponentPos = state.getOpponentPosition();
+    double reward = -model_->moveCost_;
+    if (action == ActionType::TAG) {
+        if (robotPos == opponentPos) {
+            return model_->tagReward_; // The next state is terminal.
+        }
+        reward = -model_->failedTagPenalty_;
+    }
+
+    GridPosition nextRobotPos = getMovedPos(robotPos, action);
+    double expectedNextValue = 0;
+    for (auto const &entry : getNextOpponentPositionDistribution(robotPos, opponentPos)) {
+        expectedNextValue += entry.second * getValue(TagState(nextRobotPos, entry.first, false));
+    }
+    return reward + model_->options_->discountFactor * expectedNextValue;
+}
+
+std::pair<GridPosition, GridPosition> TagMdpSolver::getCanonicalPositions(
+        TagState const &state) const {
+    GridPosition robotPos = state.getRobotPosition();
+    GridPosition opponentPos = state.getOpponentPosition();
+    long index = symmetries_.getCanonicalIndex( { robotPos, opponentPos });
+    return std::make_pair(symmetries_.transform(index, robotPos),
+            symmetries_.transform(index, opponentPos));
+}
 
 /* ---------------------- TagMdpParser --------------------- */
 TagMdpParser::TagMdpParser(TagModel *model) :
@@ -211,4 +386,28 @@ solver::HeuristicFunction TagMdpParser::parse(solver::Solver */*solver*/,
         return solver->getValue(static_cast<TagState const &>(*state));
     };
 }
+
+/* ---------------------- TagQmdpParser --------------------- */
+TagQmdpParser::TagQmdpParser(TagModel *model) :
+        model_(model) {
+}
+
+std::vector<std::unique_ptr<solver::Action>> TagQmdpParser::getAllActions() {
+    std::vector<std::unique_ptr<solver::Action>> actions;
+    for (std::unique_ptr<solver::DiscretizedPoint> &action : model_->getPrimitiveActionsInOrder()) {
+        actions.push_back(std::move(action));
+    }
+    return actions;
+}
+
+solver::MdpQValueFunction TagQmdpParser::getQValueFunction() {
+    if (model_->getMdpSolver() == nullptr) {
+        model_->makeMdpSolver();
+    }
+    return [this] (solver::State const &state, solver::Action const &action) {
+        TagMdpSolver *solver = model_->getMdpSolver();
+        return solver->getQValue(static_cast<TagState const &>(state),
+                static_cast<TagAction const &>(action).getActionType());
+    };
+}
 } /* namespace tag */
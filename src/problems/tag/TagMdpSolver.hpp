@@ -10,15 +10,19 @@
 #define TAG_MDPSOLVER_HPP_
 
 #include <iostream>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "global.hpp"
 
+#include "problems/shared/GridSymmetries.hpp"
 #include "problems/shared/parsers.hpp"
 
 #include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
 
+#include "TagAction.hpp"
 #include "TagState.hpp"
 
 namespace tag {
@@ -26,6 +30,9 @@ class TagModel;
 
 /** A class that solves the fully observable version of Tag and stores the calculated value for
  * each state.
+ *
+ * If the map is symmetric, only the states that are canonical under its symmetries are solved
+ * for, since the opponent's movement treats all directions alike.
  */
 class TagMdpSolver {
 public:
@@ -34,16 +41,66 @@ public:
     virtual ~TagMdpSolver() = default;
     _NO_COPY_OR_MOVE(TagMdpSolver);
 
-    /** Solves the MDP, using the current state of the */
+    /** Solves the MDP from scratch, using the current state of the model's map. */
     void solve();
 
+    /** Updates the solution after changes to the model's map.
+     *
+     * The previous values are used as a starting point, and only the states near the cells that
+     * have changed - and any states whose values are affected in turn - are backed up again. If
+     * there is no previous solution, or the symmetries of the map have changed, this simply
+     * calls solve().
+     */
+    void update();
+
+    /** Returns a new solver with this solver's solution updated, as per update(), for a map whose
+     * empty cells are as given ([row][col]).
+     *
+     * This solver is left unchanged, and the model's current map is not used, so this can run
+     * while this solver is in use.
+     */
+    std::unique_ptr<TagMdpSolver> prepareUpdate(std::vector<std::vector<bool>> const &emptyCells)
+            const;
+
     /** Returns the calculated MDP value for the given state. */
     double getValue(TagState const &state) const;
 
+    /** Returns the MDP Q-value for taking the given action from the given state, using the
+     * calculated values for the next states.
+     */
+    double getQValue(TagState const &state, ActionType action) const;
+
 private:
+    /** Updates the solution for a map with the given empty cells, as per update(). */
+    void update(std::vector<std::vector<bool>> const &emptyCells);
+
+    /** Builds and solves the MDP for a map with the given empty cells. If changedCells is not
+     * null, the MDP is solved by prioritized sweeping from the previous values, starting with the
+     * states within one step of those cells.
+     */
+    void solveMdp(std::vector<std::vector<bool>> const &emptyCells,
+            std::vector<GridPosition> const *changedCells);
+
+    /** Returns the position after moving in the given direction on the map that was solved for;
+     * moves into walls or off the map leave the position unchanged.
+     */
+    GridPosition getMovedPos(GridPosition const &position, ActionType action) const;
+    /** Returns the distribution of next opponent positions on the map that was solved for. */
+    std::unordered_map<GridPosition, double> getNextOpponentPositionDistribution(
+            GridPosition const &robotPos, GridPosition const &opponentPos) const;
+
+    /** Returns the canonical robot and opponent positions for the given state under the
+     * symmetries of the map; the state with those positions has the same value.
+     */
+    std::pair<GridPosition, GridPosition> getCanonicalPositions(TagState const &state) const;
+
     /** The model instance this MDP solver is associated with. */
     TagModel *model_;
-    /** A map to hold the calculated value for each non-terminal state. */
+    /** The symmetries of the map the MDP was solved for. */
+    GridSymmetries symmetries_;
+    /** Which cells were empty in the map the MDP was solved for. */
+    std::vector<std::vector<bool>> solvedEmptyCells_;
+    /** A map to hold the calculated value for each canonical non-terminal state. */
     std::unordered_map<TagState, double> valueMap_;
 };
 
@@ -65,6 +122,24 @@ private:
     /** The TagModel instance this heuristic parser is associated with. */
     TagModel *model_;
 };
+
+/** A class to parse the recommendation strategy setting for the case "qmdp(...)", which uses the
+ * MDP Q-values as a fallback when the search has too few histories.
+ */
+class TagQmdpParser : public shared::QmdpRecommendedActionStrategyParser {
+public:
+    /** Creates a new QMDP parser associated with the given TagModel instance. */
+    TagQmdpParser(TagModel *model);
+    virtual ~TagQmdpParser() = default;
+    _NO_COPY_OR_MOVE(TagQmdpParser);
+
+    virtual std::vector<std::unique_ptr<solver::Action>> getAllActions() override;
+    virtual solver::MdpQValueFunction getQValueFunction() override;
+
+private:
+    /** The TagModel instance this parser is associated with. */
+    TagModel *model_;
+};
 } /* namespace tag */
 
 #endif /* TAG_MDPSOLVER_HPP_ */
@@ -10,14 +10,17 @@
 
 #include <memory>
 #include <fstream>                      // for ifstream, basic_istream, basic_istream<>::__istream_type
+#include <functional>                   // for function
 #include <iomanip>                      // for operator<<, setw
 #include <iostream>                     // for cout
+#include <limits>                       // for numeric_limits
 #include <random>                       // for uniform_int_distribution, bernoulli_distribution
 #include <unordered_map>                // for _Node_iterator, operator!=, unordered_map<>::iterator, _Node_iterator_base, unordered_map
 #include <utility>                      // for make_pair, move, pair
 
 #include "global.hpp"                     // for RandomGenerator, make_unique
 #include "problems/shared/GridPosition.hpp"  // for GridPosition, operator==, operator!=, operator<<
+#include "problems/shared/GridSymmetries.hpp"  // for GridSymmetries
 #include "problems/shared/ModelWithProgramOptions.hpp"  // for ModelWithProgramOptions
 
 #include "solver/abstract-problem/Action.hpp"            // for Action
@@ -27,7 +30,7 @@
 
 #include "solver/changes/ChangeFlags.hpp"        // for ChangeFlags
 
-#include "solver/indexing/FlaggingVisitor.hpp"
+#include "solver/indexing/RegionFlagger.hpp"
 #include "solver/indexing/RTree.hpp"
 #include "solver/indexing/SpatialIndexVisitor.hpp"             // for State, operator<<, operator==
 
@@ -39,6 +42,7 @@
 #include "solver/StatePool.hpp"
 
 #include "TagAction.hpp"
+#include "TagMacroTransition.hpp"
 #include "TagObservation.hpp"
 #include "TagOptions.hpp"
 #include "TagState.hpp"                 // for TagState
@@ -71,8 +75,13 @@ TagModel::TagModel(RandomGenerator *randGen, std::unique_ptr<TagOptions> options
             envMap_(), // will be pushed to
             nActions_(5),
             mdpSolver_(nullptr),
-            pairwiseDistances_() {
+            pairwiseDistances_(),
+            preparedChanges_(nullptr) {
     options_->numberOfStateVariables = 5;
+    if (options_->macroActionLength > 0) {
+        nActions_ = 9;
+        options_->hasMacroActions = true;
+    }
     options_->minVal = -failedTagPenalty_ / (1 - options_->discountFactor);
     options_->maxVal = tagReward_;
 
@@ -80,6 +89,8 @@ TagModel::TagModel(RandomGenerator *randGen, std::unique_ptr<TagOptions> options
     registerHeuristicParser("upper", std::make_unique<TagUBParser>(this));
     // Register the exact MDP heuristic parser.
     registerHeuristicParser("exactMdp", std::make_unique<TagMdpParser>(this));
+    // Register the QMDP fallback recommendation strategy parser.
+    registerSelectRecommendedActionParser("qmdp", std::make_unique<TagQmdpParser>(this));
 
     // Read the map from the file.
     std::ifstream inFile;
@@ -106,6 +117,7 @@ TagModel::TagModel(RandomGenerator *randGen, std::unique_ptr<TagOptions> options
         cout << "Size: " << nRows_ << " by " << nCols_ << endl;
         cout << "move cost: " << moveCost_ << endl;
         cout << "nActions: " << nActions_ << endl;
+        cout << "Map symmetries: " << GridSymmetries(envMap_).getNumberOfSymmetries() << endl;
         cout << "nStVars: " << options_->numberOfStateVariables << endl;
         cout << "minParticleCount: " << options_->minParticleCount << endl;
         cout << "Environment:" << endl << endl;
@@ -117,15 +129,16 @@ int TagModel::getMapDistance(GridPosition p1, GridPosition p2) {
     return pairwiseDistances_[p1.i][p1.j][p2.i][p2.j];
 }
 
-void TagModel::calculateDistancesFrom(GridPosition position) {
-    auto &distanceGrid = pairwiseDistances_[position.i][position.j];
+void TagModel::calculateDistancesFrom(GridPosition position,
+        std::vector<std::vector<TagCellType>> const &envMap,
+        std::vector<std::vector<int>> &distanceGrid) {
     // Fill the grid with "-1", for inaccessible cells.
     for (auto &row : distanceGrid) {
         for (auto &cell : row) {
             cell = -1;
         }
     }
-    if (envMap_[position.i][position.j] == TagCellType::WALL) {
+    if (envMap[position.i][position.j] == TagCellType::WALL) {
         return;
     }
 
@@ -137,11 +150,12 @@ void TagModel::calculateDistancesFrom(GridPosition position) {
         GridPosition pos = queue.front();
         queue.pop();
         int distance = distanceGrid[pos.i][pos.j] + 1;
-        for (ActionType direction : { ActionType::NORTH, ActionType::SOUTH, ActionType::WEST,
-                ActionType::EAST }) {
-            GridPosition nextPos;
-            bool isLegal;
-            std::tie(nextPos, isLegal) = getMovedPos(pos, direction);
+        // The given map may differ from the current one, so getMovedPos() can't be used here.
+        for (GridPosition nextPos : { GridPosition(pos.i - 1, pos.j),
+                GridPosition(pos.i + 1, pos.j), GridPosition(pos.i, pos.j - 1),
+                GridPosition(pos.i, pos.j + 1) }) {
+            bool isLegal = (nextPos.i >= 0 && nextPos.i < nRows_ && nextPos.j >= 0
+                    && nextPos.j < nCols_ && envMap[nextPos.i][nextPos.j] != TagCellType::WALL);
             // If it's legal and it's an improvement it needs to be queued.
             if (isLegal) {
                 int &nextPosDistance = distanceGrid[nextPos.i][nextPos.j];
@@ -154,14 +168,236 @@ void TagModel::calculateDistancesFrom(GridPosition position) {
     }
 }
 
-void TagModel::calculatePairwiseDistances() {
+void TagModel::calculatePairwiseDistances(std::vector<std::vector<TagCellType>> const &envMap,
+        DistanceTable &distances) {
+    distances.resize(nRows_);
+    for (auto &rowOfGrids : distances) {
+        rowOfGrids.resize(nCols_);
+        for (auto &grid : rowOfGrids) {
+            grid.resize(nRows_);
+            for (auto &row : grid) {
+                row.resize(nCols_);
+            }
+        }
+    }
+
+    GridSymmetries symmetries;
+    if (options_->useMapSymmetries) {
+        symmetries = GridSymmetries(envMap);
+    }
+
+    // Search only from one cell out of each set of symmetric cells...
+    for (int i = 0; i < nRows_; i++) {
+        for (int j = 0; j < nCols_; j++) {
+            if (symmetries.isCanonical( { GridPosition(i, j) })) {
+                calculateDistancesFrom(GridPosition(i, j), envMap, distances[i][j]);
+            }
+        }
+    }
+    if (symmetries.getNumberOfSymmetries() == 1) {
+        return;
+    }
+    // ... and get the distances from the other cells via the symmetry that maps them onto it.
     for (int i = 0; i < nRows_; i++) {
         for (int j = 0; j < nCols_; j++) {
-            calculateDistancesFrom(GridPosition(i, j));
+            long index = symmetries.getCanonicalIndex( { GridPosition(i, j) });
+            GridPosition source = symmetries.transform(index, GridPosition(i, j));
+            if (source == GridPosition(i, j)) {
+                continue;
+            }
+            for (int i2 = 0; i2 < nRows_; i2++) {
+                for (int j2 = 0; j2 < nCols_; j2++) {
+                    GridPosition target = symmetries.transform(index, GridPosition(i2, j2));
+                    distances[i][j][i2][j2] = distances[source.i][source.j][target.i][target.j];
+                }
+            }
+        }
+    }
+}
+
+void TagModel::updatePairwiseDistances(std::vector<std::vector<TagCellType>> const &oldEnvMap,
+        std::vector<std::vector<TagCellType>> const &newEnvMap, DistanceTable &distances) {
+    // The new walls are dealt with first, on a map where the removed walls are still present.
+    std::vector<std::vector<TagCellType>> intermediateMap = oldEnvMap;
+    std::vector<GridPosition> addedCells;
+    std::vector<GridPosition> removedCells;
+    for (long i = 0; i < nRows_; i++) {
+        for (long j = 0; j < nCols_; j++) {
+            if (oldEnvMap[i][j] == newEnvMap[i][j]) {
+                continue;
+            }
+            if (newEnvMap[i][j] == TagCellType::WALL) {
+                addedCells.emplace_back(i, j);
+                intermediateMap[i][j] = TagCellType::WALL;
+            } else {
+                removedCells.emplace_back(i, j);
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> cellStatus(nRows_, std::vector<int>(nCols_, 0));
+    for (long i = 0; i < nRows_; i++) {
+        for (long j = 0; j < nCols_; j++) {
+            std::vector<std::vector<int>> &distanceGrid = distances[i][j];
+            if (oldEnvMap[i][j] == TagCellType::WALL || newEnvMap[i][j] == TagCellType::WALL) {
+                // There's nothing to repair if this cell is or was a wall.
+                calculateDistancesFrom(GridPosition(i, j), newEnvMap, distanceGrid);
+                continue;
+            }
+            if (!addedCells.empty()) {
+                repairDistancesAfterAdding(addedCells, intermediateMap, distanceGrid, cellStatus);
+            }
+            if (!removedCells.empty()) {
+                repairDistancesAfterRemoving(removedCells, newEnvMap, distanceGrid);
+            }
+        }
+    }
+}
+
+void TagModel::repairDistancesAfterAdding(std::vector<GridPosition> const &addedCells,
+        std::vector<std::vector<TagCellType>> const &envMap,
+        std::vector<std::vector<int>> &distanceGrid,
+        std::vector<std::vector<int>> &cellStatus) {
+    // The status of each cell is 0 => unvisited, 1 => queued, or 2 => affected.
+    std::vector<GridPosition> queuedCells;
+    std::vector<GridPosition> affectedCells;
+
+    // Find the cells that have lost all of their shortest paths, in order of their old distance;
+    // a cell is only affected if every neighbour one step closer is a new wall or affected.
+    DistanceQueue queue;
+    for (GridPosition const &cell : addedCells) {
+        if (distanceGrid[cell.i][cell.j] != -1) {
+            cellStatus[cell.i][cell.j] = 2;
+            queuedCells.push_back(cell);
+            queue.emplace(distanceGrid[cell.i][cell.j], cell.i * nCols_ + cell.j);
+        }
+    }
+    while (!queue.empty()) {
+        int distance = queue.top().first;
+        GridPosition pos(queue.top().second / nCols_, queue.top().second % nCols_);
+        queue.pop();
+        GridPosition neighbours[] = { GridPosition(pos.i - 1, pos.j),
+                GridPosition(pos.i + 1, pos.j), GridPosition(pos.i, pos.j - 1),
+                GridPosition(pos.i, pos.j + 1) };
+        if (cellStatus[pos.i][pos.j] != 2) {
+            bool isSupported = false;
+            for (GridPosition const &previousPos : neighbours) {
+                if (isEmptyCell(previousPos, envMap)
+                        && cellStatus[previousPos.i][previousPos.j] != 2
+                        && distanceGrid[previousPos.i][previousPos.j] == distance - 1) {
+                    isSupported = true;
+                    break;
+                }
+            }
+            if (isSupported) {
+                continue;
+            }
+            cellStatus[pos.i][pos.j] = 2;
+            affectedCells.push_back(pos);
+        }
+        for (GridPosition const &nextPos : neighbours) {
+            if (isEmptyCell(nextPos, envMap) && cellStatus[nextPos.i][nextPos.j] == 0
+                    && distanceGrid[nextPos.i][nextPos.j] == distance + 1) {
+                cellStatus[nextPos.i][nextPos.j] = 1;
+                queuedCells.push_back(nextPos);
+                queue.emplace(distance + 1, nextPos.i * nCols_ + nextPos.j);
+            }
+        }
+    }
+
+    for (GridPosition const &cell : addedCells) {
+        distanceGrid[cell.i][cell.j] = -1;
+    }
+    if (affectedCells.empty()) {
+        for (GridPosition const &cell : queuedCells) {
+            cellStatus[cell.i][cell.j] = 0;
+        }
+        return;
+    }
+    for (GridPosition const &cell : affectedCells) {
+        distanceGrid[cell.i][cell.j] = -1;
+    }
+    // The affected cells get new distances via their unaffected neighbours, if they have any.
+    for (GridPosition const &cell : affectedCells) {
+        int &distance = distanceGrid[cell.i][cell.j];
+        for (GridPosition const &previousPos : { GridPosition(cell.i - 1, cell.j),
+                GridPosition(cell.i + 1, cell.j), GridPosition(cell.i, cell.j - 1),
+                GridPosition(cell.i, cell.j + 1) }) {
+            if (!isEmptyCell(previousPos, envMap) || cellStatus[previousPos.i][previousPos.j] == 2) {
+                continue;
+            }
+            int previousDistance = distanceGrid[previousPos.i][previousPos.j];
+            if (previousDistance != -1 && (distance == -1 || distance > previousDistance + 1)) {
+                distance = previousDistance + 1;
+            }
+        }
+        if (distance != -1) {
+            queue.emplace(distance, cell.i * nCols_ + cell.j);
+        }
+    }
+    for (GridPosition const &cell : queuedCells) {
+        cellStatus[cell.i][cell.j] = 0;
+    }
+    propagateDistances(queue, envMap, distanceGrid);
+}
+
+void TagModel::repairDistancesAfterRemoving(std::vector<GridPosition> const &removedCells,
+        std::vector<std::vector<TagCellType>> const &envMap,
+        std::vector<std::vector<int>> &distanceGrid) {
+    // The newly opened cells get distances via their neighbours, and then pass them on.
+    DistanceQueue queue;
+    for (GridPosition const &cell : removedCells) {
+        int &distance = distanceGrid[cell.i][cell.j];
+        for (GridPosition const &previousPos : { GridPosition(cell.i - 1, cell.j),
+                GridPosition(cell.i + 1, cell.j), GridPosition(cell.i, cell.j - 1),
+                GridPosition(cell.i, cell.j + 1) }) {
+            if (!isEmptyCell(previousPos, envMap)) {
+                continue;
+            }
+            int previousDistance = distanceGrid[previousPos.i][previousPos.j];
+            if (previousDistance != -1 && (distance == -1 || distance > previousDistance + 1)) {
+                distance = previousDistance + 1;
+            }
+        }
+        if (distance != -1) {
+            queue.emplace(distance, cell.i * nCols_ + cell.j);
+        }
+    }
+    propagateDistances(queue, envMap, distanceGrid);
+}
+
+void TagModel::propagateDistances(DistanceQueue &queue,
+        std::vector<std::vector<TagCellType>> const &envMap,
+        std::vector<std::vector<int>> &distanceGrid) {
+    while (!queue.empty()) {
+        int distance = queue.top().first;
+        GridPosition pos(queue.top().second / nCols_, queue.top().second % nCols_);
+        queue.pop();
+        if (distanceGrid[pos.i][pos.j] != distance) {
+            // This cell has been reached more quickly since it was queued.
+            continue;
+        }
+        for (GridPosition const &nextPos : { GridPosition(pos.i - 1, pos.j),
+                GridPosition(pos.i + 1, pos.j), GridPosition(pos.i, pos.j - 1),
+                GridPosition(pos.i, pos.j + 1) }) {
+            if (!isEmptyCell(nextPos, envMap)) {
+                continue;
+            }
+            int &nextPosDistance = distanceGrid[nextPos.i][nextPos.j];
+            if (nextPosDistance == -1 || nextPosDistance > distance + 1) {
+                nextPosDistance = distance + 1;
+                queue.emplace(nextPosDistance, nextPos.i * nCols_ + nextPos.j);
+            }
         }
     }
 }
 
+bool TagModel::isEmptyCell(GridPosition const &position,
+        std::vector<std::vector<TagCellType>> const &envMap) {
+    return (position.i >= 0 && position.i < nRows_ && position.j >= 0 && position.j < nCols_
+            && envMap[position.i][position.j] != TagCellType::WALL);
+}
+
 void TagModel::initialize() {
     GridPosition p;
     envMap_.resize(nRows_);
@@ -179,18 +415,7 @@ void TagModel::initialize() {
         }
     }
 
-    pairwiseDistances_.resize(nRows_);
-    for (auto &rowOfGrids : pairwiseDistances_) {
-        rowOfGrids.resize(nCols_);
-        for (auto &grid : rowOfGrids) {
-            grid.resize(nRows_);
-            for (auto &row : grid) {
-                row.resize(nCols_);
-            }
-        }
-    }
-
-    calculatePairwiseDistances();
+    calculatePairwiseDistances(envMap_, pairwiseDistances_);
 }
 
 GridPosition TagModel::randomEmptyCell() {
@@ -348,10 +573,34 @@ std::unique_ptr<solver::Observation> TagModel::makeObservation(TagState const &n
             nextState.getRobotPosition() == nextState.getOpponentPosition());
 }
 
+std::unique_ptr<TagMacroTransition> TagModel::makeMacroTransition(TagState const &state,
+        TagAction const &action) {
+    TagAction move(action.getPrimitiveType());
+    std::unique_ptr<TagState> currentState = std::make_unique<TagState>(state);
+    bool sawOpponent = false;
+    for (long step = 0; step < options_->macroActionLength; step++) {
+        currentState = makeNextState(*currentState, move).first;
+        if (currentState->getRobotPosition() == currentState->getOpponentPosition()) {
+            sawOpponent = true;
+        }
+    }
+    return std::make_unique<TagMacroTransition>(*currentState, sawOpponent);
+}
+
 double TagModel::generateReward(solver::State const &state,
         solver::Action const &action,
         solver::TransitionParameters const */*tp*/,
         solver::State const */*nextState*/) {
+    if (static_cast<TagAction const &>(action).isMacro()) {
+        // Every move costs the same, so the reward doesn't depend on the states along the way.
+        double reward = 0;
+        double discount = 1;
+        for (long step = 0; step < options_->macroActionLength; step++) {
+            reward -= discount * moveCost_;
+            discount *= options_->discountFactor;
+        }
+        return reward;
+    }
     if (static_cast<TagAction const &>(action).getActionType()
             == ActionType::TAG) {
         TagState const &tagState = static_cast<TagState const &>(state);
@@ -365,21 +614,65 @@ double TagModel::generateReward(solver::State const &state,
     }
 }
 
+std::unique_ptr<solver::TransitionParameters> TagModel::generateTransition(
+        solver::State const &state, solver::Action const &action) {
+    TagAction const &tagAction = static_cast<TagAction const &>(action);
+    if (!tagAction.isMacro()) {
+        return nullptr;
+    }
+    return makeMacroTransition(static_cast<TagState const &>(state), tagAction);
+}
+
 std::unique_ptr<solver::State> TagModel::generateNextState(
         solver::State const &state, solver::Action const &action,
-        solver::TransitionParameters const */*tp*/) {
+        solver::TransitionParameters const *tp) {
+    TagAction const &tagAction = static_cast<TagAction const &>(action);
+    if (tagAction.isMacro()) {
+        if (tp != nullptr) {
+            return std::make_unique<TagState>(
+                    static_cast<TagMacroTransition const *>(tp)->getFinalState());
+        }
+        return std::make_unique<TagState>(
+                makeMacroTransition(static_cast<TagState const &>(state), tagAction)
+                        ->getFinalState());
+    }
     return makeNextState(static_cast<TagState const &>(state), action).first;
 }
 
 std::unique_ptr<solver::Observation> TagModel::generateObservation(
-        solver::State const */*state*/, solver::Action const &/*action*/,
-        solver::TransitionParameters const */*tp*/,
+        solver::State const */*state*/, solver::Action const &action,
+        solver::TransitionParameters const *tp,
         solver::State const &nextState) {
-    return makeObservation(static_cast<TagState const &>(nextState));
+    TagState const &tagState = static_cast<TagState const &>(nextState);
+    if (tp != nullptr && static_cast<TagAction const &>(action).isMacro()) {
+        // A macro-action sees the opponent if it was seen after any of the moves.
+        return std::make_unique<TagObservation>(tagState.getRobotPosition(),
+                static_cast<TagMacroTransition const *>(tp)->sawOpponent());
+    }
+    return makeObservation(tagState);
+}
+
+long TagModel::getActionDuration(solver::Action const &action) {
+    if (static_cast<TagAction const &>(action).isMacro()) {
+        return options_->macroActionLength;
+    }
+    return 1;
 }
 
 solver::Model::StepResult TagModel::generateStep(solver::State const &state,
         solver::Action const &action) {
+    TagAction const &tagAction = static_cast<TagAction const &>(action);
+    if (tagAction.isMacro()) {
+        solver::Model::StepResult result;
+        result.action = action.copy();
+        std::unique_ptr<solver::TransitionParameters> tp = generateTransition(state, action);
+        result.nextState = generateNextState(state, action, tp.get());
+        result.observation = generateObservation(&state, action, tp.get(), *result.nextState);
+        result.reward = generateReward(state, action, tp.get(), result.nextState.get());
+        result.isTerminal = isTerminal(*result.nextState);
+        result.transitionParameters = std::move(tp);
+        return result;
+    }
     solver::Model::StepResult result;
     result.action = action.copy();
     std::unique_ptr<TagState> nextState = makeNextState(state, action).first;
@@ -395,6 +688,12 @@ solver::Model::StepResult TagModel::generateStep(solver::State const &state,
 /* -------------- Methods for handling model changes ---------------- */
 void TagModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
         solver::Solver *solver) {
+    // Use the work done in advance, if it was done for these exact changes.
+    std::unique_ptr<PreparedChanges> prepared = std::move(preparedChanges_);
+    if (prepared != nullptr && (prepared->changes != &changes || prepared->solver != solver)) {
+        prepared = nullptr;
+    }
+
     solver::StatePool *pool = nullptr;
     if (solver != nullptr) {
         pool = solver->getStatePool();
@@ -411,14 +710,120 @@ void TagModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> co
         }
     }
 
-    for (auto const &change : changes) {
-        TagChange const &tagChange = static_cast<TagChange const &>(*change);
-        if (options_->hasVerboseOutput) {
+    if (options_->hasVerboseOutput) {
+        for (auto const &change : changes) {
+            TagChange const &tagChange = static_cast<TagChange const &>(*change);
             cout << tagChange.changeType << " " << tagChange.i0 << " "
                     << tagChange.j0;
             cout << " " << tagChange.i1 << " " << tagChange.j1 << endl;
         }
+    }
 
+    std::vector<std::vector<TagCellType>> oldEnvMap;
+    if (prepared != nullptr) {
+        envMap_ = std::move(prepared->envMap);
+    } else {
+        oldEnvMap = envMap_;
+        applyChangesToMap(changes, envMap_);
+    }
+
+    if (pool != nullptr) {
+        solver::RTree *tree = static_cast<solver::RTree *>(pool->getStateIndex());
+        if (tree == nullptr) {
+            debug::show_message("ERROR: state index must be enabled to handle changes in Tag!");
+            std::exit(4);
+        }
+        // The affected regions for all of the changes are flagged together.
+        std::unique_ptr<solver::RegionFlagger> flagger = nullptr;
+        if (prepared != nullptr) {
+            flagger = std::move(prepared->flagger);
+        }
+        if (flagger == nullptr) {
+            flagger = std::make_unique<solver::RegionFlagger>(pool, 1.0);
+            addChangedRegions(changes, *flagger);
+        }
+        flagger->flagStates(tree);
+    }
+
+    if (prepared != nullptr && prepared->mdpSolver != nullptr) {
+        mdpSolver_ = std::move(prepared->mdpSolver);
+    } else if (mdpSolver_ != nullptr) {
+        mdpSolver_->update();
+    }
+
+    if (prepared != nullptr) {
+        pairwiseDistances_ = std::move(prepared->pairwiseDistances);
+    } else {
+        updatePairwiseDistances(oldEnvMap, envMap_, pairwiseDistances_);
+    }
+
+    // Check for heuristic changes.
+    if (pool != nullptr) {
+        long nStates = pool->getNumberOfStates();
+        for (long index = 0; index < nStates; index++) {
+            double oldValue = allHeuristicValues[index];
+            solver::StateInfo *info = pool->getInfoById(index);
+            double newValue = heuristic(nullptr, info->getState(), nullptr);
+            if (std::abs(newValue - oldValue) > 1e-5) {
+                pool->setChangeFlags(info, solver::ChangeFlags::HEURISTIC);
+            }
+        }
+    }
+}
+
+void TagModel::prepareChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+        solver::Solver *solver, std::vector<solver::StateInfo *> const &states) {
+    std::unique_ptr<PreparedChanges> prepared = std::make_unique<PreparedChanges>();
+    prepared->changes = &changes;
+    prepared->solver = solver;
+
+    // The new map, distances and MDP solution are worked out on copies, since the search keeps
+    // using the current ones in the meantime.
+    prepared->envMap = envMap_;
+    applyChangesToMap(changes, prepared->envMap);
+    prepared->pairwiseDistances = pairwiseDistances_;
+    updatePairwiseDistances(envMap_, prepared->envMap, prepared->pairwiseDistances);
+    if (mdpSolver_ != nullptr) {
+        prepared->mdpSolver = mdpSolver_->prepareUpdate(getEmptyCells(prepared->envMap));
+    }
+
+    if (solver != nullptr) {
+        prepared->flagger = std::make_unique<solver::RegionFlagger>(solver->getStatePool(), 1.0);
+        addChangedRegions(changes, *prepared->flagger);
+        prepared->flagger->prepare(states);
+    }
+    preparedChanges_ = std::move(prepared);
+}
+
+std::vector<GridPosition> TagModel::getEmptyPositions() {
+    std::vector<GridPosition> positions;
+    for (long i = 0; i < nRows_; i++) {
+        for (long j = 0; j < nCols_; j++) {
+            if (envMap_[i][j] == TagCellType::EMPTY) {
+                positions.push_back(GridPosition(i, j));
+            }
+        }
+    }
+    return positions;
+}
+
+std::vector<std::vector<bool>> TagModel::getEmptyCells(
+        std::vector<std::vector<TagCellType>> const &envMap) const {
+    std::vector<std::vector<bool>> emptyCells;
+    for (std::vector<TagCellType> const &row : envMap) {
+        emptyCells.emplace_back();
+        for (TagCellType cellType : row) {
+            emptyCells.back().push_back(cellType == TagCellType::EMPTY);
+        }
+    }
+    return emptyCells;
+}
+
+void TagModel::applyChangesToMap(
+        std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+        std::vector<std::vector<TagCellType>> &envMap) {
+    for (auto const &change : changes) {
+        TagChange const &tagChange = static_cast<TagChange const &>(*change);
         TagCellType newCellType;
         if (tagChange.changeType == "Add Obstacles") {
             newCellType = TagCellType::WALL;
@@ -431,20 +836,22 @@ void TagModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> co
 
         for (long i = tagChange.i0; i <= tagChange.i1; i++) {
             for (long j = tagChange.j0; j <= tagChange.j1; j++) {
-                envMap_[i][j] = newCellType;
+                envMap[i][j] = newCellType;
             }
         }
+    }
+}
 
-        if (pool == nullptr) {
+void TagModel::addChangedRegions(
+        std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+        solver::RegionFlagger &flagger) {
+    for (auto const &change : changes) {
+        TagChange const &tagChange = static_cast<TagChange const &>(*change);
+        if (tagChange.changeType != "Add Obstacles"
+                && tagChange.changeType != "Remove Obstacles") {
             continue;
         }
 
-        solver::RTree *tree = static_cast<solver::RTree *>(pool->getStateIndex());
-        if (tree == nullptr) {
-            debug::show_message("ERROR: state index must be enabled to handle changes in Tag!");
-            std::exit(4);
-        }
-
         double iLo = tagChange.i0;
         double iHi = tagChange.i1;
         double iMx = nRows_ - 1.0;
@@ -455,57 +862,49 @@ void TagModel::applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> co
 
         // Adding walls => any states where the robot or the opponent are in a wall must
         // be deleted.
-        if (newCellType == TagCellType::WALL) {
-            solver::FlaggingVisitor visitor(pool, solver::ChangeFlags::DELETED);
+        if (tagChange.changeType == "Add Obstacles") {
             // Robot is in a wall.
-            tree->boxQuery(visitor,
-                    {iLo, jLo, 0.0, 0.0, 0.0},
-                    {iHi, jHi, iMx, jMx, 1.0});
+            flagger.addRegion({iLo, jLo, 0.0, 0.0, 0.0},
+                    {iHi, jHi, iMx, jMx, 1.0}, solver::ChangeFlags::DELETED);
             // Opponent is in a wall.
-            tree->boxQuery(visitor,
-                    {0.0, 0.0, iLo, jLo, 0.0},
-                    {iMx, jMx, iHi, jHi, 1.0});
-
+            flagger.addRegion({0.0, 0.0, iLo, jLo, 0.0},
+                    {iMx, jMx, iHi, jHi, 1.0}, solver::ChangeFlags::DELETED);
         }
 
         // Also, state transitions around the edges of the new / former obstacle must be revised.
-        solver::FlaggingVisitor visitor(pool, solver::ChangeFlags::TRANSITION);
-        tree->boxQuery(visitor,
-                {iLo - 1, jLo - 1, 0.0, 0.0, 0.0},
-                {iHi + 1, jHi + 1, iMx, jMx, 1.0});
-        tree->boxQuery(visitor,
-                {0.0, 0.0, iLo - 1, jLo - 1, 0.0},
-                {iMx, jMx, iHi + 1, jHi + 1, 1.0});
-    }
-
-    if (mdpSolver_ != nullptr) {
-        mdpSolver_->solve();
-    }
-
-    calculatePairwiseDistances();
-
-    // Check for heuristic changes.
-    if (pool != nullptr) {
-        long nStates = pool->getNumberOfStates();
-        for (long index = 0; index < nStates; index++) {
-            double oldValue = allHeuristicValues[index];
-            solver::StateInfo *info = pool->getInfoById(index);
-            double newValue = heuristic(nullptr, info->getState(), nullptr);
-            if (std::abs(newValue - oldValue) > 1e-5) {
-                pool->setChangeFlags(info, solver::ChangeFlags::HEURISTIC);
-            }
-        }
+        flagger.addRegion({iLo - 1, jLo - 1, 0.0, 0.0, 0.0},
+                {iHi + 1, jHi + 1, iMx, jMx, 1.0}, solver::ChangeFlags::TRANSITION);
+        flagger.addRegion({0.0, 0.0, iLo - 1, jLo - 1, 0.0},
+                {iMx, jMx, iHi + 1, jHi + 1, 1.0}, solver::ChangeFlags::TRANSITION);
     }
 }
 
 
 /* ------------ Methods for handling particle depletion -------------- */
 std::vector<std::unique_ptr<solver::State>> TagModel::generateParticles(
-        solver::BeliefNode */*previousBelief*/, solver::Action const &action,
+        solver::BeliefNode *previousBelief, solver::Action const &action,
         solver::Observation const &obs,
         long nParticles,
         std::vector<solver::State const *> const &previousParticles) {
-    std::vector<std::unique_ptr<solver::State>> newParticles;
+    if (static_cast<TagAction const &>(action).isMacro()) {
+        // The opponent can move at every step of a macro-action, so use rejection sampling.
+        return Model::generateParticles(previousBelief, action, obs, nParticles,
+                previousParticles);
+    }
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts = (
+            getExpectedParticleCounts(previousBelief, action, obs, nParticles,
+                    previousParticles));
+    return drawParticles(expectedCounts, 0, expectedCounts.size());
+}
+
+std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+TagModel::getExpectedParticleCounts(solver::BeliefNode */*previousBelief*/,
+        solver::Action const &action, solver::Observation const &obs, long nParticles,
+        std::vector<solver::State const *> const &previousParticles) {
+    std::vector<std::pair<std::unique_ptr<solver::State>, double>> expectedCounts;
+    if (static_cast<TagAction const &>(action).isMacro()) {
+        return expectedCounts;
+    }
     TagObservation const &observation =
             (static_cast<TagObservation const &>(obs));
     ActionType actionType =
@@ -518,9 +917,8 @@ std::vector<std::unique_ptr<solver::State>> TagModel::generateParticles(
     GridPosition newRobotPos(observation.getPosition());
     if (observation.seesOpponent()) {
         // If we saw the opponent, we must be in the same place.
-        newParticles.push_back(
-                std::make_unique<TagState>(newRobotPos, newRobotPos,
-                        actionType == ActionType::TAG));
+        expectedCounts.emplace_back(std::make_unique<TagState>(newRobotPos, newRobotPos,
+                actionType == ActionType::TAG), 1.0);
     } else {
         // We didn't see the opponent, so we must be in different places.
         for (solver::State const *state : previousParticles) {
@@ -547,23 +945,131 @@ std::vector<std::unique_ptr<solver::State>> TagModel::generateParticles(
         double scale = nParticles / weightTotal;
         for (WeightMap::iterator it = weights.begin(); it != weights.end();
                 it++) {
-            double proportion = it->second * scale;
-            long numToAdd = static_cast<long>(proportion);
-            if (std::bernoulli_distribution(proportion - numToAdd)(
-                    *getRandomGenerator())) {
-                numToAdd += 1;
+            expectedCounts.emplace_back(std::make_unique<TagState>(it->first),
+                    it->second * scale);
+        }
+    }
+    return expectedCounts;
+}
+
+std::unique_ptr<solver::State> TagModel::generateRejuvenationProposal(
+        solver::State const &state) {
+    TagState const &tagState = static_cast<TagState const &>(state);
+    if (tagState.isTagged()) {
+        return std::make_unique<TagState>(tagState);
+    }
+    // A move into a wall proposes the same state, which keeps the proposal symmetric.
+    ActionType direction = static_cast<ActionType>(std::uniform_int_distribution<long>(
+            static_cast<long>(ActionType::NORTH), static_cast<long>(ActionType::WEST))(
+                    *getRandomGenerator()));
+    GridPosition opponentPos = getMovedPos(tagState.getOpponentPosition(), direction).first;
+    return std::make_unique<TagState>(tagState.getRobotPosition(), opponentPos, false);
+}
+
+std::function<double(solver::State const &)> TagModel::createHistoryLikelihood(
+        solver::BeliefNode const *belief) {
+    std::unordered_map<TagState, double> probabilities = calculateBelief(belief);
+    if (probabilities.empty()) {
+        return nullptr;
+    }
+    return [probabilities](solver::State const &state) {
+        auto it = probabilities.find(static_cast<TagState const &>(state));
+        if (it == probabilities.end()) {
+            return 0.0;
+        }
+        return it->second;
+    };
+}
+
+std::unordered_map<TagState, double> TagModel::calculateBelief(
+        solver::BeliefNode const *belief) {
+    // Collect the path back up to the root.
+    std::vector<solver::BeliefNode const *> path;
+    for (solver::BeliefNode const *node = belief; node->getParentBelief() != nullptr;
+            node = node->getParentBelief()) {
+        path.push_back(node);
+    }
+
+    std::vector<GridPosition> emptyCells = getEmptyPositions();
+    std::unordered_map<TagState, double> probabilities;
+    for (GridPosition const &robotPos : emptyCells) {
+        for (GridPosition const &opponentPos : emptyCells) {
+            TagState state(robotPos, opponentPos, false);
+            probabilities[state] = 1.0 / (emptyCells.size() * emptyCells.size());
+        }
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); it++) {
+        std::unique_ptr<solver::Action> action = (*it)->getLastAction();
+        TagAction const &tagAction = static_cast<TagAction const &>(*action);
+        ActionType actionType = tagAction.getPrimitiveType();
+
+        // For a macro-action, the opponent is seen if it is seen after any of the moves, so the
+        // probabilities for the paths along which it was already seen are kept separately.
+        std::unordered_map<TagState, double> seenProbabilities;
+        for (long step = 0; step < getActionDuration(tagAction); step++) {
+            std::unordered_map<TagState, double> nextProbabilities;
+            std::unordered_map<TagState, double> nextSeenProbabilities;
+            for (auto *distribution : {&probabilities, &seenProbabilities}) {
+                bool wasSeen = (distribution == &seenProbabilities);
+                for (auto const &entry : *distribution) {
+                    TagState const &state = entry.first;
+                    GridPosition robotPos = state.getRobotPosition();
+                    GridPosition opponentPos = state.getOpponentPosition();
+                    if (state.isTagged()) {
+                        nextSeenProbabilities[state] += entry.second;
+                        continue;
+                    }
+                    if (actionType == ActionType::TAG && robotPos == opponentPos) {
+                        TagState nextState(robotPos, opponentPos, true);
+                        nextSeenProbabilities[nextState] += entry.second;
+                        continue;
+                    }
+                    GridPosition newRobotPos = getMovedPos(robotPos, actionType).first;
+                    for (auto const &opponentEntry : getNextOpponentPositionDistribution(robotPos,
+                            opponentPos)) {
+                        TagState nextState(newRobotPos, opponentEntry.first, false);
+                        bool isSeen = wasSeen || newRobotPos == opponentEntry.first;
+                        (isSeen ? nextSeenProbabilities : nextProbabilities)[nextState] += (
+                                entry.second * opponentEntry.second);
+                    }
+                }
             }
-            for (int i = 0; i < numToAdd; i++) {
-                newParticles.push_back(std::make_unique<TagState>(it->first));
+            probabilities = std::move(nextProbabilities);
+            seenProbabilities = std::move(nextSeenProbabilities);
+        }
+
+        // Keep only the states that are consistent with the observation.
+        std::unique_ptr<solver::Observation> observation = (*it)->getLastObservation();
+        TagObservation const &tagObservation = static_cast<TagObservation const &>(*observation);
+        if (tagObservation.seesOpponent()) {
+            probabilities = std::move(seenProbabilities);
+        }
+        double totalProbability = 0;
+        for (auto entryIt = probabilities.begin(); entryIt != probabilities.end();) {
+            if (entryIt->first.getRobotPosition() != tagObservation.getPosition()) {
+                entryIt = probabilities.erase(entryIt);
+            } else {
+                totalProbability += entryIt->second;
+                entryIt++;
             }
         }
+        if (totalProbability <= 0) {
+            return std::unordered_map<TagState, double>();
+        }
+        for (auto &entry : probabilities) {
+            entry.second /= totalProbability;
+        }
     }
-    return newParticles;
+    return probabilities;
 }
 
 std::vector<std::unique_ptr<solver::State>> TagModel::generateParticles(
-        solver::BeliefNode */*previousBelief*/, solver::Action const &action,
+        solver::BeliefNode *previousBelief, solver::Action const &action,
         solver::Observation const &obs, long nParticles) {
+    if (static_cast<TagAction const &>(action).isMacro()) {
+        return Model::generateParticles(previousBelief, action, obs, nParticles);
+    }
     std::vector<std::unique_ptr<solver::State>> newParticles;
     TagObservation const &observation =
             (static_cast<TagObservation const &>(obs));
@@ -705,6 +1211,46 @@ double TagModel::getUpperBoundHeuristicValue(solver::State const &state) {
     return qVal;
 }
 
+std::vector<std::pair<std::unique_ptr<solver::Observation>, std::unique_ptr<solver::Action>>>
+TagModel::getFallbackActions() {
+    std::vector<GridPosition> emptyPositions = getEmptyPositions();
+    std::vector<std::pair<std::unique_ptr<solver::Observation>, std::unique_ptr<solver::Action>>>
+        fallbackActions;
+    for (GridPosition const &robotPos : emptyPositions) {
+        fallbackActions.emplace_back(std::make_unique<TagObservation>(robotPos, true),
+                std::make_unique<TagAction>(ActionType::TAG));
+
+        // The opponent is equally likely to be in any other empty cell.
+        ActionType bestAction = ActionType::TAG;
+        double bestValue = -std::numeric_limits<double>::infinity();
+        for (long code = 0; code <= static_cast<long>(ActionType::TAG); code++) {
+            ActionType action = static_cast<ActionType>(code);
+            if (mdpSolver_ == nullptr && action == ActionType::TAG) {
+                continue;
+            }
+            GridPosition nextPos = getMovedPos(robotPos, action).first;
+            double value = 0;
+            for (GridPosition const &opponentPos : emptyPositions) {
+                if (opponentPos == robotPos) {
+                    continue;
+                }
+                if (mdpSolver_ != nullptr) {
+                    value += mdpSolver_->getQValue(TagState(robotPos, opponentPos, false), action);
+                } else if (getMapDistance(nextPos, opponentPos) >= 0) {
+                    value -= getMapDistance(nextPos, opponentPos);
+                }
+            }
+            if (value > bestValue) {
+                bestAction = action;
+                bestValue = value;
+            }
+        }
+        fallbackActions.emplace_back(std::make_unique<TagObservation>(robotPos, false),
+                std::make_unique<TagAction>(bestAction));
+    }
+    return fallbackActions;
+}
+
 
 /* ------- Customization of more complex solver functionality  --------- */
 std::vector<std::unique_ptr<solver::DiscretizedPoint>> TagModel::getAllActionsInOrder() {
@@ -715,6 +1261,14 @@ std::vector<std::unique_ptr<solver::DiscretizedPoint>> TagModel::getAllActionsIn
     return allActions;
 }
 
+std::vector<std::unique_ptr<solver::DiscretizedPoint>> TagModel::getPrimitiveActionsInOrder() {
+    std::vector<std::unique_ptr<solver::DiscretizedPoint>> actions;
+    for (long code = 0; code <= static_cast<long>(ActionType::TAG); code++) {
+        actions.push_back(std::make_unique<TagAction>(code));
+    }
+    return actions;
+}
+
 std::vector<std::vector<float>> TagModel::getBeliefProportions(solver::BeliefNode const *belief) {
     std::vector<solver::State const *> particles = belief->getStates();
     std::vector<std::vector<long>> particleCounts(nRows_,  std::vector<long>(nCols_));
@@ -5,9 +5,12 @@
 #ifndef TAGMODEL_HPP_
 #define TAGMODEL_HPP_
 
+#include <functional>                   // for greater, function
 #include <memory>                       // for unique_ptr
 #include <ostream>                      // for ostream
+#include <queue>                        // for priority_queue
 #include <string>                       // for string
+#include <unordered_map>                // for unordered_map
 #include <utility>                      // for pair
 #include <vector>                       // for vector
 
@@ -23,6 +26,8 @@
 #include "solver/abstract-problem/Observation.hpp"       // for Observation
 #include "solver/abstract-problem/State.hpp"
 
+#include "solver/indexing/RegionFlagger.hpp"
+
 #include "solver/mappings/actions/enumerated_actions.hpp"
 #include "solver/mappings/observations/discrete_observations.hpp"
 
@@ -36,6 +41,7 @@ class StatePool;
 
 /** A namespace to hold the various classes used for the Tag POMDP model. */
 namespace tag {
+class TagMacroTransition;
 class TagObervation;
 class TagState;
 
@@ -172,20 +178,29 @@ class TagModel: public shared::ModelWithProgramOptions {
     bool isValid(solver::State const &state) override;
 
     /* -------------------- Black box dynamics ---------------------- */
+    /** Returns a TagMacroTransition for a macro-action, and nullptr for any other action. */
+    virtual std::unique_ptr<solver::TransitionParameters> generateTransition(
+            solver::State const &state,
+            solver::Action const &action) override;
     virtual std::unique_ptr<solver::State> generateNextState(
             solver::State const &state,
             solver::Action const &action,
-            solver::TransitionParameters const */*tp*/) override;
+            solver::TransitionParameters const *tp) override;
+    /** For a macro-action with transition parameters, the opponent is seen if it was seen after
+     * any of the moves; otherwise only the final state is observed.
+     */
     virtual std::unique_ptr<solver::Observation> generateObservation(
             solver::State const */*state*/,
             solver::Action const &action,
-            solver::TransitionParameters const */*tp*/,
+            solver::TransitionParameters const *tp,
             solver::State const &nextState) override;
     virtual double generateReward(
                 solver::State const &state,
                 solver::Action const &action,
                 solver::TransitionParameters const */*tp*/,
                 solver::State const */*nextState*/) override;
+    /** Returns TagOptions::macroActionLength for macro-actions, and 1 for any other action. */
+    virtual long getActionDuration(solver::Action const &action) override;
     virtual Model::StepResult generateStep(solver::State const &state,
             solver::Action const &action) override;
 
@@ -193,6 +208,11 @@ class TagModel: public shared::ModelWithProgramOptions {
     /* -------------- Methods for handling model changes ---------------- */
     virtual void applyChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
              solver::Solver *solver) override;
+    /** Recalculates the map distances and the MDP solution (if any) for the changed map, and
+     * (given a solver) finds the given states that are within the affected regions.
+     */
+    virtual void prepareChanges(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+             solver::Solver *solver, std::vector<solver::StateInfo *> const &states) override;
 
 
     /* ------------ Methods for handling particle depletion -------------- */
@@ -208,6 +228,13 @@ class TagModel: public shared::ModelWithProgramOptions {
             solver::Observation const &obs,
             long nParticles,
             std::vector<solver::State const *> const &previousParticles) override;
+    /** Returns the possible next states used by the first version of generateParticles(), with
+     * the expected number of copies of each.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<solver::State>, double>>
+    getExpectedParticleCounts(solver::BeliefNode *previousBelief,
+            solver::Action const &action, solver::Observation const &obs, long nParticles,
+            std::vector<solver::State const *> const &previousParticles) override;
 
     /** Generates particles for Tag according to an uninformed prior.
      *
@@ -220,6 +247,18 @@ class TagModel: public shared::ModelWithProgramOptions {
             solver::Observation const &obs,
             long nParticles) override;
 
+    /** Proposes a move to the same state, but with the opponent moved in a random direction. */
+    virtual std::unique_ptr<solver::State> generateRejuvenationProposal(
+            solver::State const &state) override;
+    /** Returns the exact probability of each state given the history leading to the given
+     * belief (see calculateBelief()).
+     *
+     * This already includes the prior, so the ratio between any two states is the same as for
+     * the prior times the likelihood of the observations.
+     */
+    virtual std::function<double(solver::State const &)> createHistoryLikelihood(
+            solver::BeliefNode const *belief) override;
+
 
     /* --------------- Pretty printing methods ----------------- */
     /** Prints a single cell of the map out to the given output stream. */
@@ -243,20 +282,105 @@ class TagModel: public shared::ModelWithProgramOptions {
      */
     virtual double getUpperBoundHeuristicValue(solver::State const &state);
 
+    /** Returns TAG when the opponent is seen. Otherwise, the opponent could be anywhere else, so
+     * this returns the QMDP action if the MDP has been solved, or else the move that brings the
+     * robot closest to the opponent on average.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<solver::Observation>,
+            std::unique_ptr<solver::Action>>> getFallbackActions() override;
+
     /* ------- Customization of more complex solver functionality  --------- */
     /** Returns all of the actions available for the Tag POMDP, in the order of their enumeration
-     * (as specified by tag::ActionType).
+     * (as specified by tag::ActionType); this includes the macro-actions, if they are enabled.
      */
     virtual std::vector<std::unique_ptr<solver::DiscretizedPoint>> getAllActionsInOrder();
+    /** Returns the primitive (single-step) actions for the Tag POMDP, in the order of their
+     * enumeration.
+     */
+    std::vector<std::unique_ptr<solver::DiscretizedPoint>> getPrimitiveActionsInOrder();
     virtual std::unique_ptr<solver::ActionPool> createActionPool(solver::Solver *solver) override;
 
     virtual std::unique_ptr<solver::Serializer> createSerializer(solver::Solver *solver) override;
 
   private:
-    /** Calculates the distances from the given position to all other parts of the map. */
-    void calculateDistancesFrom(GridPosition position);
-    /** Calculates all pairwise distances on the map. */
-    void calculatePairwiseDistances();
+    /** The distances between each pair of cells in a map, indexed as [i1][j1][i2][j2]. */
+    typedef std::vector<std::vector<std::vector<std::vector<int>>>> DistanceTable;
+    /** A queue of cells (as i * nCols + j) and their distances, with the closest cell first. */
+    typedef std::priority_queue<std::pair<int, long>, std::vector<std::pair<int, long>>,
+            std::greater<std::pair<int, long>>> DistanceQueue;
+
+    /** Work done in advance for a set of changes that have not been applied yet. */
+    struct PreparedChanges {
+        /** The changes that were prepared for. */
+        std::vector<std::unique_ptr<solver::ModelChange>> const *changes = nullptr;
+        /** The solver that the changes were prepared for. */
+        solver::Solver *solver = nullptr;
+        /** The environment map after the changes. */
+        std::vector<std::vector<TagCellType>> envMap = { };
+        /** The pairwise distances on the changed map. */
+        DistanceTable pairwiseDistances = { };
+        /** The MDP solution for the changed map, if there is an MDP solver. */
+        std::unique_ptr<TagMdpSolver> mdpSolver = nullptr;
+        /** The affected regions, already checked for the states that already existed. */
+        std::unique_ptr<solver::RegionFlagger> flagger = nullptr;
+    };
+
+    /** Returns the positions of the empty cells in the current map. */
+    std::vector<GridPosition> getEmptyPositions();
+    /** Returns which cells of the given map are empty, indexed as [row][col]. */
+    std::vector<std::vector<bool>> getEmptyCells(
+            std::vector<std::vector<TagCellType>> const &envMap) const;
+
+    /** Calculates the distances from the given position to all other parts of the given map. */
+    void calculateDistancesFrom(GridPosition position,
+            std::vector<std::vector<TagCellType>> const &envMap,
+            std::vector<std::vector<int>> &distanceGrid);
+    /** Calculates all pairwise distances on the given map. */
+    void calculatePairwiseDistances(std::vector<std::vector<TagCellType>> const &envMap,
+            DistanceTable &distances);
+    /** Updates the given pairwise distances, which are correct for the first given map, so that
+     * they are correct for the second given map.
+     *
+     * Only the distances that can be affected by the changed cells are recalculated, so this
+     * is much faster than calculatePairwiseDistances() for small changes.
+     */
+    void updatePairwiseDistances(std::vector<std::vector<TagCellType>> const &oldEnvMap,
+            std::vector<std::vector<TagCellType>> const &newEnvMap, DistanceTable &distances);
+    /** Repairs the distances from a single cell after walls are added at the given cells.
+     *
+     * The given map must already contain the new walls; the distances that are no longer
+     * supported by any shortest path are discarded and then recalculated from their neighbours.
+     * The given grid of cell statuses is scratch space, which must be all zero beforehand and
+     * is left that way afterwards.
+     */
+    void repairDistancesAfterAdding(std::vector<GridPosition> const &addedCells,
+            std::vector<std::vector<TagCellType>> const &envMap,
+            std::vector<std::vector<int>> &distanceGrid,
+            std::vector<std::vector<int>> &cellStatus);
+    /** Repairs the distances from a single cell after walls are removed at the given cells.
+     *
+     * The given map must already have the walls removed; since distances can only decrease,
+     * they are propagated outwards from the newly opened cells.
+     */
+    void repairDistancesAfterRemoving(std::vector<GridPosition> const &removedCells,
+            std::vector<std::vector<TagCellType>> const &envMap,
+            std::vector<std::vector<int>> &distanceGrid);
+    /** Returns true iff the given position is within the bounds of the given map, and empty. */
+    bool isEmptyCell(GridPosition const &position,
+            std::vector<std::vector<TagCellType>> const &envMap);
+    /** Propagates the distances of the queued cells to the rest of the given map, in the manner
+     * of Dijkstra's algorithm, lowering the distances of any cells that can be reached faster.
+     */
+    void propagateDistances(DistanceQueue &queue,
+            std::vector<std::vector<TagCellType>> const &envMap,
+            std::vector<std::vector<int>> &distanceGrid);
+
+    /** Sets the cells of the given map as per the given changes. */
+    void applyChangesToMap(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+            std::vector<std::vector<TagCellType>> &envMap);
+    /** Adds the regions of state space affected by the given changes to the given flagger. */
+    void addChangedRegions(std::vector<std::unique_ptr<solver::ModelChange>> const &changes,
+            solver::RegionFlagger &flagger);
 
     /** Initialises the required data structures and variables for this model. */
     void initialize();
@@ -278,6 +402,12 @@ class TagModel: public shared::ModelWithProgramOptions {
      */
     std::unique_ptr<solver::Observation> makeObservation(TagState const &nextState);
 
+    /** Makes each of the moves of the given macro-action in turn, and returns the final state
+     * along with whether the opponent was seen along the way.
+     */
+    std::unique_ptr<TagMacroTransition> makeMacroTransition(TagState const &state,
+            TagAction const &action);
+
     /** Generates a distribution of possible actions the opponent may choose to take, based on the
      * current position of the robot and the opponent.
      *
@@ -299,6 +429,14 @@ class TagModel: public shared::ModelWithProgramOptions {
      */
     bool isValid(GridPosition const &pos);
 
+    /** Calculates the exact belief for the given belief node, by filtering forward from the
+     * initial belief (uniform over the positions of both the robot and the opponent) along the
+     * actions and observations that lead to it.
+     *
+     * Returns an empty map if that history is impossible under the current map.
+     */
+    std::unordered_map<TagState, double> calculateBelief(solver::BeliefNode const *belief);
+
     /** The TagOptions instance associated with this model. */
     TagOptions *options_;
 
@@ -328,7 +466,10 @@ class TagModel: public shared::ModelWithProgramOptions {
     std::unique_ptr<TagMdpSolver> mdpSolver_;
 
     /** The pairwise distances between each pair of cells in the map. */
-    std::vector<std::vector<std::vector<std::vector<int>>>> pairwiseDistances_;
+    DistanceTable pairwiseDistances_;
+
+    /** Work done in advance for upcoming changes, if any. */
+    std::unique_ptr<PreparedChanges> preparedChanges_;
 };
 } /* namespace tag */
 
@@ -27,6 +27,14 @@ struct TagOptions : public shared::SharedOptions {
     double failedTagPenalty = 0.0;
     /** Probability the opponent will stay in place. */
     double opponentStayProbability = 0.0;
+    /** The number of moves made by each of the macro-actions, which move repeatedly in a single
+     * direction; 0 => no macro-actions.
+     */
+    long macroActionLength = 0;
+    /** True iff the rotations and reflections that leave the map unchanged should be used to
+     * avoid calculating the same distances and MDP values repeatedly.
+     */
+    bool useMapSymmetries = true;
     /** Path to vrep scene tag.ttt */
     std::string vrepScenePath = "";
 
@@ -51,6 +59,10 @@ struct TagOptions : public shared::SharedOptions {
         parser->addOption<double>("problem", "failedTagPenalty", &TagOptions::failedTagPenalty);
         parser->addOption<double>("problem", "opponentStayProbability",
                 &TagOptions::opponentStayProbability);
+        parser->addOptionWithDefault<long>("problem", "macroActionLength",
+                &TagOptions::macroActionLength, 0);
+        parser->addOptionWithDefault<bool>("problem", "useMapSymmetries",
+                &TagOptions::useMapSymmetries, true);
         parser->addOptionWithDefault<std::string>("ros", "vrepScenePath",
                 &TagOptions::vrepScenePath, "");
     }
@@ -17,6 +17,7 @@
 #include "solver/mappings/observations/discrete_observations.hpp"
 
 #include "TagAction.hpp"
+#include "TagMacroTransition.hpp"
 #include "TagModel.hpp"
 #include "TagObservation.hpp"
 #include "TagState.hpp"                 // for TagState
@@ -149,6 +150,18 @@ void TagTextSerializer::saveAction(solver::Action const *action,
     case ActionType::TAG:
         os << "TAG";
         break;
+    case ActionType::MACRO_NORTH:
+        os << "NORTH*";
+        break;
+    case ActionType::MACRO_EAST:
+        os << "EAST*";
+        break;
+    case ActionType::MACRO_SOUTH:
+        os << "SOUTH*";
+        break;
+    case ActionType::MACRO_WEST:
+        os << "WEST*";
+        break;
     default:
         os << "ERROR-" << static_cast<long>(code);
         break;
@@ -171,6 +184,14 @@ std::unique_ptr<solver::Action> TagTextSerializer::loadAction(
         return std::make_unique<TagAction>(ActionType::WEST);
     } else if (text == "TAG") {
         return std::make_unique<TagAction>(ActionType::TAG);
+    } else if (text == "NORTH*") {
+        return std::make_unique<TagAction>(ActionType::MACRO_NORTH);
+    } else if (text == "EAST*") {
+        return std::make_unique<TagAction>(ActionType::MACRO_EAST);
+    } else if (text == "SOUTH*") {
+        return std::make_unique<TagAction>(ActionType::MACRO_SOUTH);
+    } else if (text == "WEST*") {
+        return std::make_unique<TagAction>(ActionType::MACRO_WEST);
     } else {
         std::string tmpStr;
         std::istringstream sstr(text);
@@ -183,9 +204,36 @@ std::unique_ptr<solver::Action> TagTextSerializer::loadAction(
     }
 }
 
+void TagTextSerializer::saveTransitionParameters(solver::TransitionParameters const *tp,
+        std::ostream &os) {
+    if (tp == nullptr) {
+        return;
+    }
+    TagMacroTransition const &transition = static_cast<TagMacroTransition const &>(*tp);
+    os << "[";
+    saveState(&transition.finalState_, os);
+    os << " " << (transition.sawOpponent_ ? "SEEN" : "UNSEEN") << "]";
+}
+
+std::unique_ptr<solver::TransitionParameters> TagTextSerializer::loadTransitionParameters(
+        std::istream &is) {
+    is >> std::ws;
+    if (is.peek() != '[') {
+        return nullptr;
+    }
+    std::string tpString;
+    std::getline(is, tpString, '[');
+    std::getline(is, tpString, ']');
+    std::istringstream sstr(tpString);
+    std::unique_ptr<solver::State> finalState = loadState(sstr);
+    std::string seenString;
+    sstr >> seenString;
+    return std::make_unique<TagMacroTransition>(static_cast<TagState const &>(*finalState),
+            seenString == "SEEN");
+}
 
 int TagTextSerializer::getActionColumnWidth(){
-    return 5;
+    return 6;
 }
 int TagTextSerializer::getTPColumnWidth() {
     return 0;
@@ -66,6 +66,13 @@ class TagTextSerializer: virtual public solver::TextSerializer,
     void saveAction(solver::Action const *action, std::ostream &os) override;
     std::unique_ptr<solver::Action> loadAction(std::istream &is) override;
 
+    /** Saves the transition parameters of a macro-action, if any; nothing is written otherwise,
+     * so that policies without macro-actions are unchanged.
+     */
+    void saveTransitionParameters(solver::TransitionParameters const *tp,
+            std::ostream &os) override;
+    std::unique_ptr<solver::TransitionParameters> loadTransitionParameters(
+            std::istream &is) override;
 
     virtual int getActionColumnWidth() override;
     virtual int getTPColumnWidth() override;
@@ -24,12 +24,14 @@
 namespace solver {
 ActionNode::ActionNode() :
         parentEntry_(nullptr),
-        observationMap_(nullptr) {
+        observationMap_(nullptr),
+        stepTotalQValues_() {
 }
 
 ActionNode::ActionNode(ActionMappingEntry *parentEntry) :
         parentEntry_(parentEntry),
-        observationMap_(nullptr) {
+        observationMap_(nullptr),
+        stepTotalQValues_() {
 }
 
 // Default destructor
@@ -29,12 +29,14 @@ class Solver;
  * For purposes of customizability most of the work is done in the ActionMapping and
  * ObservationMapping interfaces, which allow for custom approaches to implementing those mappings.
  *
- * This class contains only two fields; a back-pointer to the ActionMappingEntry that owns this
- * action node (and stores relevant statistics), and an ObservationMapping, which is owned by
- * this ActionNode, and stores information about the observations branching out of this node.
+ * This class contains a back-pointer to the ActionMappingEntry that owns this action node (and
+ * stores relevant statistics), and an ObservationMapping, which is owned by this ActionNode, and
+ * stores information about the observations branching out of this node. For n-step backups
+ * (see Options::backupSteps) it also keeps the totals for the shorter returns.
  */
 class ActionNode {
     friend class BeliefNode;
+    friend class Solver;
     friend class TextSerializer;
 
   public:
@@ -79,6 +81,10 @@ class ActionNode {
      * entries, statistics, and subtrees.
      */
     std::unique_ptr<ObservationMapping> observationMap_;
+    /** For n-step backups, the total Q-values of the histories through this action if they
+     * bootstrapped after 1, 2, ..., n - 1 steps; the total for n steps is kept by the parent entry.
+     */
+    std::vector<double> stepTotalQValues_;
 };
 } /* namespace solver */
 
@@ -19,6 +19,11 @@ Solver *Agent::getSolver() const {
     return solver_;
 }
 std::unique_ptr<Action> Agent::getPreferredAction() const {
+    // If the last search from this belief used sequential halving, its choice takes priority.
+    std::unique_ptr<Action> action = solver_->getSelectedAction(currentBelief_);
+    if (action != nullptr) {
+        return action;
+    }
     return currentBelief_->getRecommendedAction();
 }
 BeliefNode *Agent::getCurrentBelief() const {
@@ -39,7 +39,10 @@ public:
 
     /** Returns the solver being used by this agent. */
     Solver *getSolver() const;
-    /** Returns the agent's current choice of action. */
+    /** Returns the agent's current choice of action - this is the choice made by sequential
+     * halving if that was used to search from the current belief, and otherwise the action
+     * recommended by the current belief.
+     */
     std::unique_ptr<Action> getPreferredAction() const;
     /** Returns the current belief of the agent (as a BeliefNode within the solver's belief tree). */
     BeliefNode *getCurrentBelief() const;
@@ -4,6 +4,7 @@
  */
 #include "solver/BeliefNode.hpp"
 
+#include <algorithm>                    // for max
 #include <map>                          // for _Rb_tree_iterator, map<>::iterator, map
 #include <memory>                       // for unique_ptr
 #include <random>                       // for uniform_int_distribution
@@ -24,6 +25,7 @@
 #include "solver/abstract-problem/Action.hpp"                   // for Action
 #include "solver/abstract-problem/HistoricalData.hpp"
 #include "solver/abstract-problem/Observation.hpp"              // for Observation
+#include "solver/abstract-problem/Options.hpp"                  // for Options
 #include "solver/abstract-problem/State.hpp"                    // for State
 
 #include "solver/belief-estimators/estimators.hpp"
@@ -32,6 +34,7 @@
 #include "solver/search/search_interface.hpp"
 
 #include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/ActionMappingEntry.hpp"
 #include "solver/mappings/actions/ActionPool.hpp"
 #include "solver/mappings/observations/ObservationMapping.hpp"
 #include "solver/mappings/observations/ObservationPool.hpp"
@@ -54,7 +57,8 @@ BeliefNode::BeliefNode(long id, ObservationMappingEntry *parentEntry, Solver *so
             nStartingSequences_(0),
             actionMap_(nullptr),
             cachedValues_(),
-            valueEstimator_(nullptr) {
+            valueEstimator_(nullptr),
+            backupValues_() {
 
     // Correctly calculate the depth based on the parent node.
     if (parentEntry_ == nullptr) {
@@ -174,6 +178,39 @@ double BeliefNode::getCachedValue() const {
 }
 void BeliefNode::recalculateValue() {
     valueEstimator_->updateCache();
+
+    // n-step and TD(lambda) backups also need the averages of the sampled returns.
+    Options const *options = solver_->getOptions();
+    if (options->backupSteps > 1) {
+        backupValues_.assign(options->backupSteps, 0);
+        long nVisits = actionMap_->getTotalVisitCount();
+        if (nVisits > 0) {
+            for (ActionMappingEntry const *entry : actionMap_->getVisitedEntries()) {
+                ActionNode const *actionNode = entry->getActionNode();
+                if (actionNode == nullptr) {
+                    continue;
+                }
+                std::vector<double> const &stepTotals = actionNode->stepTotalQValues_;
+                for (unsigned long i = 1; i < backupValues_.size() && i <= stepTotals.size(); i++) {
+                    backupValues_[i] += stepTotals[i - 1];
+                }
+            }
+            for (double &value : backupValues_) {
+                value /= nVisits;
+            }
+        }
+        backupValues_[0] = getCachedValue();
+    } else if (options->backupLambda > 0) {
+        backupValues_.assign(1, (1 - options->backupLambda) * getCachedValue()
+                + options->backupLambda * estimators::average(this));
+    }
+}
+std::vector<double> BeliefNode::getBackupValues() const {
+    if (backupValues_.empty()) {
+        long nValues = std::max(solver_->getOptions()->backupSteps, 1L);
+        return std::vector<double>(nValues, getCachedValue());
+    }
+    return backupValues_;
 }
 
 /* -------------------- Core tree-related methods  ---------------------- */
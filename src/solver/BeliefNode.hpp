@@ -13,6 +13,7 @@
 #include <memory>                       // for unique_ptr
 #include <set>
 #include <utility>                      // for pair
+#include <vector>                       // for vector
 
 #include "global.hpp"                     // for RandomGenerator
 #include "RandomAccessSet.hpp"
@@ -130,6 +131,14 @@ public:
     double getCachedValue() const;
     /** Recalculates the cached value for this belief node. */
     void recalculateValue();
+    /** Returns the values that the histories continuing from this belief contribute to the
+     * Q-value totals of its parent action, as of the last call to recalculateValue(); these are
+     * the totals for 1, 2, ..., backupSteps steps (see Options::backupSteps and
+     * Options::backupLambda).
+     *
+     * For the usual backups this is just the cached value.
+     */
+    std::vector<double> getBackupValues() const;
 
 
     /* -------------------- Core tree-related methods  ---------------------- */
@@ -180,6 +189,8 @@ private:
     std::unordered_map<BaseCachedValue const *, std::unique_ptr<BaseCachedValue>> cachedValues_;
     /** Calculates and caches the estimated value of this node. */
     CachedValue<double> *valueEstimator_;
+    /** The cached backup values, for n-step and TD(lambda) backups only. */
+    std::vector<double> backupValues_;
 };
 } /* namespace solver */
 
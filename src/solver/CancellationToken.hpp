@@ -0,0 +1,50 @@
+/** @file CancellationToken.hpp
+ *
+ * Defines the CancellationToken class, which allows a search to be interrupted from another
+ * thread.
+ */
+#ifndef SOLVER_CANCELLATIONTOKEN_HPP_
+#define SOLVER_CANCELLATIONTOKEN_HPP_
+
+#include <atomic>
+
+#include "global.hpp"
+
+namespace solver {
+/** A thread-safe flag that can be used to ask a running search to stop early.
+ *
+ * The solver checks the token once per step of history generation; when the token is cancelled
+ * the current history is finished off with a heuristic estimate and backed up as usual, so the
+ * tree is left in a consistent state.
+ *
+ * Cancelling is sticky - the token stays cancelled (and any further calls to improvePolicy()
+ * return immediately) until reset() is called.
+ */
+class CancellationToken {
+public:
+    CancellationToken() :
+            isCancelled_(false) {
+    }
+    ~CancellationToken() = default;
+    _NO_COPY_OR_MOVE(CancellationToken);
+
+    /** Asks any search using this token to stop as soon as possible. */
+    void cancel() {
+        isCancelled_.store(true, std::memory_order_release);
+    }
+    /** Clears the cancellation, so that searches can run normally again. */
+    void reset() {
+        isCancelled_.store(false, std::memory_order_release);
+    }
+    /** Returns true iff cancel() has been called since the last reset(). */
+    bool isCancelled() const {
+        return isCancelled_.load(std::memory_order_acquire);
+    }
+
+private:
+    /** True iff the token has been cancelled. */
+    std::atomic<bool> isCancelled_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_CANCELLATIONTOKEN_HPP_ */
@@ -25,6 +25,7 @@ HistoryEntry::HistoryEntry(HistorySequence* owningSequence, HistoryEntry::IdType
     transitionParameters_(nullptr),
     observation_(nullptr),
     immediateReward_(0),
+    cumulativeReward_(0),
     entryId_(entryId),
     changeFlags_(ChangeFlags::UNCHANGED) {
 }
@@ -39,6 +40,9 @@ HistoryEntry::IdType HistoryEntry::getId() const {
 double HistoryEntry::getImmediateReward() const {
     return immediateReward_;
 }
+double HistoryEntry::getCumulativeReward() const {
+    return cumulativeReward_;
+}
 State const *HistoryEntry::getState() const {
     return stateInfo_->getState();
 }
@@ -57,6 +61,9 @@ TransitionParameters const *HistoryEntry::getTransitionParameters() const {
 BeliefNode *HistoryEntry::getAssociatedBeliefNode() const {
     return associatedBeliefNode_;
 }
+HistorySequence *HistoryEntry::getOwningSequence() const {
+    return owningSequence_;
+}
 
 
 /* ============================ PRIVATE ============================ */
@@ -87,6 +87,8 @@ public:
     TransitionParameters const *getTransitionParameters() const;
     /** Returns the belief node associated with this history entry. */
     BeliefNode *getAssociatedBeliefNode() const;
+    /** Returns the history sequence that owns this entry. */
+    HistorySequence *getOwningSequence() const;
 
 private:
     /* ----------------- Change flagging ------------------- */
@@ -120,6 +122,10 @@ private:
     std::unique_ptr<Observation> observation_;
     /** Non-discounted reward. */
     double immediateReward_;
+    /** The discounted sum of the rewards from this entry to the end of the sequence.
+     * This is kept up to date by HistorySequence::updateCumulativeRewards().
+     */
+    double cumulativeReward_;
 
     /** The id of the specific entry within the sequence. */
     IdType entryId_;
@@ -18,6 +18,8 @@
 #include "solver/StateInfo.hpp"                // for StateInfo
 
 #include "solver/abstract-problem/Action.hpp"                   // for Action
+#include "solver/abstract-problem/Model.hpp"                    // for Model
+#include "solver/abstract-problem/Options.hpp"                  // for Options
 #include "solver/abstract-problem/Observation.hpp"              // for Observation
 
 #include "solver/changes/ChangeFlags.hpp"               // for ChangeFlags, ChangeFlags::UNCHANGED
@@ -30,6 +32,7 @@ HistorySequence::HistorySequence() :
 HistorySequence::HistorySequence(long id) :
     id_(id),
     entrySequence_(),
+    openLoopEntryId_(-1),
     startAffectedIdx_(std::numeric_limits<long>::max()),
     endAffectedIdx_(-1),
     changeFlags_(ChangeFlags::UNCHANGED) {
@@ -55,6 +58,9 @@ HistoryEntry *HistorySequence::getFirstEntry() const {
 HistoryEntry *HistorySequence::getLastEntry() const {
     return entrySequence_.back().get();
 }
+long HistorySequence::getOpenLoopEntryId() const {
+    return openLoopEntryId_;
+}
 std::vector<State const *> HistorySequence::getStates() const {
     std::vector<State const *> states;
     for (std::unique_ptr<HistoryEntry> const &entry : entrySequence_) {
@@ -75,6 +81,9 @@ void HistorySequence::erase(HistoryEntry::IdType firstEntryId) {
         (*it)->registerState(nullptr);
     }
     entrySequence_.erase(entrySequence_.begin() + firstEntryId, entrySequence_.end());
+    if (openLoopEntryId_ >= firstEntryId) {
+        openLoopEntryId_ = -1;
+    }
 }
 
 HistoryEntry *HistorySequence::addEntry() {
@@ -115,4 +124,27 @@ void HistorySequence::addAffectedIndex(HistoryEntry::IdType entryId) {
         endAffectedIdx_ = entryId;
     }
 }
+
+/* -------------- Cumulative reward updates ---------------- */
+void HistorySequence::updateCumulativeRewards(Model *model, long lastChangedEntryId) {
+    long lastEntryId = getLength() - 1;
+    if (lastChangedEntryId < 0 || lastChangedEntryId > lastEntryId) {
+        lastChangedEntryId = lastEntryId;
+    }
+    // Everything after the last changed entry still has the correct value.
+    double cumulativeReward = 0;
+    if (lastChangedEntryId < lastEntryId) {
+        cumulativeReward = entrySequence_[lastChangedEntryId + 1]->cumulativeReward_;
+    }
+    for (long entryId = lastChangedEntryId; entryId >= 0; entryId--) {
+        HistoryEntry &entry = *entrySequence_[entryId];
+        // The last entry may have no action, but nothing follows it anyway.
+        double discountFactor = model->getOptions()->discountFactor;
+        if (entry.action_ != nullptr) {
+            discountFactor = model->getDiscountFactor(*entry.action_);
+        }
+        cumulativeReward = entry.immediateReward_ + discountFactor * cumulativeReward;
+        entry.cumulativeReward_ = cumulativeReward;
+    }
+}
 } /* namespace solver */
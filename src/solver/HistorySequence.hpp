@@ -25,6 +25,7 @@
 namespace solver {
 class BeliefNode;
 class BeliefTree;
+class Model;
 class StateInfo;
 
 /** Represents a single history sequence.
@@ -66,6 +67,11 @@ class HistorySequence {
     HistoryEntry *getLastEntry() const;
     /** Returns the states in this sequence as a vector. */
     std::vector<State const *> getStates() const;
+    /** Returns the ID of the first entry whose observation was replaced during open-loop search,
+     * or -1 if there is no such entry. The entries after it are not necessarily consistent with
+     * the observations of the belief nodes they are associated with.
+     */
+    long getOpenLoopEntryId() const;
 
   private:
     /* ----------- Methods to add or remove history entries ------------- */
@@ -86,6 +92,14 @@ class HistorySequence {
     /** Adds the given index as one of those affected by changes. */
     void addAffectedIndex(HistoryEntry::IdType entryId);
 
+    /* -------------- Cumulative reward updates ---------------- */
+    /** Recalculates the cumulative discounted rewards of the entries in this sequence, assuming
+     * that no entry after lastChangedEntryId has changed (-1 => recalculate the whole sequence).
+     *
+     * The discount across each entry is given by the model (see Model::getDiscountFactor()).
+     */
+    void updateCumulativeRewards(Model *model, long lastChangedEntryId = -1);
+
   private:
     /** The ID of this sequence. */
     long id_;
@@ -93,6 +107,9 @@ class HistorySequence {
     /** The actual sequence of history entries. */
     std::vector<std::unique_ptr<HistoryEntry>> entrySequence_;
 
+    /** The ID of the first entry whose observation was replaced during open-loop search. */
+    long openLoopEntryId_;
+
     /** The start and end of where this sequence is affected by changes. */
     long startAffectedIdx_, endAffectedIdx_;
     /** The types of changes that have affected this sequence. */
@@ -4,6 +4,7 @@
  */
 #include "solver/Simulator.hpp"
 
+#include <chrono>                       // for steady_clock
 #include <fstream>                      // for operator<<, basic_ostream, basic_ostream<>::__ostream_type, ofstream, endl, ostream, ifstream
 #include <iomanip>
 #include <iostream>                     // for operator<<, ostream, basic_ostream, endl, basic_ostream<>::__ostream_type, cout
@@ -11,11 +12,13 @@
 #include "solver/abstract-problem/Observation.hpp"
 #include "solver/abstract-problem/ModelChange.hpp"
 
+#include "solver/search/search_interface.hpp"
 #include "solver/serialization/Serializer.hpp"
 
 #include "solver/Agent.hpp"
 #include "solver/BeliefNode.hpp"
 #include "solver/BeliefTree.hpp"
+#include "solver/CancellationToken.hpp"
 #include "solver/HistoryEntry.hpp"
 #include "solver/HistorySequence.hpp"
 #include "solver/Solver.hpp"
@@ -36,18 +39,31 @@ Simulator::Simulator(std::unique_ptr<Model> model, Solver *solver, bool hasDynam
         changeSequence_(),
         stepCount_(0),
         maxStepCount_(100),
+        cancellationToken_(nullptr),
         currentDiscount_(1.0),
         totalDiscountedReward_(0.0),
         actualHistory_(std::make_unique<HistorySequence>()),
         totalChangingTime_(0.0),
+        totalPreparingTime_(0.0),
+        preparingThread_(),
+        preparingTime_(0.0),
         totalReplenishingTime_(0.0),
         totalImprovementTime_(0.0),
-        totalPruningTime_(0.0) {
+        totalPruningTime_(0.0),
+        initialNumberOfDeprivations_(solver_->getNumberOfDeprivations()),
+        searchParameters_() {
     std::unique_ptr<State> initialState = model_->sampleAnInitState();
     StateInfo *initInfo = solver_->getStatePool()->createOrGetInfo(*initialState);
     HistoryEntry *newEntry = actualHistory_->addEntry();
     newEntry->stateInfo_ = initInfo;
 }
+Simulator::~Simulator() {
+    finishPreparingChanges();
+    if (cancellationToken_ != nullptr) {
+        // The solver may outlive the token.
+        solver_->setCancellationToken(nullptr);
+    }
+}
 Model *Simulator::getModel() const {
     return model_.get();
 }
@@ -74,6 +90,9 @@ long Simulator::getStepCount() const {
 double Simulator::getTotalChangingTime() const {
     return totalChangingTime_;
 }
+double Simulator::getTotalPreparingTime() const {
+    return totalPreparingTime_;
+}
 double Simulator::getTotalReplenishingTime() const {
     return totalReplenishingTime_;
 }
@@ -83,10 +102,22 @@ double Simulator::getTotalImprovementTime() const {
 double Simulator::getTotalPruningTime() const {
     return totalPruningTime_;
 }
+long Simulator::getNumberOfDeprivations() const {
+    return solver_->getNumberOfDeprivations() - initialNumberOfDeprivations_;
+}
+std::vector<std::string> const &Simulator::getSearchParameters() const {
+    return searchParameters_;
+}
 
 
 void Simulator::setChangeSequence(ChangeSequence sequence) {
+    // Any preparation in progress refers to the old sequence.
+    finishPreparingChanges();
     changeSequence_ = std::move(sequence);
+    ChangeSequence::iterator iter = changeSequence_.find(stepCount_);
+    if (iter != changeSequence_.end()) {
+        startPreparingChanges(iter->second);
+    }
 }
 void Simulator::loadChangeSequence(std::string path) {
     std::ifstream ifs(path);
@@ -96,9 +127,17 @@ void Simulator::loadChangeSequence(std::string path) {
 void Simulator::setMaxStepCount(long maxStepCount) {
     maxStepCount_ = maxStepCount;
 }
+void Simulator::setCancellationToken(CancellationToken const *token) {
+    cancellationToken_ = token;
+    solver_->setCancellationToken(token);
+}
+bool Simulator::isCancelled() const {
+    return cancellationToken_ != nullptr && cancellationToken_->isCancelled();
+}
 double Simulator::runSimulation() {
     while (stepSimulation()) {
     }
+    finishPreparingChanges();
     if (options_->hasVerboseOutput) {
         cout << endl << endl << "Final State:" << endl;
         State const &currentState = *getCurrentState();
@@ -114,6 +153,8 @@ bool Simulator::stepSimulation() {
         return false;
     } else if (model_->isTerminal(*getCurrentState())) {
         return false;
+    } else if (isCancelled()) {
+        return false;
     }
 
     std::stringstream prevStream;
@@ -158,6 +199,12 @@ bool Simulator::stepSimulation() {
         }
     }
 
+    // If there are changes at the next step, we can prepare for them while the solver searches.
+    ChangeSequence::iterator nextIter = changeSequence_.find(stepCount_ + 1);
+    if (nextIter != changeSequence_.end() && stepCount_ + 1 < maxStepCount_) {
+        startPreparingChanges(nextIter->second);
+    }
+
     double impSolTimeStart = tapir::clock_ms();
     if (currentBelief == solver_->getPolicy()->getRoot()) {
     	solver_->improvePolicy();
@@ -165,6 +212,8 @@ bool Simulator::stepSimulation() {
     	solver_->improvePolicy(currentBelief);
     }
     totalImprovementTime_ += (tapir::clock_ms() - impSolTimeStart);
+    std::ostringstream parameterStream;
+    solver_->getSearchStrategy()->printParameters(parameterStream);
 
     if (options_->hasVerboseOutput) {
         std::stringstream newStream;
@@ -225,16 +274,18 @@ bool Simulator::stepSimulation() {
         }
     }
 
+    double discountFactor = model_->getDiscountFactor(*result.action);
     currentEntry->action_ = std::move(result.action);
     currentEntry->observation_ = std::move(result.observation);
     currentEntry->immediateReward_ = result.reward;
     currentEntry->transitionParameters_ = std::move(result.transitionParameters);
+    searchParameters_.push_back(parameterStream.str());
     StateInfo *nextInfo = solver_->getStatePool()->createOrGetInfo(*result.nextState);
     currentEntry = actualHistory_->addEntry();
     currentEntry->stateInfo_ = nextInfo;
 
     totalDiscountedReward_ += currentDiscount_ * result.reward;
-    currentDiscount_ *= options_->discountFactor;
+    currentDiscount_ *= discountFactor;
     stepCount_++;
 
     if (currentBelief->getNumberOfParticles() == 0) {
@@ -245,8 +296,47 @@ bool Simulator::stepSimulation() {
     return !result.isTerminal;
 }
 
+void Simulator::startPreparingChanges(std::vector<std::unique_ptr<ModelChange>> const &changes) {
+    finishPreparingChanges();
+
+    // The pool can't be read while the search adds to it, so the existing states are listed now.
+    Solver *solver = nullptr;
+    std::vector<StateInfo *> states;
+    if (!options_->resetOnChanges) {
+        solver = solver_;
+        StatePool *pool = solver_->getStatePool();
+        long nStates = pool->getNumberOfStates();
+        states.reserve(nStates);
+        for (long index = 0; index < nStates; index++) {
+            states.push_back(pool->getInfoById(index));
+        }
+    }
+
+    preparingThread_ = std::thread([this, &changes, solver, states]() {
+        // The clock used elsewhere measures the CPU time of the whole process, which would
+        // include the search running alongside.
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        model_->prepareChanges(changes, nullptr, std::vector<StateInfo *>());
+        solverModel_->prepareChanges(changes, solver, states);
+        preparingTime_ = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - startTime).count();
+    });
+}
+
+void Simulator::finishPreparingChanges() {
+    if (preparingThread_.joinable()) {
+        preparingThread_.join();
+        totalPreparingTime_ += preparingTime_;
+    }
+}
+
 bool Simulator::handleChanges(std::vector<std::unique_ptr<ModelChange>> const &changes,
         bool areDynamic, bool resetTree) {
+    // The models can't be changed while they are still preparing; any wait is part of the cost.
+    double waitingTimeStart = tapir::clock_ms();
+    finishPreparingChanges();
+    totalChangingTime_ += tapir::clock_ms() - waitingTimeStart;
+
     if (!resetTree) {
         // Set the change root appropriately.
         if (areDynamic) {
@@ -5,6 +5,10 @@
 #ifndef SOLVER_SIMULATOR_HPP_
 #define SOLVER_SIMULATOR_HPP_
 
+#include <string>                       // for string
+#include <thread>                       // for thread
+#include <vector>                       // for vector
+
 #include "global.hpp"
 
 #include "solver/Agent.hpp"
@@ -17,9 +21,11 @@
 #include "solver/abstract-problem/State.hpp"
 
 namespace solver {
+class CancellationToken;
 class HistorySequence;
 class Model;
 class Solver;
+class StateInfo;
 
 /** A class for running simulations to test the performance of ABT.
  *
@@ -47,7 +53,7 @@ public:
      * be updated based on the new changes.
      */
     Simulator(std::unique_ptr<Model> model, Solver *solver, bool hasDynamicChanges);
-    ~Simulator() = default;
+    ~Simulator();
     _NO_COPY_OR_MOVE(Simulator);
 
     /** Returns the model used by the simulator. */
@@ -68,6 +74,10 @@ public:
 
     /** Returns the total time spent on changes to the solver's model and policy. */
     double getTotalChangingTime() const;
+    /** Returns the total (wall-clock) time spent preparing in advance for upcoming changes; this
+     * is done in the background, so it is not part of any of the other times.
+     */
+    double getTotalPreparingTime() const;
     /** Returns the total time spent replenishing particles. */
     double getTotalReplenishingTime() const;
     /** Returns the total time spent on straight improvements to the policy (i.e. generating new
@@ -76,6 +86,15 @@ public:
     double getTotalImprovementTime() const;
     /** Returns the total time spent on pruning the tree. */
     double getTotalPruningTime() const;
+    /** Returns the number of times during this simulation that particles could not be
+     * generated from the previous belief (see Solver::getNumberOfDeprivations()).
+     */
+    long getNumberOfDeprivations() const;
+    /** Returns, for each step, the search parameters the solver's search strategy had settled on
+     * by the end of its search (see SearchStrategy::printParameters()); these are empty if the
+     * strategy doesn't adapt its parameters.
+     */
+    std::vector<std::string> const &getSearchParameters() const;
 
     /** Sets a sequence of changes to be used for this simulation. */
     void setChangeSequence(ChangeSequence sequence);
@@ -84,6 +103,15 @@ public:
 
     /** Sets the maximum step count for this simulator to the given number. */
     void setMaxStepCount(long maxStepCount);
+    /** Sets a token that interrupts the simulation (nullptr => the simulation can't be
+     * interrupted); the token is passed on to the solver (see Solver::setCancellationToken()).
+     *
+     * Once the token is cancelled, the search in progress stops early and the step it belongs
+     * to acts on the policy as it stands; no further steps are taken after that.
+     */
+    void setCancellationToken(CancellationToken const *token);
+    /** Returns true iff the simulation has been interrupted via its cancellation token. */
+    bool isCancelled() const;
 
     /** Runs a full simulation, returning the total discounted reward. */
     double runSimulation();
@@ -102,6 +130,13 @@ public:
             bool areDynamic = true, bool resetTree = false);
 
 private:
+    /** Starts a background thread that lets both models prepare in advance for the given
+     * changes, which are due to be handled at the start of the next step.
+     */
+    void startPreparingChanges(std::vector<std::unique_ptr<ModelChange>> const &changes);
+    /** Waits for the preparation in progress, if any, to finish. */
+    void finishPreparingChanges();
+
     /** The simulator's model, which is used to generate the actual simulation history. */
     std::unique_ptr<Model> model_;
     /** The solver being tested. */
@@ -123,6 +158,8 @@ private:
     long stepCount_;
     /** The maximum number of simulation steps to take. */
     long maxStepCount_;
+    /** The token that interrupts the simulation, if any. */
+    CancellationToken const *cancellationToken_;
     /** The current cumulative discount. */
     double currentDiscount_;
     /** The total discounted reward. */
@@ -132,12 +169,22 @@ private:
 
     /** The total time spent on changes to the solver's model and policy. */
     double totalChangingTime_;
+    /** The total time spent preparing in advance for upcoming changes. */
+    double totalPreparingTime_;
+    /** The thread preparing for upcoming changes, if any. */
+    std::thread preparingThread_;
+    /** The time taken by the latest preparation; only valid once its thread has finished. */
+    double preparingTime_;
     /** The total time spent on replenishing particles. */
     double totalReplenishingTime_;
     /** The total time spent on improving the policy, via new histories. */
     double totalImprovementTime_;
     /** The total time spent on pruning the tree. */
     double totalPruningTime_;
+    /** The solver's deprivation count at the start of this simulation. */
+    long initialNumberOfDeprivations_;
+    /** The search parameters for each step. */
+    std::vector<std::string> searchParameters_;
 };
 } /* namespace solver */
 
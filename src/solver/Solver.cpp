@@ -8,6 +8,7 @@
 #include <cstdio>
 
 #include <algorithm>                    // for max
+#include <functional>                   // for function
 #include <iostream>                     // for operator<<, ostream, basic_ostream, endl, basic_ostream<>::__ostream_type, cout
 #include <limits>
 #include <memory>                       // for unique_ptr
@@ -21,6 +22,7 @@
 #include "global.hpp"                     // for RandomGenerator
 
 #include "solver/abstract-problem/Action.hpp"                   // for Action
+#include "solver/abstract-problem/DiscretizedPoint.hpp"
 #include "solver/abstract-problem/Model.hpp"                    // for Model::StepResult, Model
 #include "solver/abstract-problem/ModelChange.hpp"                    // for Model::StepResult, Model
 #include "solver/abstract-problem/Observation.hpp"              // for Observation
@@ -32,7 +34,9 @@
 #include "solver/changes/HistoryCorrector.hpp"
 
 #include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/ActionMappingEntry.hpp"
 #include "solver/mappings/actions/ActionPool.hpp"
+#include "solver/mappings/actions/discretized_actions.hpp"
 #include "solver/mappings/observations/ObservationMapping.hpp"
 #include "solver/mappings/observations/ObservationPool.hpp"
 
@@ -47,11 +51,13 @@
 #include "solver/ActionNode.hpp"               // for BeliefNode, BeliefNode::startTime
 #include "solver/BeliefNode.hpp"               // for BeliefNode, BeliefNode::startTime
 #include "solver/BeliefTree.hpp"               // for BeliefTree
+#include "solver/CancellationToken.hpp"
 #include "solver/Histories.hpp"                // for Histories
 #include "solver/HistoryEntry.hpp"             // for HistoryEntry
 #include "solver/HistorySequence.hpp"          // for HistorySequence
 #include "solver/StateInfo.hpp"                // for StateInfo
 #include "solver/StatePool.hpp"                // for StatePool
+#include "solver/ThreadPool.hpp"
 
 using std::cout;
 using std::endl;
@@ -70,6 +76,14 @@ Solver::Solver(std::unique_ptr<Model> model) :
             searchStrategy_(nullptr),
             recommendationStrategy_(nullptr),
             estimationStrategy_(nullptr),
+            cancellationToken_(nullptr),
+            forcedActionNode_(nullptr),
+            forcedAction_(nullptr),
+            selectedActionNode_(nullptr),
+            selectedAction_(nullptr),
+            hasWarnedAboutHalving_(false),
+            numberOfDeprivations_(0),
+            replenishingPool_(nullptr),
             nodesToBackup_(),
             changeRoot_(nullptr),
             isAffectedMap_() {
@@ -101,6 +115,9 @@ ObservationPool *Solver::getObservationPool() const {
 EstimationStrategy *Solver::getEstimationStrategy() const {
     return estimationStrategy_.get();
 }
+SearchStrategy *Solver::getSearchStrategy() const {
+    return searchStrategy_.get();
+}
 SelectRecommendedActionStrategy* Solver::getRecommendationStrategy() const {
 	return recommendationStrategy_.get();
 }
@@ -125,6 +142,9 @@ void Solver::initializeEmpty() {
 void Solver::improvePolicy(BeliefNode *startNode, long numberOfHistories, long maximumDepth,
         double timeout) {
     double startTime = tapir::clock_ms();
+    // Any previous sequential halving choice is out of date once the policy changes.
+    selectedActionNode_ = nullptr;
+    selectedAction_ = nullptr;
     if (numberOfHistories < 0) {
         numberOfHistories = options_->historiesPerStep;
     }
@@ -159,16 +179,59 @@ void Solver::improvePolicy(BeliefNode *startNode, long numberOfHistories, long m
             startTime + timeout);
     double totalTimeTaken = tapir::clock_ms() - startTime;
     if (options_->hasVerboseOutput) {
-        cout << actualNumHistories << " histories in " << totalTimeTaken << "ms." << endl;
+        cout << actualNumHistories << " histories in " << totalTimeTaken << "ms.";
+        if (isCancelled()) {
+            cout << " (cancelled)";
+        }
+        cout << endl;
     }
 }
 
+void Solver::setCancellationToken(CancellationToken const *token) {
+    cancellationToken_ = token;
+}
+
+bool Solver::isCancelled() const {
+    return cancellationToken_ != nullptr && cancellationToken_->isCancelled();
+}
+
+Action const *Solver::getForcedAction(BeliefNode const *node) const {
+    if (node != forcedActionNode_) {
+        return nullptr;
+    }
+    return forcedAction_.get();
+}
+
+std::unique_ptr<Action> Solver::getSelectedAction(BeliefNode const *node) const {
+    if (node != selectedActionNode_ || selectedAction_ == nullptr) {
+        return nullptr;
+    }
+    return selectedAction_->copy();
+}
+
 BeliefNode *Solver::replenishChild(BeliefNode *currNode, Action const &action,
         Observation const &obs, long minParticleCount) {
+    bool isUsingKld = minParticleCount < 0 && options_->useKldSampling;
     if (minParticleCount < 0) {
         minParticleCount = options_->minParticleCount;
     }
     BeliefNode *nextNode = currNode->createOrGetChild(action, obs);
+    if (options_->openLoopDepth > 0) {
+        // Open-loop particles are not consistent with the actual observation.
+        long nSequencesDeleted = pruneOpenLoopSequences(nextNode);
+        if (options_->hasVerboseOutput && nSequencesDeleted > 0) {
+            cout << "Pruned " << nSequencesDeleted << " open-loop sequences." << endl;
+        }
+    }
+
+    // For KLD-sampling, the required count depends on how many bins the particles occupy.
+    std::unordered_set<std::size_t> bins;
+    if (isUsingKld) {
+        for (HistoryEntry *entry : nextNode->particles_) {
+            bins.insert(model_->getParticleBin(*entry->getState()));
+        }
+        minParticleCount = getKldParticleCount(bins.size());
+    }
     long particleCount = nextNode->getNumberOfParticles();
     long deficit = minParticleCount - particleCount;
     if (deficit <= 0) {
@@ -189,36 +252,75 @@ BeliefNode *Solver::replenishChild(BeliefNode *currNode, Action const &action,
         }
     }
 
-    // Attempt to generate particles for next state based on the current belief,
-    // the observation, and the action.
-    std::vector<std::unique_ptr<State>> nextParticles = (model_->generateParticles(currNode, action,
-            obs, deficit, particles));
-    if (nextParticles.empty()) {
-        debug::show_message("WARNING: Could not generate based on belief!");
-        // If that fails, ignore the current belief.
-        nextParticles = model_->generateParticles(currNode, action, obs, deficit);
-    }
-    if (nextParticles.empty()) {
-        debug::show_message("ERROR: Failed to generate new particles!");
-        return nullptr;
-    }
+    bool isDeprived = false;
+    while (deficit > 0) {
+        // With KLD-sampling the bound is re-checked after each batch, so the batches shouldn't be
+        // too small - models that generate particles in proportion to their weights may round a
+        // small request down to nothing.
+        long batchSize = deficit;
+        if (isUsingKld) {
+            batchSize = std::max(deficit, static_cast<long>(options_->kldMinParticleCount));
+        }
 
-    for (std::unique_ptr<State> &uniqueStatePtr : nextParticles) {
-        StateInfo *stateInfo = statePool_->createOrGetInfo(*uniqueStatePtr);
+        // Attempt to generate particles for next state based on the current belief,
+        // the observation, and the action.
+        std::vector<std::unique_ptr<State>> nextParticles;
+        if (!isDeprived) {
+            nextParticles = generateParticles(currNode, action, obs, batchSize, &particles);
+        }
+        if (nextParticles.empty()) {
+            if (!isDeprived) {
+                debug::show_message("WARNING: Could not generate based on belief!");
+                isDeprived = true;
+                numberOfDeprivations_++;
+            }
+            // If that fails, ignore the current belief.
+            nextParticles = generateParticles(currNode, action, obs, batchSize, nullptr);
+        }
+        if (nextParticles.empty()) {
+            debug::show_message("ERROR: Failed to generate new particles!");
+            return nullptr;
+        }
+        if (options_->rejuvenationSteps > 0) {
+            rejuvenateParticles(nextNode, nextParticles);
+        }
 
-        // Create a new history sequence and entry for the new particle.
-        HistorySequence *histSeq = histories_->createSequence();
-        HistoryEntry *histEntry = histSeq->addEntry();
-        histEntry->registerState(stateInfo);
-        histEntry->registerNode(nextNode);
+        for (std::unique_ptr<State> &uniqueStatePtr : nextParticles) {
+            StateInfo *stateInfo = statePool_->createOrGetInfo(*uniqueStatePtr);
+
+            // Create a new history sequence and entry for the new particle.
+            HistorySequence *histSeq = histories_->createSequence();
+            HistoryEntry *histEntry = histSeq->addEntry();
+            histEntry->registerState(stateInfo);
+            histEntry->registerNode(nextNode);
+            if (isUsingKld) {
+                bins.insert(model_->getParticleBin(*stateInfo->getState()));
+            }
+        }
+        particleCount += nextParticles.size();
+        if (!isUsingKld) {
+            break;
+        }
+
+        // New particles can occupy new bins, which may raise the KLD-sampling bound.
+        minParticleCount = getKldParticleCount(bins.size());
+        deficit = minParticleCount - particleCount;
     }
     if (options_->hasVerboseOutput) {
-        cout << "Done" << std::endl;
+        cout << "Done (" << particleCount << " particles)" << std::endl;
     }
     return nextNode;
 }
 
+long Solver::getNumberOfDeprivations() const {
+    return numberOfDeprivations_;
+}
+
 void Solver::resetTree(BeliefNode *newRoot) {
+    model_->resetRoot(newRoot);
+
+    selectedActionNode_ = nullptr;
+    selectedAction_ = nullptr;
     changeRoot_ = nullptr;
     isAffectedMap_.clear();
     nodesToBackup_.clear();
@@ -248,6 +350,9 @@ void Solver::resetTree(BeliefNode *newRoot) {
     for (std::unique_ptr<StateInfo> const &info : statePool_->statesByIndex_) {
         info->usedInHistoryEntries_.clear();
     }
+    // The model may have changed without any states being flagged, so the memoized transitions
+    // can't be trusted any more.
+    statePool_->clearCachedTransitions();
 
     // Now fill the re-created belief node with the particles from the old one.
     for (StateInfo *info : allParticles) {
@@ -295,6 +400,8 @@ long Solver::pruneSiblings(BeliefNode *node) {
 }
 
 long Solver::pruneSubtree(BeliefNode *root) {
+    selectedActionNode_ = nullptr;
+    selectedAction_ = nullptr;
     // Delete all history sequences going into this subtree.
     long nSequencesDeleted = 0;
     for (HistoryEntry *entry : root->particles_) {
@@ -311,6 +418,29 @@ long Solver::pruneSubtree(BeliefNode *root) {
     return nSequencesDeleted;
 }
 
+/* ------------------- Step generation ------------------- */
+Model::StepResult Solver::generateStep(HistoryEntry const *entry, State const &state,
+        Action const &action) {
+    if (entry == nullptr || !model_->hasDeterministicTransitions()) {
+        return model_->generateStep(state, action);
+    }
+
+    StateInfo const *stateInfo = entry->getStateInfo();
+    long actionBinNumber = static_cast<DiscretizedPoint const &>(action).getBinNumber();
+    StateInfo *nextStateInfo = statePool_->getCachedTransition(stateInfo, actionBinNumber);
+    if (nextStateInfo != nullptr) {
+        Model::StepResult result = model_->generateStepToState(state, action,
+                *nextStateInfo->getState());
+        result.nextStateInfo = nextStateInfo;
+        return result;
+    }
+
+    Model::StepResult result = model_->generateStep(state, action);
+    result.nextStateInfo = statePool_->createOrGetInfo(*result.nextState);
+    statePool_->cacheTransition(stateInfo, actionBinNumber, result.nextStateInfo);
+    return result;
+}
+
 /* ------------------- Change handling methods ------------------- */
 BeliefNode *Solver::getChangeRoot() const {
     return changeRoot_;
@@ -375,6 +505,8 @@ bool Solver::isAffected(BeliefNode const *node) {
 }
 
 void Solver::applyChanges() {
+    selectedActionNode_ = nullptr;
+    selectedAction_ = nullptr;
     std::unordered_set<HistorySequence *> affectedSequences;
     for (StateInfo *stateInfo : statePool_->getAffectedStates()) {
         if (changes::has_flags(stateInfo->changeFlags_, ChangeFlags::DELETED)) {
@@ -551,16 +683,20 @@ void Solver::doBackup() {
             if (depth == 0) {
                 node->recalculateValue();
             } else {
-                double oldQValue = node->getCachedValue();
+                std::vector<double> oldValues = node->getBackupValues();
                 node->recalculateValue();
-                double deltaQValue = node->getCachedValue() - oldQValue;
+                std::vector<double> deltaTotalQ = node->getBackupValues();
                 long nContinuations = node->getMapping()->getTotalVisitCount()
                         - node->getNumberOfStartingSequences();
-                double deltaTotalQ = options_->discountFactor * nContinuations * deltaQValue;
-
                 ActionMappingEntry *parentActionEntry =
                         node->getParentActionNode()->getParentEntry();
-                if (parentActionEntry->update(0, deltaTotalQ)) {
+                double discountFactor = getDiscountFactor(parentActionEntry);
+                for (unsigned long i = 0; i < deltaTotalQ.size(); i++) {
+                    deltaTotalQ[i] = discountFactor * nContinuations
+                            * (deltaTotalQ[i] - oldValues[i]);
+                }
+
+                if (updateTotalQValues(parentActionEntry, 0, deltaTotalQ)) {
                     addNodeToBackup(parentActionEntry->getMapping()->getOwner());
                 }
             }
@@ -573,34 +709,45 @@ void Solver::doBackup() {
 /* ------------------ Methods to update the q-values in the tree. ------------------- */
 void Solver::updateSequence(HistorySequence *sequence, int sgn, long firstEntryId,
         bool propagateQChanges) {
+    // A positive backup means the rewards are current, so the cumulative rewards can be updated.
+    if (sgn > 0) {
+        sequence->updateCumulativeRewards(model_.get());
+    }
+
     // Cannot update sequences of length <= 1.
     if (sequence->getLength() <= 1) {
         return;
     }
 
-    double discountFactor = options_->discountFactor;
-
 
     // Traverse the sequence in reverse.
     auto it = sequence->entrySequence_.crbegin();
 
     // The last entry is used only for the heuristic estimate.
-    double deltaTotalQ = (*it)->immediateReward_;
+    // For n-step backups there is one total for each number of steps, but they all start the same.
+    std::vector<double> deltaTotalQ(std::max(options_->backupSteps, 1L),
+            (*it)->immediateReward_);
+    std::vector<double> signedDeltaTotalQ(deltaTotalQ.size());
+    BeliefNode *nextNode = (*it)->getAssociatedBeliefNode();
     it++;
     BeliefNode *node;
     while (true) {
         // Apply discount and add the immediate reward.
-        deltaTotalQ = deltaTotalQ * discountFactor + (*it)->immediateReward_;
+        double discountFactor = model_->getDiscountFactor(*(*it)->getAction());
+        for (unsigned long i = 0; i < deltaTotalQ.size(); i++) {
+            deltaTotalQ[i] = deltaTotalQ[i] * discountFactor + (*it)->immediateReward_;
+            signedDeltaTotalQ[i] = sgn * deltaTotalQ[i];
+        }
         node = (*it)->getAssociatedBeliefNode();
         ActionMapping *mapping = node->getMapping();
         ActionMappingEntry *entry = mapping->getEntry(*(*it)->getAction());
         // Update the action value and visit count.
-        entry->update(sgn, sgn * deltaTotalQ);
+        updateTotalQValues(entry, sgn, signedDeltaTotalQ);
 
-        // Update the observation visit count.
-        ObservationMappingEntry *obsEntry = (
-                entry->getActionNode()->getMapping()->getEntry(*(*it)->getObservation()));
-        obsEntry->updateVisitCount(sgn);
+        // Update the observation visit count; the next node identifies the child that this history
+        // was routed to, even if an approximate mapping would now route its observation elsewhere.
+        nextNode->getParentEntry()->updateVisitCount(sgn);
+        nextNode = node;
 
         // If we've gone past the source node, we don't need to update further.
         // Backpropagation may need to go further, but we can simply defer it.
@@ -610,14 +757,16 @@ void Solver::updateSequence(HistorySequence *sequence, int sgn, long firstEntryI
             break;
         }
 
-        double oldQ = node->getCachedValue();
+        std::vector<double> oldQ = node->getBackupValues();
         deltaTotalQ = oldQ;
         if (propagateQChanges) {
             // Backpropagate the change in the q-value of the node.
             node->recalculateValue();
-            double newQ = node->getCachedValue();
+            std::vector<double> newQ = node->getBackupValues();
             long nContinuations = mapping->getTotalVisitCount() - node->getNumberOfStartingSequences();
-            deltaTotalQ += (newQ - oldQ) * nContinuations;
+            for (unsigned long i = 0; i < deltaTotalQ.size(); i++) {
+                deltaTotalQ[i] += (newQ[i] - oldQ[i]) * nContinuations;
+            }
         } else {
             // If we haven't backpropagated the change, we need to do it later.
             addNodeToBackup(node);
@@ -630,13 +779,16 @@ void Solver::updateEstimate(BeliefNode *node, double deltaTotalQ, long deltaNCon
         return;
     }
 
-    deltaTotalQ += deltaNContinuations * node->getCachedValue();
-
-    // Apply the discount factor.
-    deltaTotalQ *= options_->discountFactor;
-
+    // The heuristic value applies equally to the totals for each number of steps.
+    std::vector<double> parentDeltaTotalQ = node->getBackupValues();
     ActionMappingEntry *parentActionEntry = node->getParentActionNode()->getParentEntry();
-    if (parentActionEntry->update(0, deltaTotalQ)) {
+    double discountFactor = getDiscountFactor(parentActionEntry);
+    for (double &delta : parentDeltaTotalQ) {
+        // Apply the discount factor.
+        delta = (deltaTotalQ + deltaNContinuations * delta) * discountFactor;
+    }
+
+    if (updateTotalQValues(parentActionEntry, 0, parentDeltaTotalQ)) {
         addNodeToBackup(parentActionEntry->getMapping()->getOwner());
     }
 }
@@ -655,12 +807,29 @@ void Solver::updateImmediate(BeliefNode *node, Action const &action, Observation
     // Update the visit count for the observation.
     entry->getActionNode()->getMapping()->getEntry(observation)->updateVisitCount(deltaNVisits);
 
-    // Update the action.
-    if (entry->update(deltaNVisits, deltaTotalQ)) {
+    // Update the action; the change in the immediate reward applies to every number of steps.
+    std::vector<double> deltaTotalQValues(std::max(options_->backupSteps, 1L), deltaTotalQ);
+    if (updateTotalQValues(entry, deltaNVisits, deltaTotalQValues)) {
         addNodeToBackup(node);
     }
 }
 
+bool Solver::updateTotalQValues(ActionMappingEntry *entry, long deltaNVisits,
+        std::vector<double> const &deltaTotalQ) {
+    bool isChanged = entry->update(deltaNVisits, deltaTotalQ.back());
+    if (deltaTotalQ.size() > 1) {
+        std::vector<double> &stepTotals = entry->getActionNode()->stepTotalQValues_;
+        stepTotals.resize(deltaTotalQ.size() - 1, 0);
+        for (unsigned long i = 0; i < stepTotals.size(); i++) {
+            if (deltaTotalQ[i] != 0) {
+                stepTotals[i] += deltaTotalQ[i];
+                isChanged = true;
+            }
+        }
+    }
+    return isChanged;
+}
+
 
 /* ============================ PRIVATE ============================ */
 
@@ -668,9 +837,10 @@ void Solver::updateImmediate(BeliefNode *node, Action const &action, Observation
 void Solver::initialize() {
     // Core data structures
     if (options_->useStateIndex) {
-        statePool_ = std::make_unique<StatePool>(model_->createStateIndex());
+        statePool_ = std::make_unique<StatePool>(model_->createStateIndex(),
+                options_->deduplicateStates);
     } else {
-        statePool_ = std::make_unique<StatePool>(nullptr);
+        statePool_ = std::make_unique<StatePool>(nullptr, options_->deduplicateStates);
     }
     histories_ = std::make_unique<Histories>();
     policy_ = std::make_unique<BeliefTree>(this);
@@ -685,6 +855,10 @@ void Solver::initialize() {
     searchStrategy_ = model_->createSearchStrategy(this);
     recommendationStrategy_ = model_->createRecommendationSelectionStrategy(this);
     estimationStrategy_ = model_->createEstimationStrategy(this);
+
+    if (options_->backupSteps > 1 && options_->backupLambda > 0) {
+        debug::show_message("WARNING: backupLambda is ignored when backupSteps > 1.");
+    }
 }
 
 /* ------------------ Episode sampling methods ------------------- */
@@ -726,6 +900,18 @@ long Solver::multipleSearches(BeliefNode *startNode, std::function<StateInfo *()
     }
 
     long numSearches = 0;
+    if (options_->useSequentialHalving && (maxNumSearches != 0 || hasTimeout)) {
+        // Every action must be tried once first, which only makes sense for discrete actions.
+        if (dynamic_cast<DiscretizedActionPool *>(actionPool_.get()) != nullptr) {
+            numSearches = sequentialHalvingSearches(startNode, sampler, maximumDepth,
+                    maxNumSearches, endTime);
+        } else if (!hasWarnedAboutHalving_) {
+            debug::show_message("WARNING: Sequential halving requires a discrete action space;"
+                    " searching as usual instead.");
+            hasWarnedAboutHalving_ = true;
+        }
+    }
+    // Any budget left over (e.g. due to rounding) is spent as usual.
     while (true) {
         // If we've done enough searches, stop searching.
         if (maxNumSearches != 0 && numSearches >= maxNumSearches) {
@@ -735,6 +921,10 @@ long Solver::multipleSearches(BeliefNode *startNode, std::function<StateInfo *()
         if (hasTimeout && tapir::clock_ms() >= endTime) {
             break;
         }
+        // If the search has been cancelled, stop searching.
+        if (isCancelled()) {
+            break;
+        }
         singleSearch(startNode, sampler(), maximumDepth);
         numSearches++;
     }
@@ -745,6 +935,85 @@ long Solver::multipleSearches(BeliefNode *startNode, std::function<StateInfo *()
     return numSearches;
 }
 
+long Solver::sequentialHalvingSearches(BeliefNode *startNode,
+        std::function<StateInfo *()> sampler, long maximumDepth, long maxNumSearches,
+        double endTime) {
+    long numSearches = 0;
+    // Returns true iff another search is allowed within the given limits.
+    auto canSearch = [this, &numSearches](long searchLimit, double timeLimit) {
+        return (numSearches < searchLimit && tapir::clock_ms() < timeLimit && !isCancelled());
+    };
+    long totalSearchLimit = maxNumSearches;
+    if (totalSearchLimit == 0) {
+        totalSearchLimit = std::numeric_limits<long>::max();
+    }
+
+    ActionMapping *mapping = startNode->getMapping();
+    forcedActionNode_ = startNode;
+
+    // Every legal action is tried once before any of them are discarded.
+    forcedAction_ = mapping->getNextActionToTry();
+    while (forcedAction_ != nullptr && canSearch(totalSearchLimit, endTime)) {
+        singleSearch(startNode, sampler(), maximumDepth);
+        numSearches++;
+        forcedAction_ = mapping->getNextActionToTry();
+    }
+
+    std::vector<std::unique_ptr<Action>> candidates;
+    for (ActionMappingEntry const *entry : mapping->getVisitedEntries()) {
+        if (entry->isLegal()) {
+            candidates.push_back(entry->getAction());
+        }
+    }
+    auto isBetter = [mapping](std::unique_ptr<Action> const &a, std::unique_ptr<Action> const &b) {
+        return mapping->getEntry(*a)->getMeanQValue() > mapping->getEntry(*b)->getMeanQValue();
+    };
+
+    long numberOfRounds = 0;
+    if (candidates.size() > 1) {
+        numberOfRounds = std::ceil(std::log2(candidates.size()));
+    }
+    for (long round = 0; round < numberOfRounds; round++) {
+        // The remaining budget is split evenly between the remaining rounds.
+        long roundsLeft = numberOfRounds - round;
+        long roundSearchLimit = totalSearchLimit;
+        if (maxNumSearches != 0) {
+            roundSearchLimit = numSearches + (maxNumSearches - numSearches) / roundsLeft;
+        }
+        double roundEndTime = endTime;
+        if (endTime != std::numeric_limits<double>::infinity()) {
+            double currentTime = tapir::clock_ms();
+            roundEndTime = currentTime + (endTime - currentTime) / roundsLeft;
+        }
+
+        // Within a round, the candidates take turns.
+        unsigned long index = 0;
+        while (canSearch(roundSearchLimit, roundEndTime)) {
+            forcedAction_ = candidates[index]->copy();
+            singleSearch(startNode, sampler(), maximumDepth);
+            numSearches++;
+            index = (index + 1) % candidates.size();
+        }
+
+        // Keep only the better half of the candidates.
+        doBackup();
+        std::stable_sort(candidates.begin(), candidates.end(), isBetter);
+        candidates.resize((candidates.size() + 1) / 2);
+        if (isCancelled()) {
+            break;
+        }
+    }
+
+    forcedActionNode_ = nullptr;
+    forcedAction_ = nullptr;
+    if (!candidates.empty()) {
+        selectedActionNode_ = startNode;
+        selectedAction_ = std::move(*std::min_element(candidates.begin(), candidates.end(),
+                isBetter));
+    }
+    return numSearches;
+}
+
 void Solver::singleSearch(BeliefNode *startNode, StateInfo *startStateInfo, long maximumDepth) {
     HistorySequence *sequence = histories_->createSequence();
 
@@ -760,6 +1029,148 @@ void Solver::continueSearch(HistorySequence *sequence, long maximumDepth) {
     searchStrategy_->extendAndBackup(sequence, maximumDepth);
 }
 
+/* ------------------ Open-loop search ------------------- */
+long Solver::pruneOpenLoopSequences(BeliefNode *node) {
+    std::vector<HistorySequence *> openLoopSequences;
+    for (HistoryEntry *entry : node->particles_) {
+        long openLoopEntryId = entry->owningSequence_->getOpenLoopEntryId();
+        if (openLoopEntryId != -1 && openLoopEntryId < entry->entryId_) {
+            openLoopSequences.push_back(entry->owningSequence_);
+        }
+    }
+
+    // Undo the sequences and delete them, then back up the changes in one go.
+    for (HistorySequence *sequence : openLoopSequences) {
+        updateSequence(sequence, -1, 0, false);
+        histories_->deleteSequence(sequence);
+    }
+    doBackup();
+    return openLoopSequences.size();
+}
+
+/* ------------------ Particle replenishment ------------------- */
+long Solver::getKldParticleCount(long numberOfBins) const {
+    double count = 0;
+    if (numberOfBins > 1) {
+        // The Wilson-Hilferty approximation to the chi-squared quantile, as per Fox (2003).
+        long k = numberOfBins - 1;
+        double a = 2.0 / (9.0 * k);
+        double b = 1.0 - a + std::sqrt(a) * options_->kldQuantile;
+        count = k / (2 * options_->kldError) * b * b * b;
+    }
+    count = std::max(count, static_cast<double>(options_->kldMinParticleCount));
+    count = std::min(count, static_cast<double>(options_->kldMaxParticleCount));
+    return std::ceil(count);
+}
+
+std::vector<std::unique_ptr<State>> Solver::generateParticles(BeliefNode *previousBelief,
+        Action const &action, Observation const &obs, long nParticles,
+        std::vector<State const *> const *previousParticles) {
+    auto generate = [&](long count) -> std::vector<std::unique_ptr<State>> {
+        if (previousParticles == nullptr) {
+            return model_->generateParticles(previousBelief, action, obs, count);
+        }
+        return model_->generateParticles(previousBelief, action, obs, count,
+                *previousParticles);
+    };
+    long numberOfShares = std::min(static_cast<long>(options_->replenishingThreads), nParticles);
+    if (numberOfShares <= 1) {
+        return generate(nParticles);
+    }
+    if (replenishingPool_ == nullptr) {
+        replenishingPool_ = std::make_unique<ThreadPool>(options_->replenishingThreads);
+    }
+
+    // The seeds are drawn here, in order, so that each share's stream doesn't depend on how the
+    // shares are scheduled.
+    RandomGenerator &randGen = *model_->getRandomGenerator();
+    std::vector<RandomGenerator> generators;
+    for (long shareNo = 0; shareNo < numberOfShares; shareNo++) {
+        std::seed_seq seeds { static_cast<unsigned long>(randGen()),
+                static_cast<unsigned long>(shareNo) };
+        generators.emplace_back(seeds);
+    }
+    // If the model can give the expected number of copies of each next state, the previous
+    // particles are only weighed once; the threads then draw the copies for a share of the states.
+    std::vector<std::pair<std::unique_ptr<State>, double>> expectedCounts;
+    if (previousParticles != nullptr) {
+        expectedCounts = model_->getExpectedParticleCounts(previousBelief, action, obs,
+                nParticles, *previousParticles);
+    }
+
+    std::vector<std::vector<std::unique_ptr<State>>> shares(numberOfShares);
+    replenishingPool_->run(numberOfShares, [&](long shareNo) {
+        Model::ThreadRandomGenerator threadRandGen(&generators[shareNo]);
+        if (!expectedCounts.empty()) {
+            long numberOfStates = expectedCounts.size();
+            shares[shareNo] = model_->drawParticles(expectedCounts,
+                    numberOfStates * shareNo / numberOfShares,
+                    numberOfStates * (shareNo + 1) / numberOfShares);
+            return;
+        }
+        long shareSize = nParticles / numberOfShares;
+        if (shareNo < nParticles % numberOfShares) {
+            shareSize++;
+        }
+        shares[shareNo] = generate(shareSize);
+    });
+
+    std::vector<std::unique_ptr<State>> particles;
+    for (std::vector<std::unique_ptr<State>> &share : shares) {
+        for (std::unique_ptr<State> &particle : share) {
+            particles.push_back(std::move(particle));
+        }
+    }
+    return particles;
+}
+
+void Solver::rejuvenateParticles(BeliefNode const *belief,
+        std::vector<std::unique_ptr<State>> &particles) {
+    std::function<double(State const &)> likelihood = model_->createHistoryLikelihood(belief);
+    if (!likelihood) {
+        return;
+    }
+    RandomGenerator &randGen = *model_->getRandomGenerator();
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    long numberOfProposals = 0;
+    long numberAccepted = 0;
+    for (std::unique_ptr<State> &particle : particles) {
+        double currentLikelihood = likelihood(*particle);
+        for (unsigned long step = 0; step < options_->rejuvenationSteps; step++) {
+            std::unique_ptr<State> proposal = model_->generateRejuvenationProposal(*particle);
+            if (proposal == nullptr) {
+                return;
+            }
+            numberOfProposals++;
+            // The proposals are symmetric, so only the likelihoods are needed for the ratio.
+            double proposedLikelihood = likelihood(*proposal);
+            if (proposedLikelihood <= 0 || !model_->isValid(*proposal)) {
+                continue;
+            }
+            if (proposedLikelihood >= currentLikelihood
+                    || uniform(randGen) * currentLikelihood < proposedLikelihood) {
+                particle = std::move(proposal);
+                currentLikelihood = proposedLikelihood;
+                numberAccepted++;
+            }
+        }
+    }
+    if (options_->hasVerboseOutput) {
+        cout << "Rejuvenation accepted " << numberAccepted << " of " << numberOfProposals;
+        cout << " moves...          ";
+        cout.flush();
+    }
+}
+
+/* ------------------ Discounting ------------------- */
+double Solver::getDiscountFactor(ActionMappingEntry const *entry) const {
+    if (!options_->hasMacroActions) {
+        return options_->discountFactor;
+    }
+    return model_->getDiscountFactor(*entry->getAction());
+}
+
 /* ------------------ Private deferred backup methods. ------------------- */
 void Solver::addNodeToBackup(BeliefNode *node) {
     nodesToBackup_[node->getDepth()].insert(node);
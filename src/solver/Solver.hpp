@@ -28,10 +28,12 @@
  * Solver class, of course.
  */
 namespace solver {
+class ActionMappingEntry;
 class ActionPool;
 class BackpropagationStrategy;
 class BeliefNode;
 class BeliefTree;
+class CancellationToken;
 class Histories;
 class HistoryEntry;
 class HistorySequence;
@@ -40,6 +42,7 @@ class SearchStrategy;
 class Serializer;
 class StateInfo;
 class StatePool;
+class ThreadPool;
 
 /** The core class of the ABT algorithm.
  *
@@ -88,6 +91,8 @@ public:
 
     /** Returns the estimation strategy. */
     EstimationStrategy *getEstimationStrategy() const;
+    /** Returns the search strategy. */
+    SearchStrategy *getSearchStrategy() const;
 
     /** Returns the recommendation strategy. */
     SelectRecommendedActionStrategy* getRecommendationStrategy() const;
@@ -109,16 +114,46 @@ public:
      * - maximumDepth is the maximum depth allowed in the tree (-1 => default), relative to the
      * starting belief node.
      * - timeout is the maximum allowed time in milliseconds (-1 => default, 0 => no timeout)
+     *
+     * The search also stops early if the cancellation token (if any) is cancelled.
      */
     void improvePolicy(BeliefNode *startNode = nullptr,
             long numberOfHistories = -1, long maximumDepth = -1, double timeout = -1);
 
+    /** Sets the token that can be used to cancel improvePolicy() early, e.g. from another
+     * thread when a new observation arrives (nullptr => searches cannot be cancelled).
+     *
+     * The token is not owned by the solver, and must outlive any searches that use it.
+     */
+    void setCancellationToken(CancellationToken const *token);
+    /** Returns true iff the current search has been cancelled. */
+    bool isCancelled() const;
+
+    /** Returns the action that searches are currently required to take from the given node, or
+     * nullptr if the search strategy is free to choose.
+     *
+     * Every StepGenerator that chooses actions must check this first, since sequential halving
+     * relies on it to control which actions are searched from the node.
+     */
+    Action const *getForcedAction(BeliefNode const *node) const;
+    /** Returns the action chosen for the given node by the most recent sequential halving search
+     * (see Options::useSequentialHalving), or nullptr if there is no such choice.
+     *
+     * The choice is discarded whenever the policy is searched or changed again.
+     */
+    std::unique_ptr<Action> getSelectedAction(BeliefNode const *node) const;
+
     /** Replenishes the particle count in the child node, ensuring that it
      * has at least the given number of particles
-     * (-1 => default == model.getMinParticleCount())
+     * (-1 => default == options.minParticleCount, or the KLD-sampling bound if
+     * options.useKldSampling is set)
      */
     BeliefNode *replenishChild(BeliefNode *currNode, Action const &action, Observation const &obs,
             long minParticleCount = -1);
+    /** Returns the number of times replenishChild() has been unable to generate particles from
+     * the previous belief, and has had to fall back to an uninformed prior (or failed outright).
+     */
+    long getNumberOfDeprivations() const;
 
     /** Resets the tree, so that the given belief will be the new root. */
     void resetTree(BeliefNode *newRoot);
@@ -133,6 +168,17 @@ public:
      */
     long pruneSubtree(BeliefNode *root);
 
+    /* ------------------- Step generation ------------------- */
+    /** Uses the model to generate a step from the given state, taking the given action; the
+     * entry, if given, must be the history entry for that state.
+     *
+     * If the model has deterministic transitions and an entry is given, the transition is
+     * memoized in the state pool; when it is found there only the observation and reward are
+     * generated, and the result will have its nextStateInfo set instead of nextState.
+     */
+    Model::StepResult generateStep(HistoryEntry const *entry, State const &state,
+            Action const &action);
+
     /* ------------------- Change handling methods ------------------- */
     /** Returns the current root node for changes. */
     BeliefNode *getChangeRoot() const;
@@ -218,16 +264,71 @@ private:
      * Returns the actual number of histories generated. */
     long multipleSearches(BeliefNode *startNode, std::function<StateInfo *()> sampler,
             long maximumDepth, long maxNumSearches, double endTime);
+    /** Runs searches from the given start node, using sequential halving to choose the first
+     * action of each search; the given budget must be finite.
+     *
+     * Returns the actual number of histories generated. */
+    long sequentialHalvingSearches(BeliefNode *startNode, std::function<StateInfo *()> sampler,
+            long maximumDepth, long maxNumSearches, double endTime);
     /** Searches from the given start node with the given start state. */
     void singleSearch(BeliefNode *startNode, StateInfo *startStateInfo, long maximumDepth);
     /** Continues a pre-existing history sequence from its endpoint. */
     void continueSearch(HistorySequence *sequence, long maximumDepth);
 
+    /* ------------------ Open-loop search ------------------- */
+    /** Deletes every history sequence that reached the given node via open-loop search, i.e.
+     * without actually receiving the observations that lead to it.
+     *
+     * Returns the number of sequences deleted.
+     */
+    long pruneOpenLoopSequences(BeliefNode *node);
+
+    /* ------------------ Particle replenishment ------------------- */
+    /** Returns the number of particles KLD-sampling requires for a belief whose particles occupy
+     * the given number of bins, clamped to the bounds given by the options.
+     */
+    long getKldParticleCount(long numberOfBins) const;
+    /** Generates the given number of new particles following the given belief, action and
+     * observation, using Model::generateParticles() - with the given previous particles, or the
+     * uninformed version if that is null.
+     *
+     * If Options::replenishingThreads is more than 1, the particles are split evenly between that
+     * many threads. Each share gets its own random stream, seeded from the model's generator,
+     * and the shares are concatenated in a fixed order, so the result only depends on the seed
+     * and the number of threads. Where the model supports Model::getExpectedParticleCounts(),
+     * the weights are calculated once, on this thread, and only the drawing is split.
+     */
+    std::vector<std::unique_ptr<State>> generateParticles(BeliefNode *previousBelief,
+            Action const &action, Observation const &obs, long nParticles,
+            std::vector<State const *> const *previousParticles);
+    /** Makes Options::rejuvenationSteps Metropolis-Hastings moves for each of the given new
+     * particles for the given belief, replacing each particle with the end state of its chain.
+     *
+     * Does nothing if the model does not support rejuvenation.
+     */
+    void rejuvenateParticles(BeliefNode const *belief,
+            std::vector<std::unique_ptr<State>> &particles);
+
+    /* ------------------ Discounting ------------------- */
+    /** Returns the discount to apply to the value of the beliefs following the action of the
+     * given entry (see Model::getDiscountFactor()).
+     */
+    double getDiscountFactor(ActionMappingEntry const *entry) const;
+
     /* ------------------ Private deferred backup methods. ------------------- */
     /** Adds a new node that requires backing up. */
     void addNodeToBackup(BeliefNode *node);
     /** Removes a node from the deferred backup queue. */
     void removeNodeToBackup(BeliefNode *node);
+    /** Applies the given changes to the total Q-values of the given entry, along with the given
+     * change in its visit count. There is one change for each backup value of a belief (see
+     * BeliefNode::getBackupValues()); the last is for the entry itself, and the others are for the
+     * totals kept by its action node for shorter n-step returns.
+     *
+     * Returns true iff the value of the entry's belief may need to be recalculated.
+     */
+    bool updateTotalQValues(ActionMappingEntry *entry, long deltaNVisits,
+            std::vector<double> const &deltaTotalQ);
 
     /* ------------------ Private data fields ------------------- */
     /** The POMDP model */
@@ -260,6 +361,25 @@ private:
     /** The strategy for estimating the value of a belief node based on actions from it. */
     std::unique_ptr<EstimationStrategy> estimationStrategy_;
 
+    /** The token used to cancel searches early; not owned by the solver. */
+    CancellationToken const *cancellationToken_;
+
+    /** The node from which searches must take forcedAction_, if any. */
+    BeliefNode const *forcedActionNode_;
+    /** The action that searches from forcedActionNode_ must take. */
+    std::unique_ptr<Action> forcedAction_;
+    /** The node for which sequential halving last made a choice, if any. */
+    BeliefNode const *selectedActionNode_;
+    /** The action chosen for selectedActionNode_ by sequential halving. */
+    std::unique_ptr<Action> selectedAction_;
+    /** True once the solver has warned that sequential halving can't be used for its actions. */
+    bool hasWarnedAboutHalving_;
+
+    /** The number of times particles could not be generated from the previous belief. */
+    long numberOfDeprivations_;
+    /** The threads used to replenish particles; only started once they are needed. */
+    std::unique_ptr<ThreadPool> replenishingPool_;
+
     /** The nodes to be updated, sorted by depth (deepest first) */
     std::map<int, std::set<BeliefNode *>, std::greater<int>> nodesToBackup_;
 
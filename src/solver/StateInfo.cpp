@@ -45,6 +45,9 @@ long StateInfo::getId() const {
 State const *StateInfo::getState() const {
     return state_.get();
 }
+std::unordered_set<HistoryEntry *> const &StateInfo::getUsedInHistoryEntries() const {
+    return usedInHistoryEntries_;
+}
 
 
 /* ============================ PRIVATE ============================ */
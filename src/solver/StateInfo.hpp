@@ -50,6 +50,8 @@ public:
     long getId() const;
     /** Returns the state held by this StateInfo. */
     State const *getState() const;
+    /** Returns the set of history entries that this state occurs in. */
+    std::unordered_set<HistoryEntry *> const &getUsedInHistoryEntries() const;
 
 private:
     /* ----------------- History entry registration  ----------------- */
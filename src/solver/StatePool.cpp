@@ -19,11 +19,14 @@
 
 namespace solver {
 
-StatePool::StatePool(std::unique_ptr<StateIndex> stateIndex) :
+StatePool::StatePool(std::unique_ptr<StateIndex> stateIndex, bool deduplicateStates) :
+    deduplicateStates_(deduplicateStates),
     stateInfoMap_(),
     statesByIndex_(),
     stateIndex_(std::move(stateIndex)),
-    changedStates_() {
+    numberOfIndexedStates_(0),
+    changedStates_(),
+    cachedTransitions_() {
 }
 
 StatePool::~StatePool() {
@@ -41,17 +44,29 @@ StateInfo *StatePool::getInfoById(long id) const {
     return statesByIndex_[id].get();
 }
 StateIndex *StatePool::getStateIndex() const {
+    if (stateIndex_ != nullptr) {
+        // Bring the index up to date with any states that were added without indexing.
+        long numberOfStates = statesByIndex_.size();
+        for (; numberOfIndexedStates_ < numberOfStates; numberOfIndexedStates_++) {
+            stateIndex_->addStateInfo(statesByIndex_[numberOfIndexedStates_].get());
+        }
+    }
     return stateIndex_.get();
 }
+bool StatePool::isDeduplicating() const {
+    return deduplicateStates_;
+}
 long StatePool::getNumberOfStates() const {
     return statesByIndex_.size();
 }
 
 /* ------------------ State lookup ------------------- */
 StateInfo *StatePool::createOrGetInfo(State const &state) {
-    StateInfo *info = getInfo(state);
-    if (info != nullptr) {
-        return info;
+    if (deduplicateStates_) {
+        StateInfo *info = getInfo(state);
+        if (info != nullptr) {
+            return info;
+        }
     }
     return add(std::make_unique<StateInfo>(state.copy()));
 }
@@ -66,6 +81,15 @@ void StatePool::setChangeFlags(StateInfo *stateInfo, ChangeFlags flags) {
         stateInfo->setChangeFlags(flags);
         changedStates_.insert(stateInfo);
     }
+
+    if (changes::has_flags(flags, ChangeFlags::DELETED)
+            || changes::has_flags(flags, ChangeFlags::TRANSITION_BEFORE)) {
+        // We don't know which states lead here, so none of the cached transitions can be trusted.
+        clearCachedTransitions();
+    } else if (changes::has_flags(flags, ChangeFlags::TRANSITION)
+            && stateInfo->getId() < static_cast<long>(cachedTransitions_.size())) {
+        cachedTransitions_[stateInfo->getId()].clear();
+    }
 }
 void StatePool::resetAffectedStates() {
     for (StateInfo *stateInfo : changedStates_) {
@@ -77,31 +101,64 @@ std::unordered_set<StateInfo *> StatePool::getAffectedStates() const {
     return changedStates_;
 }
 
+/* ------------------ Memoized transitions ------------------- */
+StateInfo *StatePool::getCachedTransition(StateInfo const *stateInfo,
+        long actionBinNumber) const {
+    long stateId = stateInfo->getId();
+    if (stateId >= static_cast<long>(cachedTransitions_.size())) {
+        return nullptr;
+    }
+    std::vector<StateInfo *> const &transitions = cachedTransitions_[stateId];
+    if (actionBinNumber >= static_cast<long>(transitions.size())) {
+        return nullptr;
+    }
+    return transitions[actionBinNumber];
+}
+void StatePool::cacheTransition(StateInfo const *stateInfo, long actionBinNumber,
+        StateInfo *nextStateInfo) {
+    long stateId = stateInfo->getId();
+    if (stateId >= static_cast<long>(cachedTransitions_.size())) {
+        cachedTransitions_.resize(statesByIndex_.size());
+    }
+    std::vector<StateInfo *> &transitions = cachedTransitions_[stateId];
+    if (actionBinNumber >= static_cast<long>(transitions.size())) {
+        transitions.resize(actionBinNumber + 1, nullptr);
+    }
+    transitions[actionBinNumber] = nextStateInfo;
+}
+void StatePool::clearCachedTransitions() {
+    cachedTransitions_.clear();
+}
+
 /* ============================ PRIVATE ============================ */
 
 
 /* ------------------ Mutators for the pool ------------------- */
 StateInfo *StatePool::add(std::unique_ptr<StateInfo> newInfo) {
-    std::pair<StateInfoMap::iterator, bool> ret = (
-            stateInfoMap_.emplace(newInfo->getState(), newInfo.get()));
-    StateInfo *stateInfo = ret.first->second;
-    if (ret.second) {
-        long newId = long(statesByIndex_.size());
-        // New state - add to the index.
-        long oldId = stateInfo->getId();
-        if (oldId != -1 && oldId != newId) {
-            std::ostringstream message;
-            message << "ERROR: ID mismatch - file says " << oldId;
-            message << " but and ID of " << newId << " was assigned.";
-            debug::show_message(message.str());
-        }
-        stateInfo->id_ = newId;
-        statesByIndex_.push_back(std::move(newInfo));
-        if (stateIndex_ != nullptr) {
-            stateIndex_->addStateInfo(stateInfo);
+    StateInfo *stateInfo = newInfo.get();
+    if (deduplicateStates_) {
+        std::pair<StateInfoMap::iterator, bool> ret = (
+                stateInfoMap_.emplace(newInfo->getState(), stateInfo));
+        if (!ret.second) {
+            debug::show_message("ERROR: StateInfo already added!!");
+            return ret.first->second;
         }
-    } else {
-        debug::show_message("ERROR: StateInfo already added!!");
+    }
+
+    long newId = long(statesByIndex_.size());
+    long oldId = stateInfo->getId();
+    if (oldId != -1 && oldId != newId) {
+        std::ostringstream message;
+        message << "ERROR: ID mismatch - file says " << oldId;
+        message << " but and ID of " << newId << " was assigned.";
+        debug::show_message(message.str());
+    }
+    stateInfo->id_ = newId;
+    statesByIndex_.push_back(std::move(newInfo));
+    // Without deduplication, indexing is deferred until the index is requested.
+    if (deduplicateStates_ && stateIndex_ != nullptr) {
+        stateIndex_->addStateInfo(stateInfo);
+        numberOfIndexedStates_++;
     }
     return stateInfo;
 }
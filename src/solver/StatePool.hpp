@@ -42,6 +42,16 @@ class StateIndex;
  * The pool allows states to be looked up by ID; more complicated lookup operations
  * (typically based on spatial coordinates) should be handled via the StateIndex, which can be
  * retrieved via getStateIndex().
+ *
+ * If deduplication is disabled, every state is stored as a new StateInfo without looking it up
+ * first; this is cheaper whenever states rarely repeat, e.g. in continuous state spaces.
+ * In that mode the StateIndex is also populated lazily - new states are only added to it, in
+ * bulk, when getStateIndex() is called.
+ *
+ * For models with deterministic transitions the pool can also memoize transitions, mapping
+ * (state ID, action bin number) to the StateInfo of the next state; see getCachedTransition().
+ * These cached transitions are invalidated automatically whenever states are flagged with
+ * transition changes.
  */
 class StatePool {
     friend class Solver;
@@ -65,26 +75,37 @@ class StatePool {
     /** An unordered map for looking up the StateInfo for a given State. */
     typedef std::unordered_map<State const *, StateInfo *, Hash, EqualityTest> StateInfoMap;
 
-    /** Constructs a new StatePool with the given StateIndex. */
-    StatePool(std::unique_ptr<StateIndex> stateIndex);
+    /** Constructs a new StatePool with the given StateIndex; if deduplicateStates is false,
+     * states are stored append-only and the index is only built on demand.
+     */
+    StatePool(std::unique_ptr<StateIndex> stateIndex, bool deduplicateStates = true);
     ~StatePool();
     _NO_COPY_OR_MOVE(StatePool);
 
     /* ------------------ Simple getters ------------------- */
-    /** Returns the StateInfo for the given state, or nullptr if there is no info. */
+    /** Returns the StateInfo for the given state, or nullptr if there is no info.
+     * NOTE: this always returns nullptr if deduplication is disabled.
+     */
     StateInfo *getInfo(State const &state) const;
     /** Returns the info at the given ID.
      * NOTE: it is a prerequisite that 0 <= id < getNumberOfStates(); otherwise memory access
      * violations will result!
      */
     StateInfo *getInfoById(long id) const;
-    /** Returns the StateIndex used by this pool. */
+    /** Returns the StateIndex used by this pool, first adding any states that have not yet
+     * been indexed.
+     */
     StateIndex *getStateIndex() const;
+    /** Returns true iff this pool looks up new states to avoid storing duplicates. */
+    bool isDeduplicating() const;
     /** Returns the number of states in this pooll. */
     long getNumberOfStates() const;
 
     /* ------------------ State lookup ------------------- */
-    /** Returns a StateInfo for the given state, creating a new one if there wasn't one already. */
+    /** Returns a StateInfo for the given state, creating a new one if there wasn't one already.
+     *
+     * If deduplication is disabled, a new StateInfo is always created.
+     */
     StateInfo *createOrGetInfo(State const &state);
 
     /* ---------------- Flagging of states with changes ----------------- */
@@ -100,21 +121,41 @@ class StatePool {
     /** Returns the current set of affected states. */
     std::unordered_set<StateInfo *> getAffectedStates() const;
 
+    /* ------------------ Memoized transitions ------------------- */
+    /** Returns the cached next state for taking the action with the given bin number from the
+     * given state, or nullptr if no such transition has been cached.
+     */
+    StateInfo *getCachedTransition(StateInfo const *stateInfo, long actionBinNumber) const;
+    /** Caches the next state for taking the action with the given bin number from the given
+     * state.
+     */
+    void cacheTransition(StateInfo const *stateInfo, long actionBinNumber,
+            StateInfo *nextStateInfo);
+    /** Removes all cached transitions. */
+    void clearCachedTransitions();
+
   private:
     /* ------------------ Mutators for the pool ------------------- */
     /** Takes possession of the given StateInfo and adds it to the pool. */
     StateInfo *add(std::unique_ptr<StateInfo> stateInfo);
 
   private:
+    /** True iff new states are looked up in stateInfoMap_ before being added. */
+    bool deduplicateStates_;
     /** An unordered mapping of states to their associated StateInfo. */
     StateInfoMap stateInfoMap_;
     /** The vector that actually stores the StateInfo; also allows lookup of states by ID. */
     std::vector<std::unique_ptr<StateInfo>> statesByIndex_;
     /** The StateIndex used by this pool. */
     std::unique_ptr<StateIndex> stateIndex_;
+    /** The number of states (in order of ID) that have been added to the StateIndex so far. */
+    mutable long numberOfIndexedStates_;
 
     /** The set of states currently marked as affected by changes. */
     std::unordered_set<StateInfo *> changedStates_;
+
+    /** The cached transitions, indexed by state ID and then by action bin number. */
+    std::vector<std::vector<StateInfo *>> cachedTransitions_;
 };
 } /* namespace solver */
 
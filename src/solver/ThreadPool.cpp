@@ -0,0 +1,72 @@
+/** @file ThreadPool.cpp
+ *
+ * Contains the implementation of the ThreadPool class.
+ */
+#include "solver/ThreadPool.hpp"
+
+#include <utility>
+
+namespace solver {
+ThreadPool::ThreadPool(long numberOfThreads) :
+        threads_(),
+        mutex_(),
+        hasTasks_(),
+        isBatchDone_(),
+        task_(nullptr),
+        numberOfTasks_(0),
+        nextTaskNo_(0),
+        numberUnfinished_(0),
+        isStopping_(false) {
+    for (long threadNo = 0; threadNo < numberOfThreads; threadNo++) {
+        threads_.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopping_ = true;
+    }
+    hasTasks_.notify_all();
+    for (std::thread &thread : threads_) {
+        thread.join();
+    }
+}
+
+long ThreadPool::getNumberOfThreads() const {
+    return threads_.size();
+}
+
+void ThreadPool::run(long numberOfTasks, std::function<void(long taskNo)> task) {
+    if (numberOfTasks <= 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = std::move(task);
+    numberOfTasks_ = numberOfTasks;
+    nextTaskNo_ = 0;
+    numberUnfinished_ = numberOfTasks;
+    hasTasks_.notify_all();
+    isBatchDone_.wait(lock, [this] { return numberUnfinished_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        hasTasks_.wait(lock, [this] { return isStopping_ || nextTaskNo_ < numberOfTasks_; });
+        if (isStopping_) {
+            return;
+        }
+        long taskNo = nextTaskNo_;
+        nextTaskNo_++;
+        lock.unlock();
+        task_(taskNo);
+        lock.lock();
+        numberUnfinished_--;
+        if (numberUnfinished_ == 0) {
+            isBatchDone_.notify_all();
+        }
+    }
+}
+} /* namespace solver */
@@ -0,0 +1,65 @@
+/** @file ThreadPool.hpp
+ *
+ * Defines the ThreadPool class, a fixed set of worker threads for running a batch of independent
+ * tasks in parallel.
+ */
+#ifndef SOLVER_THREADPOOL_HPP_
+#define SOLVER_THREADPOOL_HPP_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "global.hpp"
+
+namespace solver {
+/** A pool of worker threads, which are started once and then reused for each batch of tasks.
+ *
+ * Only one batch runs at a time: run() hands out the task numbers to the workers, and returns
+ * once every task has finished.
+ */
+class ThreadPool {
+public:
+    /** Starts the given number of worker threads. */
+    ThreadPool(long numberOfThreads);
+    /** Stops and joins the worker threads. */
+    ~ThreadPool();
+    _NO_COPY_OR_MOVE(ThreadPool);
+
+    /** Returns the number of worker threads. */
+    long getNumberOfThreads() const;
+
+    /** Calls the given task once with each of the numbers 0 to (numberOfTasks - 1), spread
+     * across the worker threads, and waits for all of the calls to return.
+     */
+    void run(long numberOfTasks, std::function<void(long taskNo)> task);
+
+private:
+    /** The loop run by each worker thread. */
+    void work();
+
+    /** The worker threads. */
+    std::vector<std::thread> threads_;
+    /** Guards all of the members below. */
+    std::mutex mutex_;
+    /** Signalled when there are new tasks, or when the workers should stop. */
+    std::condition_variable hasTasks_;
+    /** Signalled when the last task of a batch finishes. */
+    std::condition_variable isBatchDone_;
+
+    /** The task for the current batch. */
+    std::function<void(long)> task_;
+    /** The number of tasks in the current batch. */
+    long numberOfTasks_;
+    /** The next task number to hand out. */
+    long nextTaskNo_;
+    /** The number of tasks in the current batch that have not finished yet. */
+    long numberUnfinished_;
+    /** True iff the workers should stop. */
+    bool isStopping_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_THREADPOOL_HPP_ */
@@ -6,7 +6,10 @@
  */
 #include "solver/abstract-problem/Model.hpp"
 
+#include <cmath>
 #include <functional>
+#include <random>
+#include <utility>
 
 #include "solver/cached_values.hpp"
 #include "solver/ActionNode.hpp"
@@ -39,6 +42,20 @@
 #include "solver/serialization/Serializer.hpp"
 
 namespace solver {
+namespace {
+/** The generator set by a ThreadRandomGenerator on this thread, if any. */
+thread_local RandomGenerator *threadRandGen = nullptr;
+} /* namespace */
+
+Model::ThreadRandomGenerator::ThreadRandomGenerator(RandomGenerator *randGen) :
+        previous_(threadRandGen) {
+    threadRandGen = randGen;
+}
+
+Model::ThreadRandomGenerator::~ThreadRandomGenerator() {
+    threadRandGen = previous_;
+}
+
 Model::Model(std::string problemName, RandomGenerator *randGen, std::unique_ptr<Options> options) :
         problemName_(problemName),
         randGen_(randGen),
@@ -47,6 +64,9 @@ Model::Model(std::string problemName, RandomGenerator *randGen, std::unique_ptr<
 
 /* -------------------- Simple getters ---------------------- */
 RandomGenerator *Model::getRandomGenerator() const {
+    if (threadRandGen != nullptr) {
+        return threadRandGen;
+    }
     return randGen_;
 }
 
@@ -57,6 +77,34 @@ Options const *Model::getOptions() const {
 /* -------------------- Black box dynamics ---------------------- */
 // The more detailed methods are optional.
 
+bool Model::hasDeterministicTransitions() {
+    return false;
+}
+
+long Model::getActionDuration(Action const &/*action*/) {
+    return 1;
+}
+
+double Model::getDiscountFactor(Action const &action) {
+    if (!options_->hasMacroActions) {
+        return options_->discountFactor;
+    }
+    return std::pow(options_->discountFactor, getActionDuration(action));
+}
+
+Model::StepResult Model::generateStepToState(
+        State const &state,
+        Action const &action,
+        State const &nextState
+        ) {
+    StepResult result;
+    result.action = action.copy();
+    result.observation = generateObservation(&state, action, nullptr, nextState);
+    result.reward = generateReward(state, action, nullptr, &nextState);
+    result.isTerminal = isTerminal(nextState);
+    return result;
+}
+
 std::unique_ptr<TransitionParameters> Model::generateTransition(
         State const &/*state*/,
         Action const &/*action*/) {
@@ -96,6 +144,13 @@ void Model::applyChanges(std::vector<std::unique_ptr<ModelChange>> const &/*chan
         Solver */*solver*/) {
 }
 
+void Model::prepareChanges(std::vector<std::unique_ptr<ModelChange>> const &/*changes*/,
+        Solver */*solver*/, std::vector<StateInfo *> const &/*states*/) {
+}
+
+void Model::resetRoot(BeliefNode const */*newRoot*/) {
+}
+
 
 /* ------------ Methods for handling particle depletion -------------- */
 std::vector<std::unique_ptr<State>> Model::generateParticles(
@@ -145,6 +200,44 @@ std::vector<std::unique_ptr<State>> Model::generateParticles(
     return particles;
 }
 
+std::vector<std::pair<std::unique_ptr<State>, double>> Model::getExpectedParticleCounts(
+        BeliefNode */*previousBelief*/, Action const &/*action*/, Observation const &/*obs*/,
+        long /*nParticles*/, std::vector<State const *> const &/*previousParticles*/) {
+    return std::vector<std::pair<std::unique_ptr<State>, double>>();
+}
+
+std::vector<std::unique_ptr<State>> Model::drawParticles(
+        std::vector<std::pair<std::unique_ptr<State>, double>> const &expectedCounts,
+        long first, long last) {
+    std::vector<std::unique_ptr<State>> particles;
+    for (long index = first; index < last; index++) {
+        State const &state = *expectedCounts[index].first;
+        double expectedCount = expectedCounts[index].second;
+        long count = static_cast<long>(expectedCount);
+        if (expectedCount > count && std::bernoulli_distribution(expectedCount - count)(
+                *getRandomGenerator())) {
+            count++;
+        }
+        for (long i = 0; i < count; i++) {
+            particles.push_back(state.copy());
+        }
+    }
+    return particles;
+}
+
+std::size_t Model::getParticleBin(State const &state) {
+    return state.hash();
+}
+
+std::unique_ptr<State> Model::generateRejuvenationProposal(State const &/*state*/) {
+    return nullptr;
+}
+
+std::function<double(State const &)> Model::createHistoryLikelihood(
+        BeliefNode const */*belief*/) {
+    return nullptr;
+}
+
 
 /* --------------- Pretty printing methods ----------------- */
 void Model::drawEnv(std::ostream &/*os*/) {
@@ -170,6 +263,11 @@ std::unique_ptr<Action> Model::getRolloutAction(HistoryEntry const */*entry*/,
     return nullptr;
 }
 
+std::vector<std::pair<std::unique_ptr<Observation>, std::unique_ptr<Action>>>
+Model::getFallbackActions() {
+    return std::vector<std::pair<std::unique_ptr<Observation>, std::unique_ptr<Action>>>();
+}
+
 /* ------- Customization of more complex solver functionality  --------- */
 std::unique_ptr<StateIndex> Model::createStateIndex() {
     // Use an RTree, with the correct # of state variables.
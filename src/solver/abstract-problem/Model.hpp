@@ -15,8 +15,11 @@
 #ifndef SOLVER_MODEL_HPP_
 #define SOLVER_MODEL_HPP_
 
+#include <cstddef>                      // for size_t
+#include <functional>                   // for function
 #include <memory>                       // for unique_ptr
 #include <ostream>                      // for ostream
+#include <utility>                      // for pair
 #include <vector>                       // for vector
 
 #include "global.hpp"                     // for RandomGenerator
@@ -42,6 +45,7 @@ class SelectRecommendedActionStrategy;
 class Serializer;
 class Solver;
 class StateIndex;
+class StateInfo;
 class StatePool;
 
 /** An abstract class representing a black-box POMDP model for use by the ABT solver.
@@ -96,8 +100,29 @@ public:
     virtual ~Model() = default;
     _NO_COPY_OR_MOVE(Model);
 
+    /** Makes the model use a different random number generator on the current thread, for as
+     * long as an instance of this class exists.
+     *
+     * This gives each worker thread its own random stream when particles are replenished in
+     * parallel (see Options::replenishingThreads).
+     */
+    class ThreadRandomGenerator {
+    public:
+        /** Uses the given generator on the current thread until this instance is destroyed. */
+        ThreadRandomGenerator(RandomGenerator *randGen);
+        /** Goes back to the generator that was in use before. */
+        ~ThreadRandomGenerator();
+        _NO_COPY_OR_MOVE(ThreadRandomGenerator);
+
+    private:
+        /** The generator that was in use before. */
+        RandomGenerator *previous_;
+    };
+
     /* -------------------- Simple getters ---------------------- */
-    /** Returns the random number generator used by this model. */
+    /** Returns the random number generator used by this model - or, if there is a
+     * ThreadRandomGenerator for the current thread, the one it holds.
+     */
     RandomGenerator *getRandomGenerator() const;
     /** Returns the configuration options for this model. */
     Options const *getOptions() const;
@@ -138,6 +163,10 @@ public:
         std::unique_ptr<State> nextState = nullptr;
         /** True iff the next state is terminal. */
         bool isTerminal = false;
+        /** The StateInfo for the next state, if the solver already has one (e.g. from a memoized
+         * transition); in that case nextState may be nullptr.
+         */
+        StateInfo *nextStateInfo = nullptr;
     };
 
     /** Generates a full StepResult, including the next state, an observation, and the reward,
@@ -151,6 +180,41 @@ public:
             Action const &action
             ) = 0;
 
+    /** Returns the number of time steps taken by the given action; this is only used if
+     * Options::hasMacroActions is set.
+     *
+     * A macro-action runs several primitive steps within a single call to generateStep(); the
+     * reward it returns should already be discounted across those steps. The observation must
+     * be the same one generateObservation() gives for the resulting state, so it can only
+     * depend on the states along the way via the transition parameters. The default duration
+     * is 1.
+     */
+    virtual long getActionDuration(Action const &action);
+    /** Returns the discount to apply to everything after the given action, i.e. the discount
+     * factor raised to the power of the action's duration.
+     */
+    double getDiscountFactor(Action const &action);
+
+    /** Returns true iff the next state is always a deterministic function of the state and
+     * action, in which case the solver will memoize transitions and call generateStepToState()
+     * instead of generateStep() for any transition it has already seen.
+     *
+     * This requires all actions to be DiscretizedPoint instances. It is false by default.
+     */
+    virtual bool hasDeterministicTransitions();
+
+    /** Generates the rest of a StepResult - the observation, the reward and the terminal flag -
+     * for a transition whose next state is already known; result.nextState is left empty.
+     *
+     * The default implementation uses generateObservation() and generateReward(), so those
+     * methods must be implemented if hasDeterministicTransitions() returns true.
+     */
+    virtual StepResult generateStepToState(
+            State const &state,
+            Action const &action,
+            State const &nextState
+            );
+
     /** Generates the parameters for a next-state transition, if any are being used.
      *
      * This method is optional - the default implementation simply returns nullptr.
@@ -211,6 +275,34 @@ public:
     virtual void applyChanges(std::vector<std::unique_ptr<ModelChange>> const &changes,
             Solver *solver);
 
+    /** Prepares in advance for changes that will be applied later on via applyChanges(), with the
+     * same vector of changes and the same solver.
+     *
+     * This allows any work that doesn't depend on what happens in the meantime - e.g.
+     * recalculating distances on the changed map, or finding the affected states among those
+     * that already exist - to be done before the changes actually occur, so that applyChanges()
+     * itself is cheaper.
+     *
+     * This method may be called on a background thread while the solver is searching, so it must
+     * not change anything the model or the solver use in the meantime, and it must not access the
+     * solver's state pool or state index directly; the states that existed when preparation
+     * began are given instead, in order of ID.
+     *
+     * This method is optional - the default implementation does nothing.
+     */
+    virtual void prepareChanges(std::vector<std::unique_ptr<ModelChange>> const &changes,
+            Solver *solver, std::vector<StateInfo *> const &states);
+
+    /** Called by Solver::resetTree() before the old tree is discarded, with the belief node whose
+     * particles are about to become those of the new root.
+     *
+     * This allows a model that works out beliefs by replaying the history from the root to record
+     * what it knows about the new root while the path to it still exists.
+     *
+     * This method is optional - the default implementation does nothing.
+     */
+    virtual void resetRoot(BeliefNode const *newRoot);
+
 
     /* ------------ Methods for handling particle depletion -------------- */
     /** Generates new state particles based on the state particles of the previous node,
@@ -218,6 +310,10 @@ public:
      *
      * The default implementation uses rejection sampling, but this can be overridden to provide
      * a more efficient implementation.
+     *
+     * If Options::replenishingThreads is more than 1, both versions of this method are called
+     * from several threads at once, each for a share of the particles; they must then only
+     * read the model and the tree, and use getRandomGenerator() for all of their sampling.
      */
     virtual std::vector<std::unique_ptr<State>> generateParticles(BeliefNode *previousBelief,
             Action const &action, Observation const &obs, long nParticles,
@@ -235,6 +331,55 @@ public:
     virtual std::vector<std::unique_ptr<State>> generateParticles(BeliefNode *previousBelief,
             Action const &action, Observation const &obs, long nParticles);
 
+    /** Returns each possible next state, along with the number of copies of it (usually not a
+     * whole number) that are expected among nParticles new particles, given the state particles
+     * of the previous node, and the action and observation.
+     *
+     * This is optional, but lets the previous particles be weighed only once when particles are
+     * replenished on several threads (see Options::replenishingThreads); the drawing of the new
+     * particles, via drawParticles(), is then all that is split between them. The default
+     * returns an empty vector, in which case generateParticles() is called for each share.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<State>, double>> getExpectedParticleCounts(
+            BeliefNode *previousBelief, Action const &action, Observation const &obs,
+            long nParticles, std::vector<State const *> const &previousParticles);
+    /** Draws new particles for the entries of the given expected counts from first up to (but not
+     * including) last; each state is copied the whole number of times it is expected, plus once
+     * more with probability equal to the fractional part.
+     */
+    std::vector<std::unique_ptr<State>> drawParticles(
+            std::vector<std::pair<std::unique_ptr<State>, double>> const &expectedCounts,
+            long first, long last);
+
+    /** Returns the bin the given state falls into, for the purposes of KLD-sampling (see
+     * Options::useKldSampling); the number of particles kept for a belief grows with the number
+     * of distinct bins its particles occupy.
+     *
+     * By default every distinct state is its own bin, which suits discrete state spaces; models
+     * with continuous (or very large) state spaces should override this to group nearby states.
+     */
+    virtual std::size_t getParticleBin(State const &state);
+
+    /** Proposes a new state near the given one, for the Metropolis-Hastings moves used to
+     * rejuvenate newly replenished particles (see Options::rejuvenationSteps).
+     *
+     * The proposal must be symmetric, i.e. proposing y from x must be exactly as likely as
+     * proposing x from y. The default returns nullptr, which disables rejuvenation.
+     */
+    virtual std::unique_ptr<State> generateRejuvenationProposal(State const &state);
+    /** Returns a function giving the likelihood of the observation history leading to the given
+     * belief, for a state at that belief; proposed moves are accepted or rejected based on the
+     * ratio of these likelihoods.
+     *
+     * The likelihood need only be known up to a constant factor, but it is assumed that every
+     * state is equally likely a priori - otherwise the prior should be included. Since the
+     * function is created once for each replenished belief, any work that depends only on the
+     * history should be done here rather than in the function itself.
+     *
+     * The default returns an empty function, which disables rejuvenation.
+     */
+    virtual std::function<double(State const &)> createHistoryLikelihood(BeliefNode const *belief);
+
 
     /* ------------------- Pretty printing methods --------------------- */
     /** Draws the environment map (independent of the current state or belief) onto
@@ -278,6 +423,16 @@ public:
     virtual std::unique_ptr<Action> getRolloutAction(HistoryEntry const *entry, State const *state,
             HistoricalData const *data);
 
+    /** Returns a fallback action for each observation this model can list; these are written
+     * into exported decision tables (see DecisionTableExporter), for histories that leave the
+     * table. Each action can only depend on that latest observation, so e.g. a QMDP or greedy
+     * action for the observation is a good choice.
+     *
+     * By default this returns an empty vector, and so the tables have no fallbacks.
+     */
+    virtual std::vector<std::pair<std::unique_ptr<Observation>, std::unique_ptr<Action>>>
+    getFallbackActions();
+
     /* ------- Customization of more complex solver functionality  --------- */
     // These are factory methods to allow the data structures used by ABT to be chosen in a
     // customizable way.
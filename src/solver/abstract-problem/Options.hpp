@@ -35,6 +35,13 @@ struct Options : options::BaseOptions {
     /* ------------------- Generic POMDP parameters --------------- */
     /** The discount factor of the PODMP. */
     double discountFactor = 1.0;
+    /** True iff some actions are macro-actions that last for several time steps, so that the
+     * discount after each action depends on its duration (see Model::getActionDuration()).
+     *
+     * Of the bundled problems, Tag and RockSample provide macro-actions (see
+     * TagOptions::macroActionLength and RockSampleOptions::macroActionLength).
+     */
+    bool hasMacroActions = false;
 
     /* ------------------------- ABT settings --------------------- */
     /** Whether to prune the tree on every simulation step. */
@@ -42,20 +49,108 @@ struct Options : options::BaseOptions {
     /** Whether to store encountered states in an indexing data structure for lookups.
      * NOTE: this is usually mandatory for handling model changes. */
     bool useStateIndex = true;
+    /** Whether to look up each new state in the StatePool to avoid storing duplicates.
+     * If states rarely repeat (e.g. in continuous state spaces), turning this off
+     * stores states append-only and defers indexing until the index is actually needed.
+     */
+    bool deduplicateStates = true;
     /** Whether to completely re-build the tree from scratch if changes occur. */
     bool resetOnChanges = false;
     /** The minimum number of particles to maintain in the active belief node. */
     unsigned long minParticleCount = 1000;
+    /** Whether to choose the number of particles for each replenished belief via KLD-sampling,
+     * instead of always using minParticleCount.
+     *
+     * The particles are sorted into bins (see Model::getParticleBin()), and enough are kept that,
+     * with probability given by kldQuantile, the K-L divergence between the particle
+     * approximation and the true belief is at most kldError. Concentrated beliefs thus need far
+     * fewer particles than diffuse ones.
+     */
+    bool useKldSampling = false;
+    /** The maximum K-L divergence allowed by KLD-sampling. */
+    double kldError = 0.05;
+    /** The upper standard normal quantile for the confidence of the KLD-sampling bound
+     * (2.326 => 99%).
+     */
+    double kldQuantile = 2.326;
+    /** The fewest particles KLD-sampling will keep for a belief. */
+    unsigned long kldMinParticleCount = 100;
+    /** The most particles KLD-sampling will keep for a belief. */
+    unsigned long kldMaxParticleCount = 10000;
+    /** The number of Metropolis-Hastings moves to make for each newly replenished particle, in
+     * order to spread out particles that were resampled onto the same states; 0 => none.
+     *
+     * This requires the model to provide a proposal and a history likelihood (see
+     * Model::generateRejuvenationProposal() and Model::createHistoryLikelihood()).
+     */
+    unsigned long rejuvenationSteps = 0;
+    /** The number of threads used to generate new particles when a belief is replenished; the
+     * particles are split evenly between the threads, each with its own random stream.
+     * (1 => generate them all on the calling thread, as usual)
+     *
+     * The model's generateParticles() methods must be safe to call concurrently; see
+     * Model::generateParticles().
+     */
+    unsigned long replenishingThreads = 1;
     /** The number of new histories to generate on each search step. */
     unsigned long historiesPerStep = 1000;
     /** The maximum time (in milliseconds) to spend on each search step. */
     double stepTimeout = 1000;
     /** The maximum depth to search, relative to the current belief node. */
     long maximumDepth = 100;
+    /** If positive, searches become open-loop at this depth relative to the node they start from:
+     * below it, all of the observations following each action share a single child node, so that
+     * statistics are only kept for sequences of actions. 0 => closed-loop search at all depths.
+     */
+    long openLoopDepth = 0;
     /** True if the depth horizon is relative to the starting belief, and false if it is
      * relative to the current belief.
      */
     bool isAbsoluteHorizon = false;
+    /** The number of steps of sampled rewards in each backed-up Q-value before it bootstraps from
+     * the estimated value of a belief (see EstimationStrategy).
+     *
+     * 1 => the usual backup: the immediate reward, plus the discounted value of the next belief.
+     * For n > 1 each action keeps n separate totals, so that every Q-value is an n-step return;
+     * each belief then backs up its estimate to the totals for one step, and the average of its
+     * totals for k steps to those for k + 1 steps.
+     *
+     * With the mean() estimator all of these are the same Monte Carlo average, so this only
+     * matters when the estimator bootstraps, e.g. max().
+     */
+    long backupSteps = 1;
+    /** If positive, each belief backs up (1 - backupLambda) times its estimated value plus
+     * backupLambda times the average of the sampled returns from it, which gives TD(lambda)
+     * returns (0 => the estimated value only; 1 => Monte Carlo returns).
+     *
+     * This is ignored if backupSteps > 1.
+     */
+    double backupLambda = 0;
+    /** Whether to choose the action at the node being searched from via sequential halving,
+     * instead of UCB, whenever the search has a fixed budget of histories or time.
+     *
+     * The budget is split into rounds; in each round the remaining candidate actions are tried
+     * equally often (deeper nodes still use UCB), and the worse half of them are then discarded.
+     * The last action remaining is the one recommended for that node.
+     *
+     * This requires a discrete action space; otherwise the solver warns and searches as usual.
+     */
+    bool useSequentialHalving = false;
+    /** The maximum number of extra steps past each new leaf node that are kept as real history
+     * entries and belief nodes, following the model's rollout policy, before the search heuristic
+     * is applied. 0 => only one new node is created per history.
+     *
+     * The number actually kept is adaptive: one step for every rolloutExpansionVisitThreshold
+     * visits to the belief the history was extended from (usually the current belief), up to
+     * this maximum, and none once the tree has rolloutExpansionNodeLimit belief nodes. New leaves
+     * are only ever created below nodes with untried actions, whose own visit counts stay small,
+     * so this means the tree only deepens faster once the upper levels are well sampled.
+     */
+    long rolloutExpansionSteps = 0;
+    /** The number of visits to the belief being searched from per extra step kept. */
+    long rolloutExpansionVisitThreshold = 100;
+    /** The number of belief nodes above which no extra steps are kept (0 => no limit). */
+    long rolloutExpansionNodeLimit = 0;
 
     /* ----------------------- TAPIR output modes ------------------- */
     /** True iff color output is allowed. */
@@ -0,0 +1,92 @@
+/** @file NeighbourHeuristic.cpp
+ *
+ * Contains the implementation of the NeighbourHeuristic class.
+ */
+#include "solver/abstract-problem/heuristics/NeighbourHeuristic.hpp"
+
+#include <vector>
+
+#include "solver/HistoryEntry.hpp"
+#include "solver/Solver.hpp"
+#include "solver/StateInfo.hpp"
+#include "solver/StatePool.hpp"
+
+#include "solver/abstract-problem/VectorState.hpp"
+
+#include "solver/indexing/RTree.hpp"
+#include "solver/indexing/SpatialIndexVisitor.hpp"
+
+namespace solver {
+/** A visitor that simply collects the StateInfo instances it visits, in order. */
+class NeighbourCollectingVisitor : public SpatialIndexVisitor {
+public:
+    /** Creates a new visitor for the given pool. */
+    NeighbourCollectingVisitor(StatePool *pool) :
+            SpatialIndexVisitor(pool),
+            neighbours() {
+    }
+    virtual ~NeighbourCollectingVisitor() = default;
+    _NO_COPY_OR_MOVE(NeighbourCollectingVisitor);
+
+    virtual void visit(StateInfo *info) override {
+        neighbours.push_back(info);
+    }
+
+    /** The neighbours visited so far, in the order they were visited. */
+    std::vector<StateInfo *> neighbours;
+};
+
+NeighbourHeuristic::NeighbourHeuristic(Solver *solver, unsigned long numberOfNeighbours,
+        HeuristicFunction fallbackHeuristic) :
+        solver_(solver),
+        numberOfNeighbours_(numberOfNeighbours),
+        fallbackHeuristic_(fallbackHeuristic) {
+}
+
+double NeighbourHeuristic::getHeuristicValue(HistoryEntry const *entry,
+        State const *state, HistoricalData const *data) {
+    StatePool *pool = solver_->getStatePool();
+    RTree *tree = dynamic_cast<RTree *>(pool->getStateIndex());
+    if (tree == nullptr) {
+        return fallbackHeuristic_(entry, state, data);
+    }
+
+    NeighbourCollectingVisitor visitor(pool);
+    tree->nearestNeighbourQuery(visitor,
+            static_cast<VectorState const *>(state)->asVector(), numberOfNeighbours_);
+
+    HistorySequence const *ownSequence = nullptr;
+    if (entry != nullptr) {
+        ownSequence = entry->getOwningSequence();
+    }
+
+    // The neighbours come closest first, so we stop as soon as we have enough entries.
+    double totalValue = 0;
+    unsigned long numberOfEntries = 0;
+    for (StateInfo *info : visitor.neighbours) {
+        for (HistoryEntry *otherEntry : info->getUsedInHistoryEntries()) {
+            if (otherEntry->getOwningSequence() == ownSequence) {
+                continue;
+            }
+            totalValue += otherEntry->getCumulativeReward();
+            numberOfEntries++;
+            if (numberOfEntries >= numberOfNeighbours_) {
+                break;
+            }
+        }
+        if (numberOfEntries >= numberOfNeighbours_) {
+            break;
+        }
+    }
+
+    if (numberOfEntries == 0) {
+        return fallbackHeuristic_(entry, state, data);
+    }
+    return totalValue / numberOfEntries;
+}
+
+HeuristicFunction NeighbourHeuristic::asFunction() {
+    using namespace std::placeholders;
+    return std::bind(&NeighbourHeuristic::getHeuristicValue, this, _1, _2, _3);
+}
+} /* namespace solver */
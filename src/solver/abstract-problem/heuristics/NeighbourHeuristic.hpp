@@ -0,0 +1,54 @@
+/** @file NeighbourHeuristic.hpp
+ *
+ * Defines a heuristic that estimates the value of a state from the histories that have already
+ * passed through the states nearest to it.
+ */
+#ifndef SOLVER_NEIGHBOURHEURISTIC_HPP_
+#define SOLVER_NEIGHBOURHEURISTIC_HPP_
+
+#include "global.hpp"
+
+#include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
+
+namespace solver {
+class HistoryEntry;
+class Solver;
+
+/** A heuristic that estimates the value of a state as the mean cumulative discounted reward of
+ * the history entries at the nearest states in the solver's RTree.
+ *
+ * Since every history entry keeps its cumulative reward up to date, each query only costs a
+ * single k-nearest-neighbour lookup plus O(k) work; at most k history entries are averaged.
+ * Entries from the sequence that is being estimated are ignored.
+ *
+ * The fallback heuristic is used whenever no such estimate is available - e.g. if the state pool
+ * has no RTree (useStateIndex = false), or if none of the neighbours have any usable entries.
+ *
+ * This requires the model's states to implement VectorState, as for the RTree itself.
+ */
+class NeighbourHeuristic {
+public:
+    /** Constructs a new neighbour-based heuristic for the given solver, which will average over
+     * (at most) the given number of neighbouring history entries.
+     */
+    NeighbourHeuristic(Solver *solver, unsigned long numberOfNeighbours,
+            HeuristicFunction fallbackHeuristic);
+    ~NeighbourHeuristic() = default;
+    _NO_COPY_OR_MOVE(NeighbourHeuristic);
+
+    /** Uses the neighbouring history entries to generate a heuristic value for the given
+     * entry, state and data.
+     */
+    double getHeuristicValue(HistoryEntry const *entry,
+            State const *state, HistoricalData const *data);
+
+    /** Returns this heuristic as an actual HeuristicFunction. */
+    HeuristicFunction asFunction();
+private:
+    Solver *solver_;
+    unsigned long numberOfNeighbours_;
+    HeuristicFunction fallbackHeuristic_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_NEIGHBOURHEURISTIC_HPP_ */
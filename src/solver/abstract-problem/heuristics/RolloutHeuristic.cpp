@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "solver/HistoryEntry.hpp"
+#include "solver/StateInfo.hpp"
 
 #include "solver/abstract-problem/HistoricalData.hpp"
 #include "solver/abstract-problem/Model.hpp"
@@ -28,15 +29,18 @@ double RolloutHeuristic::getHeuristicValue(HistoryEntry const *entry,
             entry, state, data);
     double value = 0.0;
     double netDiscount = 1.0;
-    double discountFactor = model_->getOptions()->discountFactor;
 
     Model::StepResult result = generator->getStep(entry, state, data);
     std::unique_ptr<State> currentState = state->copy();
     std::unique_ptr<HistoricalData> currentData = nullptr;
     while (result.action != nullptr) {
         value += netDiscount * result.reward;
-        netDiscount *= discountFactor;
+        netDiscount *= model_->getDiscountFactor(*result.action);
 
+        // The first step may have come from a memoized transition, i.e. with no nextState.
+        if (result.nextState == nullptr) {
+            result.nextState = result.nextStateInfo->getState()->copy();
+        }
         currentState = result.nextState->copy();
         if (data != nullptr) {
             currentData = data->createChild(*result.action, *result.observation);
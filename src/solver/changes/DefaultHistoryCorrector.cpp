@@ -203,6 +203,9 @@ bool DefaultHistoryCorrector::reviseSequence(HistorySequence *sequence) {
 
         // Now we backup the sequence.
         getSolver()->updateSequence(sequence, +1, divergingEntryId, false);
+    } else {
+        // No backup => the cumulative rewards must be updated here; later entries are unchanged.
+        sequence->updateCumulativeRewards(getModel(), entry->entryId_);
     }
 
     // Reset change flags for the sequence as a whole.
@@ -99,4 +99,10 @@ void RTree::boxQuery(SpatialIndexVisitor& visitor,
     tree_->containsWhatQuery(region, visitor);
 }
 
+void RTree::nearestNeighbourQuery(SpatialIndexVisitor &visitor,
+        std::vector<double> point, unsigned long k) {
+    SpatialIndex::Point queryPoint(&point[0], nSDim_);
+    tree_->nearestNeighborQuery(k, queryPoint, visitor);
+}
+
 } /* namespace solver */
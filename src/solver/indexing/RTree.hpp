@@ -59,6 +59,12 @@ class RTree : public StateIndex {
             std::vector<double> lowCorner,
             std::vector<double> highCorner);
 
+    /** Performs a k-nearest-neighbour query on the RTree. The (up to) k StateInfo closest to the
+     * given point will be passed on to the given visitor, in order of increasing distance.
+     */
+    virtual void nearestNeighbourQuery(SpatialIndexVisitor &visitor,
+            std::vector<double> point, unsigned long k);
+
   private:
     /** The number of state dimensions for this RTree. */
     unsigned int nSDim_;
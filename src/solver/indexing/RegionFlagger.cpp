@@ -0,0 +1,206 @@
+/** @file RegionFlagger.cpp
+ *
+ * Contains the implementation of the RegionFlagger class.
+ */
+#include "solver/indexing/RegionFlagger.hpp"
+
+#include <algorithm>
+
+#include "solver/StateInfo.hpp"
+#include "solver/StatePool.hpp"
+
+#include "solver/abstract-problem/VectorState.hpp"
+
+#include "solver/changes/ChangeFlags.hpp"
+
+#include "solver/indexing/RTree.hpp"
+#include "solver/indexing/SpatialIndexVisitor.hpp"
+
+namespace solver {
+/** A visitor that accumulates flags for each StateInfo it visits, without applying them. */
+class FlagAccumulatingVisitor : public SpatialIndexVisitor {
+public:
+    /** Creates a new visitor for the given pool. */
+    FlagAccumulatingVisitor(StatePool *pool) :
+            SpatialIndexVisitor(pool),
+            flagsToSet(ChangeFlags::UNCHANGED),
+            allFlags(pool->getNumberOfStates(), ChangeFlags::UNCHANGED),
+            visitedStates() {
+    }
+    virtual ~FlagAccumulatingVisitor() = default;
+    _NO_COPY_OR_MOVE(FlagAccumulatingVisitor);
+
+    virtual void visit(StateInfo *info) override {
+        ChangeFlags &flags = allFlags[info->getId()];
+        if (flags == ChangeFlags::UNCHANGED) {
+            visitedStates.push_back(info);
+        }
+        flags |= flagsToSet;
+    }
+
+    /** The flags for the region currently being queried. */
+    ChangeFlags flagsToSet;
+    /** The accumulated flags for each state, by ID. */
+    std::vector<ChangeFlags> allFlags;
+    /** The states that have been visited, in the order they were first visited. */
+    std::vector<StateInfo *> visitedStates;
+};
+
+RegionFlagger::RegionFlagger(StatePool *pool, double resolution) :
+        pool_(pool),
+        resolution_(resolution),
+        regions_(),
+        numberOfPreparedStates_(-1),
+        preparedFlags_() {
+}
+
+void RegionFlagger::addRegion(std::vector<double> lowCorner, std::vector<double> highCorner,
+        ChangeFlags flags) {
+    if (flags == ChangeFlags::UNCHANGED) {
+        return;
+    }
+    regions_.push_back(Region { std::move(lowCorner), std::move(highCorner), flags });
+    numberOfPreparedStates_ = -1;
+    preparedFlags_.clear();
+}
+
+long RegionFlagger::getNumberOfRegions() const {
+    return regions_.size();
+}
+
+void RegionFlagger::prepare(std::vector<StateInfo *> const &states) {
+    mergeRegions();
+
+    numberOfPreparedStates_ = states.size();
+    preparedFlags_.clear();
+    for (StateInfo *info : states) {
+        ChangeFlags flags = getFlags(info);
+        if (flags != ChangeFlags::UNCHANGED) {
+            preparedFlags_.emplace_back(info, flags);
+        }
+    }
+}
+
+long RegionFlagger::flagStates(RTree *tree) {
+    long numberOfStatesFlagged = 0;
+    if (numberOfPreparedStates_ == -1) {
+        mergeRegions();
+
+        FlagAccumulatingVisitor visitor(pool_);
+        for (Region const &region : regions_) {
+            visitor.flagsToSet = region.flags;
+            tree->boxQuery(visitor, region.lowCorner, region.highCorner);
+        }
+        for (StateInfo *info : visitor.visitedStates) {
+            pool_->setChangeFlags(info, visitor.allFlags[info->getId()]);
+        }
+        numberOfStatesFlagged = visitor.visitedStates.size();
+    } else {
+        for (std::pair<StateInfo *, ChangeFlags> const &entry : preparedFlags_) {
+            pool_->setChangeFlags(entry.first, entry.second);
+        }
+        numberOfStatesFlagged = preparedFlags_.size();
+
+        // Only the states created since preparation still need to be checked.
+        long numberOfStates = pool_->getNumberOfStates();
+        for (long index = numberOfPreparedStates_; index < numberOfStates; index++) {
+            StateInfo *info = pool_->getInfoById(index);
+            ChangeFlags flags = getFlags(info);
+            if (flags != ChangeFlags::UNCHANGED) {
+                pool_->setChangeFlags(info, flags);
+                numberOfStatesFlagged++;
+            }
+        }
+    }
+
+    regions_.clear();
+    numberOfPreparedStates_ = -1;
+    preparedFlags_.clear();
+    return numberOfStatesFlagged;
+}
+
+ChangeFlags RegionFlagger::getFlags(StateInfo const *info) const {
+    std::vector<double> point = static_cast<VectorState const *>(info->getState())->asVector();
+    ChangeFlags flags = ChangeFlags::UNCHANGED;
+    for (Region const &region : regions_) {
+        bool isContained = true;
+        for (unsigned long d = 0; d < point.size(); d++) {
+            if (point[d] < region.lowCorner[d] || point[d] > region.highCorner[d]) {
+                isContained = false;
+                break;
+            }
+        }
+        if (isContained) {
+            flags |= region.flags;
+        }
+    }
+    return flags;
+}
+
+bool RegionFlagger::tryMerge(Region &region, Region const &other) const {
+    if (region.flags != other.flags) {
+        return false;
+    }
+
+    bool containsOther = true;
+    bool isContained = true;
+    long differingDimension = -1;
+    for (unsigned long d = 0; d < region.lowCorner.size(); d++) {
+        double lo = region.lowCorner[d];
+        double hi = region.highCorner[d];
+        double otherLo = other.lowCorner[d];
+        double otherHi = other.highCorner[d];
+        containsOther = containsOther && lo <= otherLo && otherHi <= hi;
+        isContained = isContained && otherLo <= lo && hi <= otherHi;
+        if (lo == otherLo && hi == otherHi) {
+            continue;
+        }
+        // The regions can only be combined if they differ along a single axis, and are
+        // close enough along that axis that no states fall between them.
+        if (differingDimension != -1 || otherLo > hi + resolution_
+                || lo > otherHi + resolution_) {
+            differingDimension = -2;
+        } else {
+            differingDimension = d;
+        }
+    }
+
+    if (containsOther) {
+        return true;
+    }
+    if (isContained || differingDimension >= 0) {
+        for (unsigned long d = 0; d < region.lowCorner.size(); d++) {
+            region.lowCorner[d] = std::min(region.lowCorner[d], other.lowCorner[d]);
+            region.highCorner[d] = std::max(region.highCorner[d], other.highCorner[d]);
+        }
+        return true;
+    }
+    return false;
+}
+
+void RegionFlagger::mergeRegions() {
+    // Sorting first means that runs of adjacent regions tend to be merged within a single pass.
+    std::sort(regions_.begin(), regions_.end(), [](Region const &a, Region const &b) {
+        if (a.flags != b.flags) {
+            return a.flags < b.flags;
+        }
+        return a.lowCorner < b.lowCorner;
+    });
+
+    bool hasMerged = true;
+    while (hasMerged) {
+        hasMerged = false;
+        for (unsigned long i = 0; i < regions_.size(); i++) {
+            unsigned long j = i + 1;
+            while (j < regions_.size() && regions_[j].flags == regions_[i].flags) {
+                if (tryMerge(regions_[i], regions_[j])) {
+                    regions_.erase(regions_.begin() + j);
+                    hasMerged = true;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+}
+} /* namespace solver */
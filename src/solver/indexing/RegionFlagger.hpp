@@ -0,0 +1,100 @@
+/** @file RegionFlagger.hpp
+ *
+ * Defines the RegionFlagger class, which batches up the regions of state space affected by a set
+ * of changes so that the affected states can be flagged in one go.
+ */
+#ifndef SOLVER_REGIONFLAGGER_HPP_
+#define SOLVER_REGIONFLAGGER_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "solver/changes/ChangeFlags.hpp"
+
+#include "global.hpp"
+
+namespace solver {
+class RTree;
+class StateInfo;
+class StatePool;
+
+/** Collects axis-aligned regions of state space, each with a set of change flags to apply to the
+ * states within it, and then flags all of the affected states at once.
+ *
+ * This is intended for models that receive many small changes in a single step, e.g. many
+ * individual obstacle cells. Rather than running a separate RTree query for each change, the
+ * regions are first merged - regions with the same flags are combined whenever their union is
+ * itself a box - and each affected StateInfo is then flagged exactly once, with the union of
+ * the flags of all the regions that contain it.
+ *
+ * The resolution is the spacing of state coordinates: two regions with the same flags that are
+ * separated by at most this distance along a single axis (and match along every other axis) are
+ * merged, since there can be no states in the gap between them. For grid-based problems this
+ * is 1; for continuous state spaces it should be 0.
+ */
+class RegionFlagger {
+public:
+    /** Constructs a new RegionFlagger for the given state pool, using the given resolution. */
+    RegionFlagger(StatePool *pool, double resolution);
+    ~RegionFlagger() = default;
+    _NO_COPY_OR_MOVE(RegionFlagger);
+
+    /** Adds a new region (with inclusive bounds), whose states should have the given flags. */
+    void addRegion(std::vector<double> lowCorner, std::vector<double> highCorner,
+            ChangeFlags flags);
+    /** Returns the number of regions currently waiting to be queried. */
+    long getNumberOfRegions() const;
+
+    /** Merges the regions and finds which of the given states they contain, but only records the
+     * flags for the affected states instead of setting them.
+     *
+     * The states must be the first states of the pool, in order of ID. Neither the pool nor the
+     * tree is used, so this can run while other threads add states to them.
+     *
+     * A later call to flagStates() will then set the recorded flags, and only needs to check the
+     * states that have been added to the pool since; this relies on states never being removed
+     * from the pool. Adding another region discards the recorded flags.
+     */
+    void prepare(std::vector<StateInfo *> const &states);
+    /** Merges the regions, queries them within the given tree, and flags the affected states;
+     * if prepare() was called, only the states added since then are checked.
+     *
+     * The pending regions are cleared afterwards; returns the number of states flagged.
+     */
+    long flagStates(RTree *tree);
+
+private:
+    /** A region of state space, and the flags to set within it. */
+    struct Region {
+        /** The lower corner of the region. */
+        std::vector<double> lowCorner;
+        /** The upper corner of the region. */
+        std::vector<double> highCorner;
+        /** The flags to set for states in this region. */
+        ChangeFlags flags;
+    };
+
+    /** If the union of the two given regions is also a box, stores the union in the first region
+     * and returns true; otherwise the regions are left as they are and false is returned.
+     */
+    bool tryMerge(Region &region, Region const &other) const;
+    /** Repeatedly merges regions until no more merges are possible. */
+    void mergeRegions();
+    /** Returns the union of the flags of the regions that contain the given state. */
+    ChangeFlags getFlags(StateInfo const *info) const;
+
+    /** The associated state pool. */
+    StatePool *pool_;
+    /** The spacing between states, within which adjacent regions can be merged. */
+    double resolution_;
+    /** The regions waiting to be queried. */
+    std::vector<Region> regions_;
+
+    /** The number of states given to prepare() (-1 => not prepared). */
+    long numberOfPreparedStates_;
+    /** The states found by prepare(), and the flags to set for each of them. */
+    std::vector<std::pair<StateInfo *, ChangeFlags>> preparedFlags_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_REGIONFLAGGER_HPP_ */
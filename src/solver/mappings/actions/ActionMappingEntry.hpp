@@ -39,6 +39,12 @@ public:
     virtual double getTotalQValue() const = 0;
     /** Returns the mean estimated Q-value for this entry. */
     virtual double getMeanQValue() const = 0;
+    /** Returns the (population) variance of the Q-value samples for this entry.
+     *
+     * Changes to the Q-value without any change in the visit count are treated as shifting every
+     * sample by the same amount, and hence do not change the variance.
+     */
+    virtual double getQValueVariance() const = 0;
     /** Returns true iff this action is legal (illegal => totally ignored). */
     virtual bool isLegal() const = 0;
 
@@ -246,6 +246,12 @@ double ContinuousActionMapEntry::getTotalQValue() const {
 double ContinuousActionMapEntry::getMeanQValue() const {
     return meanQValue_;
 }
+double ContinuousActionMapEntry::getQValueVariance() const {
+    if (visitCount_ <= 0) {
+        return 0;
+    }
+    return std::max(0.0, totalSquaredQValue_ / visitCount_ - meanQValue_ * meanQValue_);
+}
 bool ContinuousActionMapEntry::isLegal() const {
     return isLegal_;
 }
@@ -274,6 +280,17 @@ bool ContinuousActionMapEntry::update(long deltaNVisits, double deltaTotalQ) {
 		map->numberOfVisitedEntries--;
 	}
 
+	// Update the total of the squares; each new visit is a sample of deltaTotalQ / deltaNVisits,
+	// while a change without any new visits shifts all of the existing samples equally.
+	if (visitCount_ <= 0) {
+		totalSquaredQValue_ = 0;
+	} else if (deltaNVisits != 0) {
+		totalSquaredQValue_ += deltaTotalQ * deltaTotalQ / deltaNVisits;
+	} else {
+		double shift = deltaTotalQ / visitCount_;
+		totalSquaredQValue_ += shift * (2 * totalQValue_ + deltaTotalQ);
+	}
+
 	// Update the total Q
 	totalQValue_ += deltaTotalQ;
 
@@ -424,7 +441,8 @@ void ContinuousActionTextSerializer::saveActionMapEntry(const ThisActionMapEntry
 	os << " visitcount: " << entry.visitCount_;
 	os << " totalQvalue: " << entry.totalQValue_;
 	os << " meanQValue: " << entry.meanQValue_;
-	os << " hasChild: " << (entry.childNode != nullptr) << std::endl;
+	os << " hasChild: " << (entry.childNode != nullptr);
+	os << " totalSquaredQvalue: " << entry.totalSquaredQValue_ << std::endl;
 	if (entry.childNode != nullptr) {
 		save(*entry.childNode, os);
 	}
@@ -451,6 +469,14 @@ std::unique_ptr<ContinuousActionTextSerializer::ThisActionMapEntry> ContinuousAc
 	bool hasChild;
 	ss >> dummy >> hasChild;
 
+	// Older policies don't store the squares; for those the variance starts at zero.
+	if (!(ss >> dummy >> result->totalSquaredQValue_)) {
+		result->totalSquaredQValue_ = 0;
+		if (result->visitCount_ > 0) {
+			result->totalSquaredQValue_ = result->meanQValue_ * result->totalQValue_;
+		}
+	}
+
 	if (hasChild) {
 		result->childNode = std::make_unique<ActionNode>(result.get());
 	    load(*result->childNode, is);
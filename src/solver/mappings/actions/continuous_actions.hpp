@@ -451,6 +451,7 @@ public:
 	virtual long getVisitCount() const override;
 	virtual double getTotalQValue() const override;
 	virtual double getMeanQValue() const override;
+	virtual double getQValueVariance() const override;
 	virtual bool isLegal() const override;
 
 	/** Returns the bin number associated with this entry. */
@@ -480,6 +481,8 @@ protected:
 	long visitCount_ = 0;
 	/** The total Q-value for this edge. */
 	double totalQValue_ = 0;
+	/** The total of the squared Q-value samples for this edge. */
+	double totalSquaredQValue_ = 0;
 	/** The mean Q-value for this edge => should be equal to totalQValue_ / visitCount_ */
 	double meanQValue_ = 0;
 	/** True iff this edge is legal. */
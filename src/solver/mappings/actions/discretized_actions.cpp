@@ -157,6 +157,12 @@ double DiscretizedActionMapEntry::getTotalQValue() const {
 double DiscretizedActionMapEntry::getMeanQValue() const {
     return meanQValue_;
 }
+double DiscretizedActionMapEntry::getQValueVariance() const {
+    if (visitCount_ <= 0) {
+        return 0;
+    }
+    return std::max(0.0, totalSquaredQValue_ / visitCount_ - meanQValue_ * meanQValue_);
+}
 bool DiscretizedActionMapEntry::isLegal() const {
     return isLegal_;
 }
@@ -196,6 +202,17 @@ bool DiscretizedActionMapEntry::update(long deltaNVisits, double deltaTotalQ) {
         }
     }
 
+    // Update the total of the squares; each new visit is a sample of deltaTotalQ / deltaNVisits,
+    // while a change without any new visits shifts all of the existing samples equally.
+    if (visitCount_ <= 0) {
+        totalSquaredQValue_ = 0;
+    } else if (deltaNVisits != 0) {
+        totalSquaredQValue_ += deltaTotalQ * deltaTotalQ / deltaNVisits;
+    } else {
+        double shift = deltaTotalQ / visitCount_;
+        totalSquaredQValue_ += shift * (2 * totalQValue_ + deltaTotalQ);
+    }
+
     // Update the total Q
     totalQValue_ += deltaTotalQ;
 
@@ -278,6 +295,7 @@ void DiscretizedActionTextSerializer::saveActionMapping(
         os << "): " << entry.getMeanQValue() << " from ";
         os << entry.getVisitCount() << " visits; total: ";
         os << entry.getTotalQValue();
+        os << " squares: " << entry.totalSquaredQValue_;
         if (!entry.isLegal()) {
             os << " ILLEGAL";
         }
@@ -343,6 +361,11 @@ void DiscretizedActionTextSerializer::loadActionMapping(DiscretizedActionMap &di
         sstr2 >> meanQValue >> tmpStr;
         sstr2 >> visitCount >> tmpStr >> tmpStr;
         sstr2 >> totalQValue >> legalString;
+        // Older policies don't store the squares; for those the variance starts at zero.
+        double totalSquaredQValue = visitCount > 0 ? meanQValue * totalQValue : 0;
+        if (legalString == "squares:") {
+            sstr2 >> totalSquaredQValue >> legalString;
+        }
 
         bool hasChild = true;
         std::string tmpStr1, tmpStr2;
@@ -358,6 +381,7 @@ void DiscretizedActionTextSerializer::loadActionMapping(DiscretizedActionMap &di
         entry.meanQValue_ = meanQValue;
         entry.visitCount_ = visitCount;
         entry.totalQValue_ = totalQValue;
+        entry.totalSquaredQValue_ = totalSquaredQValue;
         entry.isLegal_ = (legalString != "ILLEGAL");
 
         // Read in the action node itself.
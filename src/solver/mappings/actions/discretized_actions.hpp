@@ -150,7 +150,8 @@ class DiscretizedActionMap: public solver::ActionMapping {
 /** A concrete class implementing ActionMappingEntry for a discretized action space.
  *
  * Each entry stores its bin number and a reference back to its parent map, as well as a child node,
- * visit count, total and mean Q-values, and a flag for whether or not the action is legal.
+ * visit count, total and mean Q-values, the total of the squared Q-values, and a flag for whether
+ * or not the action is legal.
  */
 class DiscretizedActionMapEntry : public solver::ActionMappingEntry {
     friend class DiscretizedActionMap;
@@ -163,6 +164,7 @@ class DiscretizedActionMapEntry : public solver::ActionMappingEntry {
     virtual long getVisitCount() const override;
     virtual double getTotalQValue() const override;
     virtual double getMeanQValue() const override;
+    virtual double getQValueVariance() const override;
     virtual bool isLegal() const override;
 
     /** Returns the bin number associated with this entry. */
@@ -182,6 +184,8 @@ class DiscretizedActionMapEntry : public solver::ActionMappingEntry {
     long visitCount_ = 0;
     /** The total Q-value for this edge. */
     double totalQValue_ = 0;
+    /** The total of the squared Q-value samples for this edge. */
+    double totalSquaredQValue_ = 0;
     /** The mean Q-value for this edge => should be equal to totalQValue_ / visitCount_ */
     double meanQValue_ = 0;
     /** True iff this edge is legal. */
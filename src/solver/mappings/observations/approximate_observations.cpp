@@ -8,6 +8,8 @@
 #include "global.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <iostream>
 #include <string>
@@ -24,22 +26,28 @@
 
 namespace solver {
 /* --------------------- ApproximateObservationPool --------------------- */
-ApproximateObservationPool::ApproximateObservationPool(Solver *solver, double maxDistance) :
+ApproximateObservationPool::ApproximateObservationPool(Solver *solver, double maxDistance,
+        double wideningCoefficient, double wideningExponent) :
         solver_(solver),
-        maxDistance_(maxDistance) {
+        maxDistance_(maxDistance),
+        wideningCoefficient_(wideningCoefficient),
+        wideningExponent_(wideningExponent) {
 }
 
 std::unique_ptr<ObservationMapping> ApproximateObservationPool::createObservationMapping(
         ActionNode *owner) {
-    return std::make_unique<ApproximateObservationMap>(owner, solver_, maxDistance_);
+    return std::make_unique<ApproximateObservationMap>(owner, solver_, maxDistance_,
+            wideningCoefficient_, wideningExponent_);
 }
 
 /* ---------------------- ApproximateObservationMap ---------------------- */
 ApproximateObservationMap::ApproximateObservationMap(ActionNode *owner, Solver *solver,
-        double maxDistance) :
+        double maxDistance, double wideningCoefficient, double wideningExponent) :
         ObservationMapping(owner),
         solver_(solver),
         maxDistance_(maxDistance),
+        wideningCoefficient_(wideningCoefficient),
+        wideningExponent_(wideningExponent),
         entries_(),
         totalVisitCount_(0) {
 }
@@ -93,7 +101,7 @@ ObservationMappingEntry *ApproximateObservationMap::getEntry(Observation const &
     return const_cast<ObservationMappingEntry *>(result);
 }
 ObservationMappingEntry const *ApproximateObservationMap::getEntry(Observation const &obs) const {
-    double shortestDistance = maxDistance_;
+    double shortestDistance = std::numeric_limits<double>::infinity();
     ApproximateObservationMapEntry const *bestEntry = nullptr;
     for (std::unique_ptr<ApproximateObservationMapEntry> const &entry : entries_) {
         double distance = entry->observation_->distanceTo(obs);
@@ -102,7 +110,19 @@ ObservationMappingEntry const *ApproximateObservationMap::getEntry(Observation c
             bestEntry = entry.get();
         }
     }
-    return bestEntry;
+    if (shortestDistance <= maxDistance_) {
+        return bestEntry;
+    }
+
+    // Too far from all of the entries => only use the closest one if we can't widen any more.
+    if (wideningCoefficient_ > 0) {
+        double maxChildren = wideningCoefficient_ * std::pow(
+                std::max(totalVisitCount_, 1L), wideningExponent_);
+        if (static_cast<double>(entries_.size()) >= maxChildren) {
+            return bestEntry;
+        }
+    }
+    return nullptr;
 }
 
 long ApproximateObservationMap::getTotalVisitCount() const {
@@ -32,20 +32,26 @@ class BeliefNode;
 /** An implementation of the ObservationPool interface that is based on a continuous observation
  * space.
  *
- * This class has a single field, which defines the maximum distance between an observation and
- * the base observation in order for them to be grouped together. In order for this to work, the
- * observation class also needs to implement the distanceTo() method in a meaningful way.
+ * The main field defines the maximum distance between an observation and the base observation in
+ * order for them to be grouped together. In order for this to work, the observation class also
+ * needs to implement the distanceTo() method in a meaningful way.
  *
  * Note that since the maximum distance is taken between each observation and the representative
  * observation for that entry, the actual maximum distance between any two observations that are
  * grouped together is 2 * maxDistance.
+ *
+ * Optionally, the mappings can also use progressive widening: a mapping that has been visited N
+ * times may only have up to k * N^alpha children. Once this limit is reached, observations that
+ * don't match any existing entry are grouped with the nearest one instead. A coefficient k <= 0
+ * disables this.
  */
 class ApproximateObservationPool: public solver::ObservationPool {
   public:
     /** Creates a new observation pool; the individual mappings created will group together
      * observations based on the given radius value.
      */
-    ApproximateObservationPool(Solver *solver, double maxDistance);
+    ApproximateObservationPool(Solver *solver, double maxDistance,
+            double wideningCoefficient = 0.0, double wideningExponent = 0.5);
     virtual ~ApproximateObservationPool() = default;
     _NO_COPY_OR_MOVE(ApproximateObservationPool);
 
@@ -56,12 +62,18 @@ class ApproximateObservationPool: public solver::ObservationPool {
     Solver *solver_;
     /** The maximum radius for observations to be grouped together. */
     double maxDistance_;
+    /** The coefficient k for progressive widening. */
+    double wideningCoefficient_;
+    /** The exponent alpha for progressive widening. */
+    double wideningExponent_;
 };
 
 /** A concrete class implementing ObservationMapping for a continuous set of observations.
  *
  * The mapping entries are stored in a vector; entries are then looked up by iterating over the
- * vector and finding the first entry that is within the maximum distance.
+ * vector and finding the closest entry that is within the maximum distance. If progressive
+ * widening is in use and no more children are allowed, the closest entry is used regardless of
+ * its distance.
  *
  * In effect, each entry is a sphere in the observation space, which is centered at the first
  * observation used to make that entry, and has a radius of the given maximum distance.
@@ -76,8 +88,12 @@ class ApproximateObservationMap: public solver::ObservationMapping {
 
     /** Creates a new ApproximateObservationMap which will be owned by the given ActionNode, and
      * for which the maximum distance for an entry to "match" is the given distance.
+     *
+     * If the widening coefficient is positive, the number of children is limited to
+     * wideningCoefficient * N^wideningExponent, where N is the total visit count.
      */
-    ApproximateObservationMap(ActionNode *owner, Solver *solver, double maxDistance);
+    ApproximateObservationMap(ActionNode *owner, Solver *solver, double maxDistance,
+            double wideningCoefficient = 0.0, double wideningExponent = 0.5);
     virtual ~ApproximateObservationMap() = default;
     _NO_COPY_OR_MOVE(ApproximateObservationMap);
 
@@ -102,6 +118,10 @@ class ApproximateObservationMap: public solver::ObservationMapping {
 
     /** The maximum distance for an observation to count as part of an entry. */
     double maxDistance_;
+    /** The coefficient k for progressive widening; <= 0 => no widening. */
+    double wideningCoefficient_;
+    /** The exponent alpha for progressive widening. */
+    double wideningExponent_;
     /** The vector of entries for this mapping. */
     std::vector<std::unique_ptr<ApproximateObservationMapEntry>> entries_;
 
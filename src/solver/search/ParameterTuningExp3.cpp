@@ -0,0 +1,259 @@
+/** @file ParameterTuningExp3.cpp
+ *
+ * Contains the implementation of ParameterTuningExp3, an EXP3-based meta-strategy for tuning
+ * search parameters online.
+ */
+#include "solver/search/ParameterTuningExp3.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "solver/abstract-problem/Model.hpp"
+#include "solver/abstract-problem/Options.hpp"
+
+#include "solver/BeliefNode.hpp"
+#include "solver/HistorySequence.hpp"
+#include "solver/HistoryEntry.hpp"
+#include "solver/Solver.hpp"
+
+namespace solver {
+ParameterTuningExp3::ParameterTuningExp3(Solver *solver, double explorationCoefficient,
+        double stepRatio, std::vector<Parameter> parameters, StrategyMaker makeStrategy) :
+            solver_(solver),
+            model_(solver_->getModel()),
+            explorationCoefficient_(explorationCoefficient),
+            stepRatio_(stepRatio),
+            makeStrategy_(makeStrategy),
+            parameters_(),
+            strategies_(),
+            lastRoot_(nullptr),
+            numberOfHistories_(0),
+            totalTime_(0.0) {
+    for (Parameter &parameter : parameters) {
+        parameter.value = std::max(parameter.minValue, std::min(parameter.maxValue,
+                parameter.value));
+        if (parameter.type != ParameterType::CONTINUOUS) {
+            parameter.value = std::round(parameter.value);
+        }
+        TunedParameter tuned;
+        tuned.parameter = std::move(parameter);
+        resetArms(tuned);
+        parameters_.push_back(std::move(tuned));
+    }
+}
+
+SearchStatus ParameterTuningExp3::extendAndBackup(HistorySequence *sequence, long maximumDepth) {
+    BeliefNode *rootNode = sequence->getFirstEntry()->getAssociatedBeliefNode();
+    if (rootNode != lastRoot_) {
+        if (lastRoot_ != nullptr) {
+            recentre();
+        }
+        lastRoot_ = rootNode;
+    }
+    double initialRootValue = rootNode->getCachedValue();
+
+    sampleArms();
+    SearchStrategy *strategy = getStrategy();
+    double startTime = tapir::clock_ms();
+    SearchStatus status = strategy->extendAndBackup(sequence, maximumDepth);
+    double timeUsed = tapir::clock_ms() - startTime;
+    numberOfHistories_++;
+    totalTime_ += timeUsed;
+
+    double reward = 0.0;
+    if (status != SearchStatus::UNINITIALIZED) {
+        rootNode->recalculateValue(); // Make sure the root node recalculates its value.
+        double deltaValue = rootNode->getCachedValue() - initialRootValue;
+        Options const *options = model_->getOptions();
+        double valueRange = options->maxVal - options->minVal;
+        if (!std::isfinite(valueRange) || valueRange <= 0) {
+            valueRange = 1.0;
+        }
+        // Unlike MultipleStrategiesExp3, decreases in the root's value count too; otherwise
+        // the arms that make the root's value noisier would be rewarded the most.
+        double averageTime = totalTime_ / numberOfHistories_;
+        double improvementRate = (deltaValue / valueRange) * averageTime
+                / std::max(timeUsed, 1e-3);
+        reward = 0.5 + 0.5 * std::max(-1.0, std::min(improvementRate, 1.0));
+    }
+    updateWeights(reward);
+    return status;
+}
+
+std::vector<ParameterTuningExp3::Parameter> ParameterTuningExp3::getParameters() const {
+    std::vector<Parameter> parameters;
+    for (TunedParameter const &tuned : parameters_) {
+        parameters.push_back(tuned.parameter);
+    }
+    return parameters;
+}
+
+void ParameterTuningExp3::printParameters(std::ostream &os) const {
+    for (unsigned long index = 0; index < parameters_.size(); index++) {
+        Parameter const &parameter = parameters_[index].parameter;
+        if (index > 0) {
+            os << " ";
+        }
+        os << parameter.name << "=";
+        long labelNo = static_cast<long>(parameter.value - parameter.minValue);
+        if (parameter.type == ParameterType::CATEGORICAL
+                && labelNo < static_cast<long>(parameter.labels.size())) {
+            os << parameter.labels[labelNo];
+        } else {
+            os << parameter.value;
+        }
+    }
+}
+
+void ParameterTuningExp3::resetArms(TunedParameter &tuned) {
+    Parameter const &parameter = tuned.parameter;
+    tuned.arms.clear();
+    if (parameter.type == ParameterType::CATEGORICAL) {
+        for (double value = parameter.minValue; value <= parameter.maxValue; value++) {
+            tuned.arms.push_back(value);
+        }
+    } else {
+        double lower = parameter.value / stepRatio_;
+        double upper = parameter.value * stepRatio_;
+        if (parameter.type == ParameterType::INTEGER) {
+            // Make sure the arms stay distinct even for small values.
+            lower = std::min(std::round(lower), parameter.value - 1);
+            upper = std::max(std::round(upper), parameter.value + 1);
+        }
+        tuned.arms.push_back(parameter.value);
+        if (std::max(lower, parameter.minValue) < parameter.value) {
+            tuned.arms.push_back(std::max(lower, parameter.minValue));
+        }
+        if (std::min(upper, parameter.maxValue) > parameter.value) {
+            tuned.arms.push_back(std::min(upper, parameter.maxValue));
+        }
+    }
+    tuned.weights.assign(tuned.arms.size(), 1.0);
+    tuned.probabilities.assign(tuned.arms.size(), 1.0 / tuned.arms.size());
+    tuned.counts.assign(tuned.arms.size(), 0);
+    tuned.rewardTotals.assign(tuned.arms.size(), 0.0);
+    tuned.squaredRewardTotals.assign(tuned.arms.size(), 0.0);
+    tuned.chosenArm = 0;
+}
+
+long ParameterTuningExp3::getBestArm(TunedParameter const &tuned) const {
+    std::vector<double> means;
+    std::vector<double> variances;
+    for (unsigned long arm = 0; arm < tuned.arms.size(); arm++) {
+        long count = tuned.counts[arm];
+        if (count < 2) {
+            means.push_back(0.0);
+            variances.push_back(std::numeric_limits<double>::infinity());
+            continue;
+        }
+        double mean = tuned.rewardTotals[arm] / count;
+        means.push_back(mean);
+        variances.push_back((tuned.squaredRewardTotals[arm] / count - mean * mean) / (count - 1));
+    }
+
+    // Continuous arms start with the current value; categorical arms run from the minimum value.
+    long currentArm = 0;
+    if (tuned.parameter.type == ParameterType::CATEGORICAL) {
+        currentArm = std::lround(tuned.parameter.value - tuned.parameter.minValue);
+    }
+    long bestArm = currentArm;
+    for (long arm = 0; arm < static_cast<long>(tuned.arms.size()); arm++) {
+        if (arm == currentArm) {
+            continue;
+        }
+        double difference = means[arm] - means[bestArm];
+        if (difference > 2 * std::sqrt(variances[arm] + variances[bestArm])) {
+            bestArm = arm;
+        }
+    }
+    return bestArm;
+}
+
+void ParameterTuningExp3::recentre() {
+    bool hasMoved = false;
+    for (TunedParameter &tuned : parameters_) {
+        long bestArm = getBestArm(tuned);
+        tuned.parameter.value = tuned.arms[bestArm];
+        if (tuned.parameter.type != ParameterType::CATEGORICAL) {
+            hasMoved = hasMoved || bestArm != 0;
+            resetArms(tuned);
+        }
+    }
+    if (hasMoved) {
+        // The cached strategies are indexed by arm, so they no longer match.
+        strategies_.clear();
+    }
+
+    if (model_->getOptions()->hasVerboseOutput) {
+        std::cout << "Search parameters: ";
+        printParameters(std::cout);
+        std::cout << std::endl;
+    }
+}
+
+void ParameterTuningExp3::sampleArms() {
+    // This is called for every history, so it avoids the allocations of a discrete_distribution.
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    for (TunedParameter &tuned : parameters_) {
+        double sample = distribution(*model_->getRandomGenerator());
+        tuned.chosenArm = tuned.arms.size() - 1;
+        for (unsigned long arm = 0; arm < tuned.arms.size() - 1; arm++) {
+            sample -= tuned.probabilities[arm];
+            if (sample < 0) {
+                tuned.chosenArm = arm;
+                break;
+            }
+        }
+    }
+}
+
+void ParameterTuningExp3::updateWeights(double reward) {
+    for (TunedParameter &tuned : parameters_) {
+        tuned.counts[tuned.chosenArm]++;
+        tuned.rewardTotals[tuned.chosenArm] += reward;
+        tuned.squaredRewardTotals[tuned.chosenArm] += reward * reward;
+
+        double numberOfArms = tuned.arms.size();
+        if (numberOfArms < 2) {
+            continue;
+        }
+        tuned.weights[tuned.chosenArm] *= std::exp(explorationCoefficient_ * reward
+                / (numberOfArms * tuned.probabilities[tuned.chosenArm]));
+
+        // Rescale the weights so that they can't overflow; only their ratios matter.
+        double maxWeight = *std::max_element(tuned.weights.begin(), tuned.weights.end());
+        double weightTotal = 0.0;
+        for (double &weight : tuned.weights) {
+            weight /= maxWeight;
+            weightTotal += weight;
+        }
+        for (unsigned long arm = 0; arm < tuned.arms.size(); arm++) {
+            tuned.probabilities[arm] = ((1 - explorationCoefficient_) * tuned.weights[arm]
+                    / weightTotal + explorationCoefficient_ / numberOfArms);
+        }
+    }
+}
+
+SearchStrategy *ParameterTuningExp3::getStrategy() {
+    // The strategies are indexed by the chosen arms, as the digits of a mixed-radix number.
+    unsigned long index = 0;
+    unsigned long numberOfStrategies = 1;
+    for (TunedParameter const &tuned : parameters_) {
+        index = index * tuned.arms.size() + tuned.chosenArm;
+        numberOfStrategies *= tuned.arms.size();
+    }
+    strategies_.resize(numberOfStrategies);
+    std::unique_ptr<SearchStrategy> &strategy = strategies_[index];
+    if (strategy == nullptr) {
+        std::vector<double> values;
+        for (TunedParameter const &tuned : parameters_) {
+            values.push_back(tuned.arms[tuned.chosenArm]);
+        }
+        strategy = makeStrategy_(values);
+    }
+    return strategy.get();
+}
+} /* namespace solver */
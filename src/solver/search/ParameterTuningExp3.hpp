@@ -0,0 +1,154 @@
+/** @file ParameterTuningExp3.hpp
+ *
+ * Provides an EXP3-based meta-strategy that tunes the parameters of a search strategy online,
+ * e.g. the UCB exploration coefficient, the rollout depth, and the choice of heuristic.
+ */
+#ifndef SOLVER_PARAMETERTUNINGEXP3_HPP_
+#define SOLVER_PARAMETERTUNINGEXP3_HPP_
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "global.hpp"
+
+#include "solver/search/SearchStatus.hpp"
+#include "solver/search/search_interface.hpp"
+
+namespace solver {
+class BeliefNode;
+
+/** An implementation of the SearchStrategy interface that adapts the parameters of a search
+ * strategy while planning, instead of leaving them fixed for the whole run.
+ *
+ * Each parameter has a small set of candidate values ("arms") and its own EXP3 distribution over
+ * them. For each history, a value is sampled for every parameter, and the strategy with those
+ * values - made by the given StrategyMaker, and cached - extends the sequence. As with
+ * MultipleStrategiesExp3 the reward is the increase in the value of the root belief, but here it
+ * is also scaled by the average time per history over the time this history took, so the arms
+ * are compared by their value improvement per millisecond.
+ *
+ * A continuous parameter has three arms: its current value, and that value divided and multiplied
+ * by the step ratio. Whenever the search moves on to a new belief (i.e. on each step of an
+ * episode), the current value moves to the arm with the best mean reward - but only if that mean
+ * is higher than the current value's by more than twice the standard error of the difference,
+ * since the rewards are very noisy - and the arms are reset. Over a number of steps the value can
+ * thus drift as far as its bounds allow. A categorical
+ * parameter, e.g. an index into a list of heuristics, has one arm per value, and its weights are
+ * kept from one step to the next.
+ */
+class ParameterTuningExp3: public SearchStrategy {
+public:
+    /** The kinds of parameter that can be tuned. */
+    enum class ParameterType {
+        /** A real number; the arms are spaced geometrically. */
+        CONTINUOUS,
+        /** As for CONTINUOUS, but rounded to the nearest integer. */
+        INTEGER,
+        /** One of the integers from minValue to maxValue, with no ordering between them. */
+        CATEGORICAL
+    };
+
+    /** A parameter to be tuned. */
+    struct Parameter {
+        /** The name of the parameter, for output. */
+        std::string name = "";
+        /** The kind of parameter. */
+        ParameterType type = ParameterType::CONTINUOUS;
+        /** The current value of the parameter. */
+        double value = 0.0;
+        /** The smallest value allowed. */
+        double minValue = 0.0;
+        /** The largest value allowed. */
+        double maxValue = 0.0;
+        /** For a categorical parameter, an optional name for each value, for output. */
+        std::vector<std::string> labels = { };
+    };
+
+    /** A function that makes a search strategy with the given values for the parameters, in the
+     * same order as the parameters were given.
+     */
+    typedef std::function<std::unique_ptr<SearchStrategy>(std::vector<double> const &values)>
+        StrategyMaker;
+
+    /** Constructs a new meta-strategy for the given solver, which will tune the given parameters
+     * of the strategies made by the given function.
+     *
+     * The exploration coefficient is that of EXP3, and the step ratio sets the spacing of the
+     * arms for continuous parameters.
+     */
+    ParameterTuningExp3(Solver *solver, double explorationCoefficient, double stepRatio,
+            std::vector<Parameter> parameters, StrategyMaker makeStrategy);
+    virtual ~ParameterTuningExp3() = default;
+    _NO_COPY_OR_MOVE(ParameterTuningExp3);
+
+    virtual SearchStatus extendAndBackup(HistorySequence *sequence, long maximumDepth) override;
+
+    /** Returns the parameters, with the values they are currently centred on. */
+    std::vector<Parameter> getParameters() const;
+    /** Writes the current parameter values to the given stream, e.g. "ucb=2.5 rollout=4". */
+    virtual void printParameters(std::ostream &os) const override;
+
+private:
+    /** The tuning state for a single parameter. */
+    struct TunedParameter {
+        /** The parameter itself. */
+        Parameter parameter = { };
+        /** The candidate values. */
+        std::vector<double> arms = { };
+        /** The EXP3 weight of each arm. */
+        std::vector<double> weights = { };
+        /** The probability of sampling each arm. */
+        std::vector<double> probabilities = { };
+        /** The number of times each arm has been used. */
+        std::vector<long> counts = { };
+        /** The total reward for each arm. */
+        std::vector<double> rewardTotals = { };
+        /** The total squared reward for each arm. */
+        std::vector<double> squaredRewardTotals = { };
+        /** The arm used for the current history. */
+        long chosenArm = 0;
+    };
+
+    /** Sets up the arms of the given parameter around its current value, with equal weights. */
+    void resetArms(TunedParameter &tuned);
+    /** Returns the arm with the best mean reward for the given parameter, if it is significantly
+     * better than the arm of the current value, or the arm of the current value otherwise.
+     */
+    long getBestArm(TunedParameter const &tuned) const;
+    /** Moves each continuous parameter to its best arm, ready for a search from a new belief. */
+    void recentre();
+    /** Samples an arm for each parameter. */
+    void sampleArms();
+    /** Updates the weights of the chosen arms with the given reward, which should be in [0, 1]. */
+    void updateWeights(double reward);
+    /** Returns the strategy for the currently chosen arms, making it if necessary. */
+    SearchStrategy *getStrategy();
+
+    /** The associated solver. */
+    Solver *solver_;
+    /** The model of the associated solver. */
+    Model *model_;
+    /** The exploration coefficient for EXP3. */
+    double explorationCoefficient_;
+    /** The ratio between neighbouring arms of a continuous parameter. */
+    double stepRatio_;
+    /** The function used to make the strategies. */
+    StrategyMaker makeStrategy_;
+    /** The parameters being tuned. */
+    std::vector<TunedParameter> parameters_;
+    /** The strategies made so far for the current arms; see getStrategy() for the indexing. */
+    std::vector<std::unique_ptr<SearchStrategy>> strategies_;
+
+    /** The belief the last history was started from. */
+    BeliefNode *lastRoot_;
+    /** The total number of histories searched. */
+    long numberOfHistories_;
+    /** The total time spent on those histories, in milliseconds. */
+    double totalTime_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_PARAMETERTUNINGEXP3_HPP_ */
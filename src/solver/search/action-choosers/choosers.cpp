@@ -4,6 +4,10 @@
  */
 #include "solver/search/action-choosers/choosers.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "solver/BeliefNode.hpp"
 
 #include "solver/mappings/actions/ActionMapping.hpp"
@@ -11,6 +15,36 @@
 
 namespace solver {
 namespace choosers {
+namespace {
+/** Returns the legal, visited action with the highest value of the given index function, which
+ * is called with each entry and with the log of the total visit count.
+ */
+template<typename IndexFunction>
+std::unique_ptr<Action> max_index_action(BeliefNode const *node, IndexFunction index) {
+    std::unique_ptr<Action> bestAction = nullptr;
+    double maxValue = -std::numeric_limits<double>::infinity();
+
+    ActionMapping *mapping = node->getMapping();
+    double logTotalVisitCount = std::log(mapping->getTotalVisitCount());
+    for (ActionMappingEntry const *entry : mapping->getVisitedEntries()) {
+        // Ignore illegal actions.
+        if (!entry->isLegal()) {
+            continue;
+        }
+
+        double tmpValue = index(entry, logTotalVisitCount);
+        if (!std::isfinite(tmpValue)) {
+            debug::show_message("ERROR: Infinite/NaN value!?");
+        }
+        if (maxValue < tmpValue) {
+            maxValue = tmpValue;
+            bestAction = entry->getAction();
+        }
+    }
+    return bestAction;
+}
+} /* namespace */
+
 std::unique_ptr<Action> max_action(BeliefNode const *node) {
     std::unique_ptr<Action> maxAction = nullptr;
     double maxQValue = -std::numeric_limits<double>::infinity();
@@ -72,5 +106,27 @@ std::unique_ptr<Action> ucb_action(BeliefNode const *node, double explorationCoe
     }
     return std::move(ucbAction);
 }
+
+std::unique_ptr<Action> ucb_tuned_action(BeliefNode const *node, double valueRange) {
+    double rangeSquared = valueRange * valueRange;
+    return max_index_action(node,
+            [rangeSquared](ActionMappingEntry const *entry, double logTotalVisitCount) {
+        double logRatio = logTotalVisitCount / entry->getVisitCount();
+        double varianceBound = (entry->getQValueVariance()
+                + rangeSquared * std::sqrt(2 * logRatio));
+        return entry->getMeanQValue()
+                + std::sqrt(logRatio * std::min(rangeSquared / 4, varianceBound));
+    });
+}
+
+std::unique_ptr<Action> ucbv_action(BeliefNode const *node, double valueRange, double zeta) {
+    return max_index_action(node,
+            [valueRange, zeta](ActionMappingEntry const *entry, double logTotalVisitCount) {
+        double explorationRatio = zeta * logTotalVisitCount / entry->getVisitCount();
+        return entry->getMeanQValue()
+                + std::sqrt(2 * entry->getQValueVariance() * explorationRatio)
+                + 3 * valueRange * explorationRatio;
+    });
+}
 } /* namespace choosers */
 } /* namespace solver */
@@ -22,6 +22,17 @@ std::unique_ptr<Action> max_action(BeliefNode const *node);
 std::unique_ptr<Action> robust_action(BeliefNode const *node);
 /** Returns the action with the highest UCB value, using the given exploration coefficient. */
 std::unique_ptr<Action> ucb_action(BeliefNode const *node, double explorationCoefficient);
+/** Returns the action with the highest UCB1-Tuned value.
+ *
+ * The exploration term is bounded using the variance of each action's Q-values; since Q-values
+ * are not limited to [0, 1], the given range of the Q-values is used to scale the bound.
+ */
+std::unique_ptr<Action> ucb_tuned_action(BeliefNode const *node, double valueRange);
+/** Returns the action with the highest UCB-V value, i.e. an empirical Bernstein bound using the
+ * variance of each action's Q-values, the given range of the Q-values, and the given exploration
+ * rate zeta (which should be greater than 1).
+ */
+std::unique_ptr<Action> ucbv_action(BeliefNode const *node, double valueRange, double zeta);
 } /* namespace choosers */
 } /* namespace solver */
 
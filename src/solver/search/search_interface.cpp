@@ -7,9 +7,12 @@
  */
 #include "solver/search/search_interface.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 
+#include "solver/ActionNode.hpp"
 #include "solver/BeliefNode.hpp"
 #include "solver/BeliefTree.hpp"
 #include "solver/HistoryEntry.hpp"
@@ -17,12 +20,20 @@
 #include "solver/Solver.hpp"
 #include "solver/StatePool.hpp"
 
+#include "solver/abstract-problem/Options.hpp"
+
 #include "solver/abstract-problem/heuristics/HeuristicFunction.hpp"
 
 #include "solver/search/SearchStatus.hpp"
 
 #include "solver/search/action-choosers/choosers.hpp"
 
+#include "solver/search/steppers/default_rollout.hpp"
+
+#include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/ActionMappingEntry.hpp"
+#include "solver/mappings/observations/ObservationMapping.hpp"
+
 namespace solver {
 /* ----------------------- StepGenerator ------------------------- */
 StepGenerator::StepGenerator(SearchStatus &status) :
@@ -88,6 +99,12 @@ SearchStatus BasicSearchStrategy::extendAndBackup(HistorySequence *sequence, lon
     HistoryEntry *currentEntry = firstEntry;
     BeliefNode *currentNode = currentEntry->getAssociatedBeliefNode();
 
+    // Below this depth, the search is open-loop (if enabled).
+    long openLoopDepth = solver_->getOptions()->openLoopDepth;
+    if (openLoopDepth > 0) {
+        openLoopDepth += sequence->getFirstEntry()->getAssociatedBeliefNode()->getDepth();
+    }
+
     SearchStatus status = SearchStatus::UNINITIALIZED;
     std::unique_ptr<StepGenerator> generator = factory_->createGenerator(status, currentEntry,
             currentEntry->getState(), currentNode->getHistoricalData());
@@ -116,6 +133,11 @@ SearchStatus BasicSearchStrategy::extendAndBackup(HistorySequence *sequence, lon
             status = SearchStatus::OUT_OF_STEPS;
             break;
         }
+        if (solver_->isCancelled()) {
+            // Cancelled => cut the sequence short here; it is estimated and backed up as usual.
+            status = SearchStatus::OUT_OF_STEPS;
+            break;
+        }
         // Step the search forward.
         Model::StepResult result = generator->getStep(currentEntry, currentEntry->getState(),
                 currentNode->getHistoricalData());
@@ -125,24 +147,8 @@ SearchStatus BasicSearchStrategy::extendAndBackup(HistorySequence *sequence, lon
             break;
         }
 
-        // Set the parameters of the current history entry using the ones we got from the result.
-        currentEntry->immediateReward_ = result.reward;
-        currentEntry->action_ = std::move(result.action);
-        currentEntry->transitionParameters_ = std::move(result.transitionParameters);
-        currentEntry->observation_ = std::move(result.observation);
-
-        // Create the child belief node, and set the current node to be that node.
-        BeliefNode *nextNode = currentNode->createOrGetChild(*currentEntry->action_,
-                *currentEntry->observation_);
-        currentNode = nextNode;
-
-        // Now we create a new history entry and step the history forward.
-        StateInfo *nextStateInfo = solver_->getStatePool()->createOrGetInfo(*result.nextState);
-        currentEntry = sequence->addEntry();
-
-        // Register the new history entry with its state, and with its associated belief node.
-        currentEntry->registerState(nextStateInfo);
-        currentEntry->registerNode(currentNode);
+        currentEntry = addStep(sequence, result, openLoopDepth);
+        currentNode = currentEntry->getAssociatedBeliefNode();
 
         if (result.isTerminal) {
             // Terminal state => search complete.
@@ -151,6 +157,26 @@ SearchStatus BasicSearchStrategy::extendAndBackup(HistorySequence *sequence, lon
         }
     }
 
+    // Keep the first few steps of the rollout in the tree, instead of only using their value.
+    if (status == SearchStatus::OUT_OF_STEPS) {
+        SearchStatus expansionStatus = SearchStatus::UNINITIALIZED;
+        DefaultRolloutGenerator expansion(expansionStatus, solver_,
+                getNumberOfExpansionSteps(firstEntry->getAssociatedBeliefNode()));
+        while (currentNode->getDepth() < maximumDepth && !solver_->isCancelled()) {
+            Model::StepResult result = expansion.getStep(currentEntry, currentEntry->getState(),
+                    currentNode->getHistoricalData());
+            if (result.action == nullptr) {
+                break;
+            }
+            currentEntry = addStep(sequence, result, openLoopDepth);
+            currentNode = currentEntry->getAssociatedBeliefNode();
+            if (result.isTerminal) {
+                status = SearchStatus::FINISHED;
+                break;
+            }
+        }
+    }
+
     // OUT_OF_STEPS => must calculated a heuristic estimate.
     if (status == SearchStatus::OUT_OF_STEPS) {
         currentEntry->immediateReward_ = heuristic_(currentEntry, currentEntry->getState(),
@@ -183,6 +209,84 @@ SearchStatus BasicSearchStrategy::extendAndBackup(HistorySequence *sequence, lon
     return status;
 }
 
+HistoryEntry *BasicSearchStrategy::addStep(HistorySequence *sequence, Model::StepResult &result,
+        long openLoopDepth) {
+    HistoryEntry *currentEntry = sequence->getLastEntry();
+    BeliefNode *currentNode = currentEntry->getAssociatedBeliefNode();
+
+    // Set the parameters of the current history entry using the ones we got from the result.
+    currentEntry->immediateReward_ = result.reward;
+    currentEntry->action_ = std::move(result.action);
+    currentEntry->transitionParameters_ = std::move(result.transitionParameters);
+    currentEntry->observation_ = std::move(result.observation);
+
+    if (openLoopDepth > 0 && currentNode->getDepth() >= openLoopDepth) {
+        std::unique_ptr<Observation> observation = getOpenLoopObservation(currentNode,
+                *currentEntry->action_);
+        if (observation != nullptr && *observation != *currentEntry->observation_) {
+            // Once the observations differ, the rest of this sequence is open-loop.
+            if (sequence->openLoopEntryId_ == -1) {
+                sequence->openLoopEntryId_ = currentEntry->getId();
+            }
+            currentEntry->observation_ = std::move(observation);
+        }
+    }
+
+    // Create the child belief node.
+    BeliefNode *nextNode = currentNode->createOrGetChild(*currentEntry->action_,
+            *currentEntry->observation_);
+    // The observation may have been routed to a nearby child; record that child's own observation
+    // so that later lookups by observation find the same child.
+    currentEntry->observation_ = nextNode->getParentEntry()->getObservation();
+
+    // Now we create a new history entry and step the history forward.
+    StateInfo *nextStateInfo = result.nextStateInfo;
+    if (nextStateInfo == nullptr) {
+        nextStateInfo = solver_->getStatePool()->createOrGetInfo(*result.nextState);
+    }
+    HistoryEntry *nextEntry = sequence->addEntry();
+
+    // Register the new history entry with its state, and with its associated belief node.
+    nextEntry->registerState(nextStateInfo);
+    nextEntry->registerNode(nextNode);
+    return nextEntry;
+}
+
+long BasicSearchStrategy::getNumberOfExpansionSteps(BeliefNode const *root) {
+    Options const *options = solver_->getOptions();
+    if (options->rolloutExpansionSteps <= 0) {
+        return 0;
+    }
+    if (options->rolloutExpansionNodeLimit > 0
+            && solver_->getPolicy()->getNumberOfNodes() >= options->rolloutExpansionNodeLimit) {
+        return 0;
+    }
+    long nSteps = root->getMapping()->getTotalVisitCount();
+    if (options->rolloutExpansionVisitThreshold > 0) {
+        nSteps /= options->rolloutExpansionVisitThreshold;
+    }
+    return std::min(nSteps, options->rolloutExpansionSteps);
+}
+
+std::unique_ptr<Observation> BasicSearchStrategy::getOpenLoopObservation(BeliefNode *node,
+        Action const &action) {
+    ActionNode *actionNode = node->getMapping()->getActionNode(action);
+    if (actionNode == nullptr) {
+        return nullptr;
+    }
+    ObservationMappingEntry const *mostVisitedEntry = nullptr;
+    for (ObservationMappingEntry const *entry : actionNode->getMapping()->getChildEntries()) {
+        if (mostVisitedEntry == nullptr
+                || entry->getVisitCount() > mostVisitedEntry->getVisitCount()) {
+            mostVisitedEntry = entry;
+        }
+    }
+    if (mostVisitedEntry == nullptr) {
+        return nullptr;
+    }
+    return mostVisitedEntry->getObservation();
+}
+
 std::unique_ptr<Action> MaxRecommendedActionStrategy::getAction(const BeliefNode* belief) {
 	return choosers::max_action(belief);
 }
@@ -193,5 +297,64 @@ std::unique_ptr<Action> GpsMaxRecommendedActionStrategy::getAction(const BeliefN
 	return choosers::gps_max_action(belief, options).action;
 }
 
+QmdpRecommendedActionStrategy::QmdpRecommendedActionStrategy(
+        std::vector<std::unique_ptr<Action>> actions, MdpQValueFunction qValueFunction,
+        long visitThreshold, double priorWeight, long maxParticles) :
+            actions_(std::move(actions)),
+            qValueFunction_(qValueFunction),
+            visitThreshold_(visitThreshold),
+            priorWeight_(priorWeight),
+            maxParticles_(maxParticles) {
+}
+
+std::unique_ptr<Action> QmdpRecommendedActionStrategy::getAction(const BeliefNode* belief) {
+    ActionMapping *mapping = belief->getMapping();
+    if (mapping->getTotalVisitCount() >= visitThreshold_) {
+        return choosers::max_action(belief);
+    }
+
+    std::vector<State const *> states = belief->getStates();
+    if (states.empty()) {
+        return choosers::max_action(belief);
+    }
+    // Take evenly spaced particles so that at most maxParticles_ of them are used.
+    long stride = 1;
+    if (maxParticles_ > 0) {
+        stride = (static_cast<long>(states.size()) + maxParticles_ - 1) / maxParticles_;
+    }
+
+    std::unique_ptr<Action> bestAction = nullptr;
+    double bestValue = -std::numeric_limits<double>::infinity();
+    for (std::unique_ptr<Action> const &action : actions_) {
+        ActionMappingEntry const *entry = mapping->getEntry(*action);
+        if (entry == nullptr || !entry->isLegal()) {
+            continue;
+        }
+
+        double totalMdpValue = 0;
+        long numberOfParticles = 0;
+        for (unsigned long i = 0; i < states.size(); i += stride) {
+            totalMdpValue += qValueFunction_(*states[i], *action);
+            numberOfParticles++;
+        }
+        double value = totalMdpValue / numberOfParticles;
+
+        long visitCount = entry->getVisitCount();
+        if (visitCount > 0) {
+            value = ((visitCount * entry->getMeanQValue() + priorWeight_ * value)
+                    / (visitCount + priorWeight_));
+        }
+        if (bestAction == nullptr || value > bestValue) {
+            bestValue = value;
+            bestAction = action->copy();
+        }
+    }
+
+    if (bestAction == nullptr) {
+        return choosers::max_action(belief);
+    }
+    return bestAction;
+}
+
 
 } /* namespace solver */
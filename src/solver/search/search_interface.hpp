@@ -14,7 +14,10 @@
 #ifndef SOLVER_SEARCH_INTERFACE_HPP_
 #define SOLVER_SEARCH_INTERFACE_HPP_
 
+#include <functional>
 #include <memory>
+#include <ostream>
+#include <vector>
 
 #include "global.hpp"
 
@@ -59,6 +62,12 @@ public:
      * Backpropagation back to the root of the tree should be deferred (i.e. set aside for later).
      */
     virtual SearchStatus extendAndBackup(HistorySequence *sequence, long maximumDepth) = 0;
+
+    /** Writes the values of any parameters that this strategy adapts while planning to the given
+     * stream (see ParameterTuningExp3); by default there are none, and nothing is written.
+     */
+    virtual void printParameters(std::ostream &/*os*/) const {
+    }
 };
 
 /** An interface for the action recommendation functionality.
@@ -212,6 +221,20 @@ public:
     /** The default implementation of extendAndBackup, used by default in the ABT algorithm. */
     virtual SearchStatus extendAndBackup(HistorySequence *sequence, long maximumDepth) override;
 private:
+    /** Returns the observation that open-loop search uses for every step taking the given action
+     * from the given node - that of its most visited child - or nullptr if it has no children yet.
+     */
+    std::unique_ptr<Observation> getOpenLoopObservation(BeliefNode *node, Action const &action);
+    /** Records the given step in the last entry of the sequence, and adds a new entry (and, if
+     * needed, a new belief node) for the resulting state; returns the new entry.
+     */
+    HistoryEntry *addStep(HistorySequence *sequence, Model::StepResult &result,
+            long openLoopDepth);
+    /** Returns the number of extra rollout steps to keep in the tree for a history that was
+     * extended from the given node; see Options::rolloutExpansionSteps.
+     */
+    long getNumberOfExpansionSteps(BeliefNode const *root);
+
     /** The associated solver. */
     Solver *solver_;
     /** The factory to use for generating sequence steps. */
@@ -252,6 +275,43 @@ private:
     choosers::GpsMaxRecommendationOptions options;
 };
 
+/** A typedef for a function that returns the Q-value of taking the given action in the given
+ * state, e.g. as calculated by solving the fully observable MDP.
+ */
+typedef std::function<double(State const &, Action const &)> MdpQValueFunction;
+
+/** An implementation for the action recommendation strategy that falls back on QMDP when the
+ * search has been starved of histories.
+ *
+ * If the belief has at least the given number of visits, this simply maximises the Q-value.
+ * Otherwise each legal action is scored by its QMDP value - the mean MDP Q-value over the
+ * particles in the belief - and this is blended into the tree statistics as a prior worth
+ * priorWeight visits, i.e.
+ *      (n * Q_tree + priorWeight * Q_mdp) / (n + priorWeight)
+ *
+ * In order to bound the latency of this calculation, at most maxParticles particles are used;
+ * these are taken at evenly spaced intervals over the particles in the belief.
+ */
+class QmdpRecommendedActionStrategy: public SelectRecommendedActionStrategy {
+public:
+    QmdpRecommendedActionStrategy(std::vector<std::unique_ptr<Action>> actions,
+            MdpQValueFunction qValueFunction, long visitThreshold, double priorWeight,
+            long maxParticles);
+    virtual ~QmdpRecommendedActionStrategy() = default;
+    _NO_COPY_OR_MOVE(QmdpRecommendedActionStrategy);
+
+    /** Selects an action to execute during the simulation phase.
+     */
+    virtual std::unique_ptr<Action> getAction(const BeliefNode* belief) override;
+private:
+    /** All of the actions in the problem; only the ones that are legal in the belief are used. */
+    std::vector<std::unique_ptr<Action>> actions_;
+    MdpQValueFunction qValueFunction_;
+    long visitThreshold_;
+    double priorWeight_;
+    long maxParticles_;
+};
+
 
 
 } /* namespace solver */
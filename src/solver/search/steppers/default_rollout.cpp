@@ -5,6 +5,8 @@
  */
 #include "solver/search/steppers/default_rollout.hpp"
 
+#include <random>
+
 #include "solver/BeliefNode.hpp"
 #include "solver/HistoryEntry.hpp"
 #include "solver/HistorySequence.hpp"
@@ -14,12 +16,14 @@
 
 #include "solver/mappings/actions/ActionPool.hpp"
 #include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/discretized_actions.hpp"
 
 namespace solver {
 /* ------------------------- DefaultRolloutGenerator ------------------------- */
 DefaultRolloutGenerator::DefaultRolloutGenerator(SearchStatus &status,
         Solver *solver, long maxNSteps) :
             StepGenerator(status),
+            solver_(solver),
             model_(solver->getModel()),
             maxNSteps_(maxNSteps),
             currentNSteps_(0) {
@@ -36,8 +40,27 @@ Model::StepResult DefaultRolloutGenerator::getStep(HistoryEntry const *entry, St
 
     // Otherwise, we generate a new step and return it.
     currentNSteps_++;
-    std::unique_ptr<Action> action = model_->getRolloutAction(entry, state, data);
-    return model_->generateStep(*state, *action);
+    std::unique_ptr<Action> action = nullptr;
+    Action const *forcedAction = solver_->getForcedAction(entry->getAssociatedBeliefNode());
+    if (forcedAction != nullptr) {
+        // The solver has chosen the action for us.
+        action = forcedAction->copy();
+    } else {
+        action = model_->getRolloutAction(entry, state, data);
+    }
+    if (action == nullptr) {
+        // No rollout policy => take a uniformly random action, if there are finitely many.
+        DiscretizedActionPool *pool = dynamic_cast<DiscretizedActionPool *>(
+                solver_->getActionPool());
+        if (pool == nullptr) {
+            status_ = SearchStatus::OUT_OF_STEPS;
+            return Model::StepResult { };
+        }
+        long binNumber = std::uniform_int_distribution<long>(0, pool->getNumberOfBins() - 1)(
+                *model_->getRandomGenerator());
+        action = pool->sampleAnAction(binNumber);
+    }
+    return solver_->generateStep(entry, *state, *action);
 }
 
 /* ------------------------- DefaultRolloutFactory ------------------------- */
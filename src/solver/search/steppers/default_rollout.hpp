@@ -16,6 +16,9 @@ class Solver;
 
 /** A StepGenerator implementation that simply queries the model for a rollout action at each
  * time step.
+ *
+ * If the model has no rollout policy (i.e. it returns nullptr), a uniformly random action is
+ * taken instead when the action space is discretized; otherwise the rollout ends there.
  */
 class DefaultRolloutGenerator: public StepGenerator {
 public:
@@ -30,7 +33,9 @@ public:
             State const *state, HistoricalData const *data) override;
 
 private:
-    /** The associated model, which will be queried to generate steps. */
+    /** The associated solver, which is used to generate steps. */
+    Solver *solver_;
+    /** The associated model, which will be queried for rollout actions. */
     Model *model_;
     /** The maximum # of steps to take. */
     long maxNSteps_;
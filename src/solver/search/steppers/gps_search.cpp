@@ -14,11 +14,13 @@
 #include "solver/search/action-choosers/choosers.hpp"
 
 #include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/ActionMappingEntry.hpp"
 
 namespace solver {
-GpsStepGenerator::GpsStepGenerator(SearchStatus &status, Solver *solver, choosers::GpsChooserOptions theOptions) :
+GpsStepGenerator::GpsStepGenerator(SearchStatus &status, Solver *theSolver, choosers::GpsChooserOptions theOptions) :
             StepGenerator(status),
-            model(solver->getModel()),
+            solver(theSolver),
+            model(theSolver->getModel()),
             options(theOptions),
             choseUnvisitedAction(false) {
     status_ = SearchStatus::INITIAL;
@@ -35,9 +37,20 @@ Model::StepResult GpsStepGenerator::getStep(HistoryEntry const *entry, State con
 
     // Retrieve the mapping.
     BeliefNode *currentNode = entry->getAssociatedBeliefNode();
-    //ActionMapping *mapping = currentNode->getMapping();
+    ActionMapping *mapping = currentNode->getMapping();
 
-    choosers::GpsChooserResponse chooserResponse = choosers::gps_ucb_action(currentNode, *model, options);
+    choosers::GpsChooserResponse chooserResponse;
+    Action const *forcedAction = solver->getForcedAction(currentNode);
+    if (forcedAction != nullptr) {
+        // The solver has chosen the action for us; if it hasn't been tried before, this is
+        // also the end of the GPS search.
+        ActionMappingEntry const *actionEntry = mapping->getEntry(*forcedAction);
+        chooserResponse.action = forcedAction->copy();
+        chooserResponse.actionIsVisited = (actionEntry != nullptr
+                && actionEntry->getVisitCount() > 0);
+    } else {
+        chooserResponse = choosers::gps_ucb_action(currentNode, *model, options);
+    }
 
     if (!chooserResponse.actionIsVisited) {
     	choseUnvisitedAction = true;
@@ -51,7 +64,7 @@ Model::StepResult GpsStepGenerator::getStep(HistoryEntry const *entry, State con
     }
 
     // Use the model to generate the step.
-    return model->generateStep(*state, *(chooserResponse.action) );
+    return solver->generateStep(entry, *state, *(chooserResponse.action) );
 
 }
 
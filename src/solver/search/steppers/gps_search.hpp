@@ -30,7 +30,9 @@ public:
     virtual Model::StepResult getStep(HistoryEntry const *entry, State const *state, HistoricalData const *data) override;
 
 private:
-    /** The model to use to generate next steps. */
+    /** The associated solver, which is used to generate next steps. */
+    Solver *solver;
+    /** The model, which is used to choose actions. */
     Model *model;
     /** Settings for the GPS search. */
     choosers::GpsChooserOptions options;
@@ -73,7 +73,7 @@ std::unique_ptr<StepGenerator> NnRolloutFactory::createGenerator(SearchStatus &s
 
 NnRolloutGenerator::NnRolloutGenerator(SearchStatus &status, Solver *solver, BeliefNode *neighbor) :
             StepGenerator(status),
-            model_(solver->getModel()),
+            solver_(solver),
             currentNeighborNode_(neighbor) {
     // Set the initial status appropriately.
     if (currentNeighborNode_ == nullptr) {
@@ -83,7 +83,7 @@ NnRolloutGenerator::NnRolloutGenerator(SearchStatus &status, Solver *solver, Bel
     }
 }
 
-Model::StepResult NnRolloutGenerator::getStep(HistoryEntry const */*entry*/, State const *state,
+Model::StepResult NnRolloutGenerator::getStep(HistoryEntry const *entry, State const *state,
         HistoricalData const */*data*/) {
     if (currentNeighborNode_ == nullptr) {
         // If we have no neighbor, the NN rollout is finished.
@@ -91,9 +91,16 @@ Model::StepResult NnRolloutGenerator::getStep(HistoryEntry const */*entry*/, Sta
         return Model::StepResult { };
     }
 
-    // Generate a step using the recommended action from the neighboring node.
-    std::unique_ptr<Action> action = currentNeighborNode_->getRecommendedAction();
-    Model::StepResult result = model_->generateStep(*state, *action);
+    // Generate a step using the recommended action from the neighboring node, unless the solver
+    // has chosen the action for us.
+    std::unique_ptr<Action> action = nullptr;
+    Action const *forcedAction = solver_->getForcedAction(entry->getAssociatedBeliefNode());
+    if (forcedAction != nullptr) {
+        action = forcedAction->copy();
+    } else {
+        action = currentNeighborNode_->getRecommendedAction();
+    }
+    Model::StepResult result = solver_->generateStep(entry, *state, *action);
 
     // getChild() will return nullptr if the child doesn't yet exist => this will be the last step.
     currentNeighborNode_ = currentNeighborNode_->getChild(*action, *result.observation);
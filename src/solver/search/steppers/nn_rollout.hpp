@@ -68,8 +68,8 @@ public:
             State const *state, HistoricalData const *data) override;
 
 private:
-    /** The model of the associated solver; used to generate steps. */
-    Model *model_;
+    /** The associated solver; used to generate steps. */
+    Solver *solver_;
     /** The current neighbor node - this will be a descendant of the initial neighbor. */
     BeliefNode *currentNeighborNode_;
 };
@@ -13,13 +13,14 @@
 #include "solver/search/action-choosers/choosers.hpp"
 
 #include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/actions/ActionMappingEntry.hpp"
 
 namespace solver {
 UcbStepGenerator::UcbStepGenerator(SearchStatus &status, Solver *solver,
-        double explorationCoefficient) :
+        UcbActionChooser const &chooser) :
             StepGenerator(status),
-            model_(solver->getModel()),
-            explorationCoefficient_(explorationCoefficient),
+            solver_(solver),
+            chooser_(chooser),
             choseUnvisitedAction_(false) {
     status_ = SearchStatus::INITIAL;
 }
@@ -37,13 +38,23 @@ Model::StepResult UcbStepGenerator::getStep(HistoryEntry const *entry, State con
     BeliefNode *currentNode = entry->getAssociatedBeliefNode();
     ActionMapping *mapping = currentNode->getMapping();
 
-    std::unique_ptr<Action> action = mapping->getNextActionToTry();
-    if (action != nullptr) {
-        // If there are unvisited actions, we take one, and we're finished with UCB search.
-        choseUnvisitedAction_ = true;
+    std::unique_ptr<Action> action = nullptr;
+    Action const *forcedAction = solver_->getForcedAction(currentNode);
+    if (forcedAction != nullptr) {
+        // The solver has chosen the action for us; if it hasn't been tried before, this is
+        // also the end of the UCB search.
+        action = forcedAction->copy();
+        ActionMappingEntry const *actionEntry = mapping->getEntry(*action);
+        choseUnvisitedAction_ = (actionEntry == nullptr || actionEntry->getVisitCount() == 0);
     } else {
-        // Use UCB to get the best action.
-        action = choosers::ucb_action(currentNode, explorationCoefficient_);
+        action = mapping->getNextActionToTry();
+        if (action != nullptr) {
+            // If there are unvisited actions, we take one, and we're finished with UCB search.
+            choseUnvisitedAction_ = true;
+        } else {
+            // Use UCB to get the best action.
+            action = chooser_(currentNode);
+        }
     }
 
     // NO action -> error!
@@ -54,16 +65,22 @@ Model::StepResult UcbStepGenerator::getStep(HistoryEntry const *entry, State con
     }
 
     // Use the model to generate the step.
-    return model_->generateStep(*state, *action);
+    return solver_->generateStep(entry, *state, *action);
 }
 
 UcbStepGeneratorFactory::UcbStepGeneratorFactory(Solver *solver, double explorationCoefficient) :
+            UcbStepGeneratorFactory(solver, [explorationCoefficient](BeliefNode const *node) {
+                return choosers::ucb_action(node, explorationCoefficient);
+            }) {
+}
+
+UcbStepGeneratorFactory::UcbStepGeneratorFactory(Solver *solver, UcbActionChooser chooser) :
             solver_(solver),
-            explorationCoefficient_(explorationCoefficient) {
+            chooser_(std::move(chooser)) {
 }
 
 std::unique_ptr<StepGenerator> UcbStepGeneratorFactory::createGenerator(SearchStatus &status,
         HistoryEntry const */*entry*/, State const */*state*/, HistoricalData const */*data*/) {
-    return std::make_unique<UcbStepGenerator>(status, solver_, explorationCoefficient_);
+    return std::make_unique<UcbStepGenerator>(status, solver_, chooser_);
 }
 } /* namespace solver */
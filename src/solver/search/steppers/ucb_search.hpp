@@ -7,21 +7,31 @@
 #ifndef SOLVER_UCB_SEARCH_HPP_
 #define SOLVER_UCB_SEARCH_HPP_
 
+#include <functional>
+#include <memory>
+
 #include "solver/search/SearchStatus.hpp"
 #include "solver/search/search_interface.hpp"
 
 namespace solver {
+/** A function used to select an action from a belief node once all of its actions have been tried,
+ * e.g. choosers::ucb_action() with a fixed exploration coefficient.
+ */
+typedef std::function<std::unique_ptr<Action>(BeliefNode const *)> UcbActionChooser;
+
 /** A generator for steps that uses UCB to select actions.
  *
  * The action will be selected using UCB as long as the last action has been tried before; once
  * an action that has never been tried before is encountered, the search will terminate.
+ *
+ * The UCB variant is determined by the given chooser function.
  */
 class UcbStepGenerator : public StepGenerator {
 public:
     /** Creates a new UcbStepGenerator associated with the given solver, and using the given
-     * value for the UCB exploration coefficient.
+     * function to select actions.
      */
-    UcbStepGenerator(SearchStatus &status, Solver *solver, double explorationCoefficient);
+    UcbStepGenerator(SearchStatus &status, Solver *solver, UcbActionChooser const &chooser);
     ~UcbStepGenerator() = default;
     _NO_COPY_OR_MOVE(UcbStepGenerator);
 
@@ -29,10 +39,10 @@ public:
             State const *state, HistoricalData const *data) override;
 
 private:
-    /** The model to use to generate next steps. */
-    Model *model_;
-    /** The exploration coefficient for UCB. */
-    double explorationCoefficient_;
+    /** The associated solver, which is used to generate next steps. */
+    Solver *solver_;
+    /** The function used to select actions. */
+    UcbActionChooser const &chooser_;
 
     /** True iff the last action selected hadn't been tried before. */
     bool choseUnvisitedAction_;
@@ -45,6 +55,10 @@ public:
      * coefficient.
      */
     UcbStepGeneratorFactory(Solver *solver, double explorationCoefficient);
+    /** Creates a new factory associated with the given solver, which uses the given function
+     * to select actions.
+     */
+    UcbStepGeneratorFactory(Solver *solver, UcbActionChooser chooser);
     virtual ~UcbStepGeneratorFactory() = default;
     _NO_COPY_OR_MOVE(UcbStepGeneratorFactory);
 
@@ -53,8 +67,8 @@ public:
 private:
     /** The associated solver. */
     Solver *solver_;
-    /** The exploration coefficient for UCB. */
-    double explorationCoefficient_;
+    /** The function used to select actions. */
+    UcbActionChooser chooser_;
 };
 
 } /* namespace solver */
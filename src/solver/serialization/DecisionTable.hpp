@@ -0,0 +1,248 @@
+/** @file DecisionTable.hpp
+ *
+ * Defines DecisionTable, a small runtime for the decision tables written by
+ * DecisionTableExporter.
+ *
+ * This header only depends on the standard library, so that it can be copied into a robot's
+ * controller or any other program that needs to execute a policy without linking the solver.
+ */
+#ifndef SOLVER_DECISIONTABLE_HPP_
+#define SOLVER_DECISIONTABLE_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace solver {
+/** Executes a policy from a decision table, one step at a time.
+ *
+ * After loading, call getAction() to get the action to take, and then update() with the
+ * observation that was received, for as many steps as needed; reset() starts a new episode.
+ * Actions and observations are the strings written by the problem's Serializer.
+ *
+ * Observations must match the strings in the table exactly. Once the history leaves the table -
+ * because the table's depth limit was reached, or the observation was never seen while solving -
+ * the actions come from the fallback function, if one has been set, which is given every
+ * observation received since the last reset. Otherwise, the table's own fallback action for the
+ * latest observation is used (see Model::getFallbackActions()); failing that, the last action
+ * from the table is repeated.
+ */
+class DecisionTable {
+public:
+    /** A function that returns the action to take for the given history of observations. */
+    typedef std::function<std::string(std::vector<std::string> const &observations)>
+        FallbackFunction;
+
+    DecisionTable() = default;
+    ~DecisionTable() = default;
+
+    /** Loads a table from the given stream, replacing the current one, and returns true iff the
+     * table was read successfully.
+     */
+    bool load(std::istream &is) {
+        actions_.clear();
+        observationIndices_.clear();
+        nodes_.clear();
+        children_.clear();
+        fallbackActions_.clear();
+        reset();
+
+        std::string word;
+        long version;
+        if (!(is >> word >> version) || word != "decisionTable" || version < 1 || version > 2) {
+            return false;
+        }
+        if (!loadStrings("actions", is, &actions_)) {
+            return false;
+        }
+        std::vector<std::string> observations;
+        if (!loadStrings("observations", is, &observations)) {
+            return false;
+        }
+        for (unsigned long index = 0; index < observations.size(); index++) {
+            observationIndices_.emplace(observations[index], index);
+        }
+
+        long numberOfNodes;
+        if (!(is >> word >> numberOfNodes) || word != "nodes" || numberOfNodes < 1) {
+            return false;
+        }
+        nodes_.resize(numberOfNodes);
+        for (Node &node : nodes_) {
+            long numberOfChildren;
+            if (!(is >> node.action >> node.value >> numberOfChildren)
+                    || node.action >= static_cast<long>(actions_.size())) {
+                return false;
+            }
+            node.firstChild = children_.size();
+            node.lastChild = node.firstChild + numberOfChildren;
+            for (long childNo = 0; childNo < numberOfChildren; childNo++) {
+                std::pair<long, long> child;
+                if (!(is >> child.first >> child.second) || child.second < 0
+                        || child.second >= numberOfNodes) {
+                    return false;
+                }
+                children_.push_back(child);
+            }
+            // Sorted by observation, for a binary search in update().
+            std::sort(children_.begin() + node.firstChild, children_.end());
+        }
+
+        // Version 1 tables have no fallback actions.
+        fallbackActions_.assign(observations.size(), -1);
+        if (version < 2) {
+            return true;
+        }
+        long numberOfFallbacks;
+        if (!(is >> word >> numberOfFallbacks) || word != "fallbacks" || numberOfFallbacks < 0) {
+            return false;
+        }
+        for (long fallbackNo = 0; fallbackNo < numberOfFallbacks; fallbackNo++) {
+            long observation, action;
+            if (!(is >> observation >> action) || observation < 0
+                    || observation >= static_cast<long>(observations.size()) || action < 0
+                    || action >= static_cast<long>(actions_.size())) {
+                return false;
+            }
+            fallbackActions_[observation] = action;
+        }
+        return true;
+    }
+
+    /** Sets the function that chooses the actions outside of the table. */
+    void setFallback(FallbackFunction fallback) {
+        fallback_ = std::move(fallback);
+    }
+
+    /** Goes back to the start of the table, for a new episode. */
+    void reset() {
+        currentNode_ = 0;
+        observations_.clear();
+        lastAction_ = "";
+    }
+
+    /** Returns true iff the current history is still within the table. */
+    bool isInTable() const {
+        return currentNode_ >= 0 && currentNode_ < static_cast<long>(nodes_.size())
+                && nodes_[currentNode_].action >= 0;
+    }
+
+    /** Returns the action to take for the current history. */
+    std::string getAction() const {
+        if (isInTable()) {
+            return actions_[nodes_[currentNode_].action];
+        }
+        if (fallback_) {
+            return fallback_(observations_);
+        }
+        if (!observations_.empty()) {
+            std::unordered_map<std::string, long>::const_iterator it = observationIndices_.find(
+                    observations_.back());
+            if (it != observationIndices_.end() && fallbackActions_[it->second] >= 0) {
+                return actions_[fallbackActions_[it->second]];
+            }
+        }
+        return lastAction_;
+    }
+
+    /** Returns the estimated value of the current history, or NaN if it is not in the table. */
+    double getValue() const {
+        if (!isInTable()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return nodes_[currentNode_].value;
+    }
+
+    /** Moves on to the next step, after the action from getAction() was taken and the given
+     * observation was received.
+     */
+    void update(std::string const &observation) {
+        observations_.push_back(observation);
+        if (!isInTable()) {
+            currentNode_ = -1;
+            return;
+        }
+        Node const &node = nodes_[currentNode_];
+        lastAction_ = actions_[node.action];
+        currentNode_ = -1;
+        std::unordered_map<std::string, long>::const_iterator it = observationIndices_.find(
+                observation);
+        if (it == observationIndices_.end()) {
+            return;
+        }
+        std::vector<std::pair<long, long>>::const_iterator first = children_.begin()
+                + node.firstChild;
+        std::vector<std::pair<long, long>>::const_iterator last = children_.begin()
+                + node.lastChild;
+        std::vector<std::pair<long, long>>::const_iterator child = std::lower_bound(first, last,
+                std::make_pair(it->second, -1L));
+        if (child != last && child->first == it->second) {
+            currentNode_ = child->second;
+        }
+    }
+
+    /** Returns the number of nodes in the table. */
+    long getNumberOfNodes() const {
+        return nodes_.size();
+    }
+
+private:
+    /** A node of the table, i.e. a single history of actions and observations. */
+    struct Node {
+        /** The index of the action to take, or -1 if there is none. */
+        long action = -1;
+        /** The estimated value of the history. */
+        double value = 0.0;
+        /** The index in children_ of this node's first child. */
+        long firstChild = 0;
+        /** The index in children_ just after this node's last child. */
+        long lastChild = 0;
+    };
+
+    /** Reads a count with the given name, then that many lines, into the given vector. */
+    static bool loadStrings(std::string const &name, std::istream &is,
+            std::vector<std::string> *strings) {
+        std::string word;
+        long count;
+        if (!(is >> word >> count) || word != name || count < 0) {
+            return false;
+        }
+        std::string line;
+        std::getline(is, line); // The rest of the count's line.
+        for (long index = 0; index < count; index++) {
+            if (!std::getline(is, line)) {
+                return false;
+            }
+            strings->push_back(line);
+        }
+        return true;
+    }
+
+    /** The action strings. */
+    std::vector<std::string> actions_ = { };
+    /** The index of each observation string. */
+    std::unordered_map<std::string, long> observationIndices_ = { };
+    /** The nodes, in breadth-first order. */
+    std::vector<Node> nodes_ = { };
+    /** The (observation index, node index) pair for each child of each node. */
+    std::vector<std::pair<long, long>> children_ = { };
+    /** The index of the fallback action for each observation, or -1 if there is none. */
+    std::vector<long> fallbackActions_ = { };
+
+    /** The function for actions outside of the table. */
+    FallbackFunction fallback_ = nullptr;
+    /** The index of the node for the current history, or -1 if it has left the table. */
+    long currentNode_ = 0;
+    /** The observations received since the last reset. */
+    std::vector<std::string> observations_ = { };
+    /** The last action taken from the table. */
+    std::string lastAction_ = "";
+};
+} /* namespace solver */
+
+#endif /* SOLVER_DECISIONTABLE_HPP_ */
@@ -0,0 +1,148 @@
+/** @file DecisionTableExporter.cpp
+ *
+ * Contains the implementation of DecisionTableExporter.
+ */
+#include "solver/serialization/DecisionTableExporter.hpp"
+
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "solver/ActionNode.hpp"
+#include "solver/BeliefNode.hpp"
+#include "solver/Solver.hpp"
+
+#include "solver/abstract-problem/Action.hpp"
+#include "solver/abstract-problem/Model.hpp"
+#include "solver/abstract-problem/Observation.hpp"
+
+#include "solver/mappings/actions/ActionMapping.hpp"
+#include "solver/mappings/observations/approximate_observations.hpp"
+#include "solver/mappings/observations/ObservationMapping.hpp"
+#include "solver/mappings/observations/ObservationMappingEntry.hpp"
+
+#include "solver/serialization/Serializer.hpp"
+
+namespace solver {
+namespace {
+/** Assigns consecutive numbers to strings, in the order they are first seen. */
+class StringTable {
+public:
+    long getIndex(std::string const &string) {
+        std::map<std::string, long>::iterator it = indices_.find(string);
+        if (it != indices_.end()) {
+            return it->second;
+        }
+        long index = strings_.size();
+        indices_.emplace(string, index);
+        strings_.push_back(string);
+        return index;
+    }
+
+    void save(std::string const &name, std::ostream &os) const {
+        os << name << " " << strings_.size() << std::endl;
+        for (std::string const &string : strings_) {
+            os << string << std::endl;
+        }
+    }
+
+private:
+    std::map<std::string, long> indices_ = { };
+    std::vector<std::string> strings_ = { };
+};
+} /* namespace */
+
+DecisionTableExporter::DecisionTableExporter(Solver *solver, long maximumDepth) :
+        solver_(solver),
+        maximumDepth_(maximumDepth) {
+}
+
+bool DecisionTableExporter::canExport() const {
+    return dynamic_cast<ApproximateObservationPool *>(solver_->getObservationPool()) == nullptr;
+}
+
+long DecisionTableExporter::save(BeliefNode const *root, std::ostream &os) {
+    if (!canExport()) {
+        debug::show_message("ERROR: Decision tables can't match approximate observations.");
+        return -1;
+    }
+    Serializer *serializer = solver_->getSerializer();
+    StringTable actions;
+    StringTable observations;
+    std::ostringstream nodeLines;
+    nodeLines << std::setprecision(os.precision());
+
+    // The children of each node are numbered as they are queued, which gives breadth-first order.
+    std::deque<std::pair<BeliefNode const *, long>> queue;
+    queue.emplace_back(root, 0);
+    long numberOfNodes = 1;
+    while (!queue.empty()) {
+        BeliefNode const *node = queue.front().first;
+        long depth = queue.front().second;
+        queue.pop_front();
+
+        std::unique_ptr<Action> action = node->getRecommendedAction();
+        if (action == nullptr) {
+            nodeLines << "-1 " << node->getCachedValue() << " 0" << std::endl;
+            continue;
+        }
+        std::ostringstream actionString;
+        serializer->saveAction(action.get(), actionString);
+        nodeLines << actions.getIndex(actionString.str()) << " " << node->getCachedValue();
+
+        std::vector<std::pair<long, BeliefNode const *>> children;
+        ActionNode *actionNode = node->getMapping()->getActionNode(*action);
+        if (depth < maximumDepth_ && actionNode != nullptr) {
+            ObservationMapping *mapping = actionNode->getMapping();
+            for (ObservationMappingEntry const *entry : mapping->getChildEntries()) {
+                if (entry->getBeliefNode() == nullptr) {
+                    continue;
+                }
+                std::ostringstream observationString;
+                std::unique_ptr<Observation> observation = entry->getObservation();
+                serializer->saveObservation(observation.get(), observationString);
+                children.emplace_back(observations.getIndex(observationString.str()),
+                        entry->getBeliefNode());
+            }
+        }
+        nodeLines << " " << children.size();
+        for (std::pair<long, BeliefNode const *> const &child : children) {
+            nodeLines << " " << child.first << " " << numberOfNodes;
+            queue.emplace_back(child.second, depth + 1);
+            numberOfNodes++;
+        }
+        nodeLines << std::endl;
+    }
+
+    std::ostringstream fallbackLines;
+    std::vector<std::pair<std::unique_ptr<Observation>, std::unique_ptr<Action>>> fallbacks = (
+            solver_->getModel()->getFallbackActions());
+    if (fallbacks.empty()) {
+        debug::show_message("WARNING: The model has no fallback actions; histories that leave"
+                " the decision table will repeat the last action.");
+    }
+    for (std::pair<std::unique_ptr<Observation>, std::unique_ptr<Action>> const &entry
+            : fallbacks) {
+        std::ostringstream observationString;
+        serializer->saveObservation(entry.first.get(), observationString);
+        std::ostringstream actionString;
+        serializer->saveAction(entry.second.get(), actionString);
+        fallbackLines << observations.getIndex(observationString.str()) << " ";
+        fallbackLines << actions.getIndex(actionString.str()) << std::endl;
+    }
+
+    os << "decisionTable 2" << std::endl;
+    actions.save("actions", os);
+    observations.save("observations", os);
+    os << "nodes " << numberOfNodes << std::endl;
+    os << nodeLines.str();
+    os << "fallbacks " << fallbacks.size() << std::endl;
+    os << fallbackLines.str();
+    return numberOfNodes;
+}
+} /* namespace solver */
@@ -0,0 +1,78 @@
+/** @file DecisionTableExporter.hpp
+ *
+ * Defines DecisionTableExporter, which distills the policy in a belief tree into a compact
+ * decision table that can be executed by DecisionTable, without the solver.
+ */
+#ifndef SOLVER_DECISIONTABLEEXPORTER_HPP_
+#define SOLVER_DECISIONTABLEEXPORTER_HPP_
+
+#include <ostream>
+
+#include "global.hpp"
+
+namespace solver {
+class BeliefNode;
+class Solver;
+
+/** Writes out the part of a policy that is actually followed, as a trie of action-observation
+ * histories.
+ *
+ * Starting from a given belief, each node of the trie stores the recommended action for its
+ * belief and the estimated value of that belief; its children are the beliefs that follow that
+ * action, one for each observation in the tree. The beliefs reached by the other actions are never
+ * needed to execute the policy, and so they are left out, as is everything below the given
+ * maximum depth.
+ *
+ * The format is plain text, so that the loader (DecisionTable.hpp) only needs the standard
+ * library:
+ *
+ *     decisionTable 2
+ *     actions <n>
+ *     <one action per line>
+ *     observations <m>
+ *     <one observation per line>
+ *     nodes <k>
+ *     <action #> <value> <# of children> [<observation #> <node #>]...
+ *     fallbacks <f>
+ *     <observation #> <action #>
+ *
+ * Actions and observations are written with the solver's Serializer, and each observation is only
+ * written once, however often it occurs. The nodes are in breadth-first order, so node #0 is the
+ * starting belief; a node for a belief with no recommended action has the action # -1. The
+ * fallbacks are the model's action for each observation it can list (see
+ * Model::getFallbackActions()), for use once a history has left the table; if the model lists
+ * none, a warning is shown, since DecisionTable will then just repeat its last action. (Version 1
+ * tables, which DecisionTable can still load, are the same but without the fallbacks.)
+ *
+ * DecisionTable can only match observations exactly, so policies with approximate observations
+ * (ApproximateObservationPool) can't be exported.
+ */
+class DecisionTableExporter {
+public:
+    /** Makes a new exporter for the given solver, which will stop at the given depth below the
+     * starting belief.
+     */
+    DecisionTableExporter(Solver *solver, long maximumDepth);
+    ~DecisionTableExporter() = default;
+    _NO_COPY_OR_MOVE(DecisionTableExporter);
+
+    /** Returns true iff the solver's policy can be exported, i.e. its observations are not
+     * approximate.
+     */
+    bool canExport() const;
+
+    /** Writes the decision table for the policy from the given belief onwards to the given stream,
+     * and returns the number of nodes written, or -1 (without writing anything) if the policy
+     * can't be exported.
+     */
+    long save(BeliefNode const *root, std::ostream &os);
+
+private:
+    /** The solver whose policy is exported. */
+    Solver *solver_;
+    /** The greatest depth (relative to the starting belief) of the nodes in the table. */
+    long maximumDepth_;
+};
+} /* namespace solver */
+
+#endif /* SOLVER_DECISIONTABLEEXPORTER_HPP_ */
@@ -118,7 +118,7 @@ void TextSerializer::load(StateInfo &info, std::istream &is) {
 
 void TextSerializer::save(StatePool const &pool, std::ostream &os) {
     os << "STATESPOOL-BEGIN" << std::endl;
-    os << "numStates: " << pool.stateInfoMap_.size() << std::endl;
+    os << "numStates: " << pool.statesByIndex_.size() << std::endl;
     for (std::unique_ptr<StateInfo> const &stateInfo : pool.statesByIndex_) {
         save(*stateInfo, os);
         os << std::endl;
@@ -207,7 +207,11 @@ void TextSerializer::load(HistoryEntry &entry, std::istream &is) {
 
 void TextSerializer::save(HistorySequence const &seq, std::ostream &os) {
     os << "HistorySequence " << seq.id_;
-    os << " - length " << seq.entrySequence_.size() << std::endl;
+    os << " - length " << seq.entrySequence_.size();
+    if (seq.openLoopEntryId_ != -1) {
+        os << " - openLoop " << seq.openLoopEntryId_;
+    }
+    os << std::endl;
     for (std::unique_ptr<HistoryEntry> const &entry : seq.entrySequence_) {
         save(*entry, os);
         os << std::endl;
@@ -221,6 +225,11 @@ void TextSerializer::load(HistorySequence &seq, std::istream &is) {
     std::istringstream sstr(line);
     std::string tmpStr;
     sstr >> tmpStr >> seq.id_ >> tmpStr >> tmpStr >> seqLength;
+    // Sequences saved without an open-loop marker were searched closed-loop throughout.
+    seq.openLoopEntryId_ = -1;
+    if (sstr >> tmpStr >> tmpStr) {
+        sstr >> seq.openLoopEntryId_;
+    }
     for (int i = 0; i < seqLength; i++) {
         std::getline(is, line);
         std::unique_ptr<HistoryEntry> entry(std::make_unique<HistoryEntry>());
@@ -230,6 +239,7 @@ void TextSerializer::load(HistorySequence &seq, std::istream &is) {
         entry->owningSequence_ = &seq;
         seq.entrySequence_.push_back(std::move(entry));
     }
+    seq.updateCumulativeRewards(getSolver()->getModel());
 }
 
 void TextSerializer::save(Histories const &histories, std::ostream &os) {
@@ -275,10 +285,30 @@ void TextSerializer::load(Histories &histories, std::istream &is) {
 
 /* ------------------ Saving the policy tree -------------------- */
 void TextSerializer::save(ActionNode const &node, std::ostream &os) {
+    // The totals for shorter n-step returns are only written if there are any.
+    if (!node.stepTotalQValues_.empty()) {
+        os << "stepTotals:";
+        for (double total : node.stepTotalQValues_) {
+            os << " " << total;
+        }
+        os << std::endl;
+    }
     saveObservationMapping(*node.getMapping(), os);
 }
 
 void TextSerializer::load(ActionNode &node, std::istream &is) {
+    node.stepTotalQValues_.clear();
+    if (is.peek() == 's') {
+        std::string line;
+        std::getline(is, line);
+        std::istringstream sstr(line);
+        std::string tmpStr;
+        sstr >> tmpStr;
+        double total;
+        while (sstr >> total) {
+            node.stepTotalQValues_.push_back(total);
+        }
+    }
     node.setMapping(loadObservationMapping(&node, is));
 }
 